@@ -14,6 +14,19 @@ export function parseStCommand(
   return adapter.parseStCommand(input) as ParsedStCommand
 }
 
+/**
+ * 取出 .st 参数中的人物卡名称前缀（名称--属性 值），不调用 WASM
+ * 规则与 WASM 的 parseStOperations 一致：首个 "--" 之前的非空部分，且其后仍有内容
+ */
+export function parseStCardName(input: string): string | undefined {
+  const text = input.trim()
+  const separator = text.indexOf('--')
+  if (separator > 0 && separator + 2 < text.length) {
+    return text.slice(0, separator).trim()
+  }
+  return undefined
+}
+
 /**
  * 解析属性名列表（用于 show 和 del 命令）
  * 支持格式：
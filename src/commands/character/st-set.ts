@@ -1,9 +1,19 @@
 import type { Command, Context } from 'koishi'
 import type { DiceAdapter } from '../../wasm'
 import { CharacterService } from '../../services/character-service'
-import { parseStCommand } from './parser'
+import { parseStCardName } from './parser'
 import { logger } from '../../index'
 
+/**
+ * 人物卡类型对应的派生属性体系；未知类型返回空字符串（不更新派生属性）
+ */
+function derivedSystemOf(cardType: string | undefined): string {
+  const type = (cardType || '').toUpperCase()
+  if (type === 'COC7' || type === 'COC6') return type
+  if (type === 'DND5E') return 'DND'
+  return ''
+}
+
 export function registerStSetCommand(
   parent: Command,
   ctx: Context,
@@ -13,9 +23,10 @@ export function registerStSetCommand(
 
   parent
     .subcommand('.st [...args:text]', '人物卡管理')
-    .usage('.st [人物卡名--]属性名 属性值 [属性名 属性值]...')
+    .usage('.st [人物卡名--]属性名[+/-]属性值或掷骰表达式 ...')
     .example('.st 力量 60 敏捷 70')
     .example('.st Alice--力量 60 体质 40')
+    .example('.st 理智-1d6 hp-2')
     .action(async ({ session }, ...args) => {
       // 将数组参数合并为字符串
       const argsStr = args.join(' ')
@@ -47,55 +58,52 @@ export function registerStSetCommand(
         }
       }
 
-      // 解析格式
+      // 解析并求值（增减与掷骰均在 WASM 内一次完成），人物卡名称前缀在 TS 中取出以便先读卡
       try {
-        const { cardName, operations } = parseStCommand(argsStr, diceAdapter)
-
-        logger.debug('解析结果:', { cardName, operations, argsStr })
-
-        if (operations.length === 0) {
-          return '未识别到有效的属性设置，请检查格式'
-        }
-
+        const cardName = parseStCardName(argsStr)
         const targetCard = cardName || null
-        const results: string[] = []
+        const card = targetCard
+          ? await characterService.getCard(session, targetCard)
+          : await characterService.getActiveCard(session)
+        const currentAttrs: Record<string, number> = card
+          ? typeof card.attributes === 'string'
+            ? JSON.parse(card.attributes)
+            : card.attributes
+          : {}
 
-        // 处理每个操作
-        for (const op of operations) {
-          if (op.op === 'set') {
-            // 直接设置
-            await characterService.setAttributes(session, targetCard, {
-              [op.attr]: op.value as number
-            })
-            results.push(`${op.attr}=${op.value}`)
-          } else {
-            // 增减操作
-            const currentAttrs = await characterService.getAttributes(
-              session,
-              targetCard
-            )
-            const currentValue = currentAttrs?.[op.attr] || 0
-
-            let delta: number
-            if (typeof op.value === 'string' && /\d*d\d+/i.test(op.value)) {
-              // 骰子表达式
-              const rollResult = diceAdapter.roll(op.value)
-              delta = rollResult.total
-            } else {
-              delta = Number(op.value)
-            }
+        const result = diceAdapter.applyStCommand(
+          argsStr,
+          currentAttrs,
+          derivedSystemOf(card?.cardType)
+        )
+        logger.debug('执行结果:', { result, argsStr })
 
-            const newValue =
-              op.op === 'add' ? currentValue + delta : currentValue - delta
+        if (!result.success) {
+          return result.errorMsg || '未识别到有效的属性设置，请检查格式'
+        }
 
-            await characterService.setAttributes(session, targetCard, {
-              [op.attr]: Math.max(0, newValue)
-            })
+        await characterService.setAttributes(
+          session,
+          targetCard,
+          result.attributes
+        )
 
-            results.push(
-              `${op.attr}${op.op === 'add' ? '+' : '-'}${delta}=${Math.max(0, newValue)}`
-            )
+        const results = result.updates.map((update) => {
+          if (update.op === 'set') {
+            return `${update.attr}=${update.newValue}`
           }
+          const sign = update.op === 'add' ? '+' : '-'
+          const delta = update.detail || String(update.delta)
+          return `${update.attr}${sign}${delta}: ${update.oldValue}→${update.newValue}`
+        })
+
+        for (const change of result.derived) {
+          const value = change.text ?? String(change.newValue)
+          results.push(
+            change.oldValue === undefined
+              ? `${change.attr}=${value}`
+              : `${change.attr}:${change.oldValue}→${value}`
+          )
         }
 
         const prefix = cardName ? `人物卡 ${cardName}` : session.username
@@ -4,15 +4,24 @@ import type { DiceAdapter } from '../wasm'
 import { logger } from '../index'
 import { CharacterService } from '../services/character-service'
 
+/**
+ * 检定表达式末尾是否给出了成功率（"侦查 60"、"侦查60"）
+ * 与 WASM 中的解析一致：紧跟 +/- 的数字是修正值（"侦查+10"、"侦查 -20"），仍需读取人物卡
+ */
+function hasSuccessRate(expression: string): boolean {
+  return /[^\d+\-]\d{1,4}$/.test(expression.trim())
+}
+
 /**
  * 通用检定命令 .rc/.ra
  * 支持格式:
- * .rc 技能名 成功率 - 基础检定
+ * .rc 技能名 成功率 - 基础检定（也可不加空格，如 .rc 侦查60）
  * .rc 困难技能名 成功率 - 困难检定（成功率/2）
  * .rc 极难技能名 成功率 - 极难检定（成功率/5）
  * .rc3#技能名 成功率 - 3轮检定
  * .rc3#p技能名 成功率 - 3轮带惩罚骰
  * .rc3#b技能名 成功率 - 3轮带奖励骰
+ * .rc 侦查+10 - 从人物卡取值并修正，卡上没有的技能使用 COC7 基础值
  */
 export function registerCheckCommand(
   parent: Command,
@@ -32,37 +41,21 @@ export function registerCheckCommand(
       }
 
       try {
-        // 检查是否需要从人物卡获取技能值
-        let finalExpression = expression
-        const spaceIndex = expression.lastIndexOf(' ')
-
-        if (
-          spaceIndex === -1 ||
-          Number.isNaN(Number(expression.substring(spaceIndex + 1)))
-        ) {
-          // 提取技能名（去除难度前缀和轮数前缀）
-          let skillName = expression
-          skillName = skillName.replace(/^\d+#[pb]?/, '')
-          skillName = skillName.replace(/^(困难|极难|自动成功)/, '')
-          skillName = skillName.trim()
-
-          // 从人物卡获取技能值
-          const attributes = await characterService.getAttributes(session, null)
-          if (attributes && skillName in attributes) {
-            const skillValue = attributes[skillName]
-            finalExpression = `${expression} ${skillValue}`
-          } else {
-            return `未找到技能 ${skillName}，请指定成功率或先使用 .st.set ${skillName} <值> 设置`
-          }
-        }
-
-        const result = diceAdapter.processCheck(
-          finalExpression,
-          session.userId,
-          0
+        // 未给出成功率时由 WASM 从人物卡解析技能值（含同义词、修正值与基础值），
+        // 给出成功率时不读取人物卡
+        const attributes = hasSuccessRate(expression)
+          ? null
+          : await characterService.getAttributes(session, null)
+        const result = diceAdapter.processCheckWithAttributes(
+          expression,
+          0,
+          attributes
         )
 
         if (!result.success) {
+          if (result.errorMsg?.startsWith('未找到技能')) {
+            return `${result.errorMsg}，请指定成功率或先使用 .st ${result.skillName} <值> 设置`
+          }
           return result.errorMsg || '检定失败'
         }
 
@@ -78,20 +78,22 @@ export function registerSanityCheckCommand(
 
         // 如果没有指定SAN值，从人物卡获取（参考 DiceEvent.cpp 3859-3867行）
         let shouldUpdateCard = false
+        let intelligence = 0
         if (currentSan === undefined) {
           const attributes = await characterService.getAttributes(session, null)
           if (!attributes || !('理智' in attributes)) {
             return '未设定SAN值，请指定SAN值或先使用 .st.set 理智 <值> 设置'
           }
           currentSan = attributes.理智
+          intelligence = attributes.智力 ?? 0
           shouldUpdateCard = true
         }
 
-        // 执行理智检定
-        const result = diceAdapter.sanityCheck(
+        // 执行理智检定（损失触发疯狂时同时完成智力检定与症状抽取）
+        const result = diceAdapter.sanityCheckWithInsanity(
           currentSan,
-          successLoss,
-          failureLoss
+          `${successLoss}/${failureLoss}`,
+          intelligence
         )
 
         if (result.errorCode !== 0) {
@@ -125,6 +127,25 @@ export function registerSanityCheckCommand(
         messageParts.push(`理智损失: ${result.lossDetail}`)
         messageParts.push(`当前理智: ${currentSan} → ${result.newSan}`)
 
+        const { insanity } = result
+        if (insanity.type === 'permanent') {
+          messageParts.push('理智归零，陷入永久疯狂')
+        } else if (insanity.type === 'indefinite') {
+          messageParts.push(
+            `单次损失达到当前理智的1/5，陷入不定性疯狂:\n${formatSymptom(insanity.symptom, session.username)}`
+          )
+        } else if (insanity.type === 'temporary') {
+          messageParts.push(
+            `智力检定 1D100=${insanity.intRoll}/${intelligence} 成功，陷入临时疯狂:\n${formatSymptom(insanity.symptom, session.username)}`
+          )
+        } else if (insanity.intCheckRequired) {
+          messageParts.push('单次损失达到5点，请进行智力检定以判定临时疯狂')
+        } else if (insanity.intRoll > 0) {
+          messageParts.push(
+            `智力检定 1D100=${insanity.intRoll}/${intelligence} 失败，未陷入临时疯狂`
+          )
+        }
+
         return messageParts.join('\n')
       } catch (error) {
         logger.error('理智检定错误:', error)
@@ -132,3 +153,10 @@ export function registerSanityCheckCommand(
       }
     })
 }
+
+/**
+ * 替换疯狂症状中的角色占位符
+ */
+function formatSymptom(symptom: string, name: string): string {
+  return symptom.replace(/{pc}/g, name).replace(/{nick}/g, name)
+}
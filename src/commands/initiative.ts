@@ -1,6 +1,6 @@
 import type { Command, Context } from 'koishi'
 import type { Config } from '../config'
-import type { DiceAdapter } from '../wasm'
+import type { DiceAdapter, InitiativeConditionEvent } from '../wasm'
 import { logger } from '../index'
 
 /**
@@ -12,6 +12,11 @@ async function loadInitiative(
   platform: string,
   diceAdapter: DiceAdapter
 ): Promise<void> {
+  // 仍驻留在模块内时与数据库一致（每次修改后都会保存），无需重新读取
+  if (diceAdapter.isInitiativeLoaded(channelId)) {
+    return
+  }
+
   try {
     const records = await ctx.database.get('koidice_initiative', {
       channelId,
@@ -37,7 +42,8 @@ async function saveInitiative(
   diceAdapter: DiceAdapter
 ): Promise<void> {
   try {
-    const content = diceAdapter.serializeInitiative(channelId)
+    // 保存紧凑二进制快照；加载时 JSON 与二进制均可识别，旧记录无需迁移
+    const content = diceAdapter.serializeInitiativeBinary(channelId)
     const existing = await ctx.database.get('koidice_initiative', {
       channelId,
       platform
@@ -87,6 +93,16 @@ async function deleteInitiative(
   }
 }
 
+/**
+ * 到期状态效果的提示文本
+ */
+function formatExpired(expired?: InitiativeConditionEvent[]): string {
+  if (!expired || expired.length === 0) {
+    return ''
+  }
+  return expired.map((event) => `${event.target} 的 ${event.label} 已结束\n`).join('')
+}
+
 /**
  * 先攻列表命令 .init / .ri
  * 参考文档：
@@ -95,6 +111,8 @@ async function deleteInitiative(
  * .ri [表达式] [角色名] - 自定义表达式
  * .init - 查看先攻列表
  * .init.clr - 清空先攻列表
+ * .init.cond [角色名] [效果] [轮数] - 添加持续若干轮的状态效果
+ * .init.uncond [编号] - 移除状态效果
  */
 export function registerInitiativeCommands(
   parent: Command,
@@ -102,6 +120,10 @@ export function registerInitiativeCommands(
   _config: Config,
   diceAdapter: DiceAdapter
 ) {
+  // 每次修改后都会保存快照，频道被逐出时数据库已是最新，不需要模块暂存快照；
+  // 数据库读取是异步的，载入仍由 loadInitiative 在命令开始时完成
+  diceAdapter.setInitiativeEvictionHandler(() => {})
+
   // .init 主命令 - 查看先攻列表
   const init = parent
     .subcommand('.init', '先攻列表')
@@ -171,7 +193,8 @@ export function registerInitiativeCommands(
 
         const count = diceAdapter.getInitiativeCount(channelId)
         if (count === 0) {
-          // 删除数据库记录
+          // 释放模块内的空列表并删除数据库记录
+          diceAdapter.clearInitiative(channelId)
           await deleteInitiative(ctx, channelId, platform)
           return `已移除 ${name}，先攻列表已清空`
         }
@@ -210,13 +233,70 @@ export function registerInitiativeCommands(
       await saveInitiative(ctx, channelId, platform, diceAdapter)
 
       const list = diceAdapter.getInitiativeList(channelId)
-      return `轮到 ${result.currentName} 行动！\n\n${list}`
+      return `${formatExpired(result.expired)}轮到 ${result.currentName} 行动！\n\n${list}`
     } catch (error) {
       logger.error('下一回合错误:', error)
       return '切换回合时发生错误'
     }
   })
 
+  // .init.cond - 添加状态效果
+  init
+    .subcommand('.cond <name:string> <label:string> [rounds:number]', '添加状态效果')
+    .usage('在第 N 次轮到当前行动者时结束，默认 1 轮')
+    .example('.init.cond 某pc 中毒 3')
+    .action(async ({ session }, name, label, rounds = 1) => {
+      if (!name || !label) {
+        return '请指定角色名与效果名称'
+      }
+
+      try {
+        const channelId = session.channelId || session.userId
+        const platform = session.platform
+
+        await loadInitiative(ctx, channelId, platform, diceAdapter)
+
+        const result = diceAdapter.addInitiativeCondition(channelId, name, label, rounds)
+        if (!result.success) {
+          return result.message || '添加状态效果失败'
+        }
+
+        await saveInitiative(ctx, channelId, platform, diceAdapter)
+
+        const list = diceAdapter.getInitiativeList(channelId)
+        return `${formatExpired(result.expired)}${result.message}（编号 ${result.id}）\n\n${list}`
+      } catch (error) {
+        logger.error('添加状态效果错误:', error)
+        return '添加状态效果时发生错误'
+      }
+    })
+
+  // .init.uncond - 移除状态效果
+  init
+    .subcommand('.uncond <id:number>', '移除状态效果')
+    .action(async ({ session }, id) => {
+      if (!id) {
+        return '请指定效果编号'
+      }
+
+      try {
+        const channelId = session.channelId || session.userId
+        const platform = session.platform
+
+        await loadInitiative(ctx, channelId, platform, diceAdapter)
+
+        if (!diceAdapter.removeInitiativeCondition(channelId, id)) {
+          return `未找到编号为 ${id} 的状态效果`
+        }
+
+        await saveInitiative(ctx, channelId, platform, diceAdapter)
+        return `已移除状态效果 ${id}`
+      } catch (error) {
+        logger.error('移除状态效果错误:', error)
+        return '移除状态效果时发生错误'
+      }
+    })
+
   // .ri - 先攻掷骰
   parent
     .subcommand('.ri [...args:text]', '先攻掷骰')
@@ -37,7 +37,7 @@ export function registerPcNewCommand(
 
         let cardType = 'COC7'
         let cardName = ''
-        let generateParams = ''
+        let _generateParams = ''
 
         if (args?.trim()) {
           const parts = args.trim().split(':')
@@ -62,12 +62,12 @@ export function registerPcNewCommand(
               cardName = parts[1].trim()
             } else {
               cardName = parts[0].trim()
-              generateParams = parts[1].trim()
+              _generateParams = parts[1].trim()
             }
           } else if (parts.length === 3) {
             // 模板:参数:卡名
             cardType = parts[0].trim()
-            generateParams = parts[1].trim()
+            _generateParams = parts[1].trim()
             cardName = parts[2].trim()
           }
         }
@@ -86,30 +86,8 @@ export function registerPcNewCommand(
         let attributes: Record<string, number> = {}
         const cardTypeUpper = cardType.toUpperCase()
 
-        if (cardTypeUpper === 'COC7') {
-          const cocResult = generateParams
-            ? diceAdapter.generateCOC7()
-            : diceAdapter.generateCOC7()
-
-          // 解析COC输出
-          const jsonResult = diceAdapter.parseCOCAttributes(cocResult)
-          if (jsonResult && typeof jsonResult === 'string') {
-            try {
-              attributes = JSON.parse(jsonResult) as Record<string, number>
-            } catch (e) {
-              logger.warn('解析COC属性失败:', e)
-            }
-          }
-        } else if (cardTypeUpper === 'COC6') {
-          const cocResult = diceAdapter.generateCOC6()
-          const jsonResult = diceAdapter.parseCOCAttributes(cocResult)
-          if (jsonResult && typeof jsonResult === 'string') {
-            try {
-              attributes = JSON.parse(jsonResult) as Record<string, number>
-            } catch (e) {
-              logger.warn('解析COC属性失败:', e)
-            }
-          }
+        if (cardTypeUpper === 'COC7' || cardTypeUpper === 'COC6') {
+          attributes = diceAdapter.generateAttributes(cardTypeUpper)
         } else if (extensionService) {
           // 尝试使用插件模板
           const template = extensionService.getTemplate(cardType)
@@ -56,26 +56,8 @@ export function registerPcRedoCommand(
         let attributes: Record<string, number> = {}
         const cardType = targetCard.cardType
 
-        if (cardType === 'COC7') {
-          const cocResult = diceAdapter.generateCOC7()
-          const jsonResult = diceAdapter.parseCOCAttributes(cocResult)
-          if (jsonResult && typeof jsonResult === 'string') {
-            try {
-              attributes = JSON.parse(jsonResult) as Record<string, number>
-            } catch (e) {
-              logger.warn('解析COC属性失败:', e)
-            }
-          }
-        } else if (cardType === 'COC6') {
-          const cocResult = diceAdapter.generateCOC6()
-          const jsonResult = diceAdapter.parseCOCAttributes(cocResult)
-          if (jsonResult && typeof jsonResult === 'string') {
-            try {
-              attributes = JSON.parse(jsonResult) as Record<string, number>
-            } catch (e) {
-              logger.warn('解析COC属性失败:', e)
-            }
-          }
+        if (cardType === 'COC7' || cardType === 'COC6') {
+          attributes = diceAdapter.generateAttributes(cardType)
         } else {
           return `暂不支持 ${cardType} 类型的属性生成喵~`
         }
@@ -5,10 +5,32 @@ import type {
   COCCheckResult,
   SkillCheckResult,
   SanityCheckResult,
+  SanityCheckWithInsanityResult,
+  SanityBatchInvestigator,
+  SanityCheckBatchResult,
   InitiativeRollResult,
+  InitiativeBatchGroup,
+  InitiativeBatchResult,
   InitiativeTurnResult,
+  InitiativeUpdateResult,
+  InitiativeCondition,
+  InitiativeConditionResult,
+  InitiativeChange,
+  InitiativeTableStats,
   DeckDrawResult,
-  RuleQueryResult
+  ChannelDeckResult,
+  DeckPackInfo,
+  DeckPackLoadResult,
+  DeckMemoryStats,
+  RuleQueryResult,
+  GeneratedCharactersResult,
+  CharacterConstraints,
+  ConstrainedCharactersResult,
+  UnloadCardResult,
+  ApplyStResult,
+  SheetImportResult,
+  DerivedUpdateResult,
+  DirtyCard
 } from './types'
 import { SuccessLevel } from './types'
 import createDiceModule from '../../lib/dice.js'
@@ -161,6 +183,40 @@ export class DiceAdapter {
     return module.processCheck(rawCommand, userId, rule)
   }
 
+  /**
+   * 处理检定命令，未给出成功率时从人物卡属性中取值
+   * 支持同义词、修正值（侦查+10）与 COC7 技能基础值（闪避 = 敏捷/2）
+   * @param attributes 人物卡属性
+   */
+  processCheckWithAttributes(
+    rawCommand: string,
+    rule: number,
+    attributes: Record<string, number> | null
+  ) {
+    const module = this.ensureModule()
+    return module.processCheckWithAttributes(rawCommand, rule, attributes)
+  }
+
+  /**
+   * 使用常驻人物卡处理检定命令
+   */
+  processCheckWithCard(
+    rawCommand: string,
+    rule: number,
+    platform: string,
+    userId: string,
+    cardName: string
+  ) {
+    const module = this.ensureModule()
+    return module.processCheckWithCard(
+      rawCommand,
+      rule,
+      platform,
+      userId,
+      cardName
+    )
+  }
+
   /**
    * 处理COC检定（新架构）
    */
@@ -258,6 +314,19 @@ export class DiceAdapter {
     return module.shuffleDeck(deckName, count)
   }
 
+  /**
+   * 有放回抽卡（支持权重，每张抽出后放回）
+   * @param deckName 牌堆名称
+   * @param count 抽取数量
+   */
+  drawFromDeckWithReplacement(
+    deckName: string,
+    count: number = 1
+  ): DeckDrawResult {
+    const module = this.ensureModule()
+    return module.drawFromDeckWithReplacement(deckName, count)
+  }
+
   /**
    * 列出所有牌堆
    */
@@ -266,6 +335,26 @@ export class DiceAdapter {
     return module.listDecks()
   }
 
+  /**
+   * 使牌堆的预编译缓存失效（牌堆内容被原地修改后调用）
+   */
+  invalidateDeckCache(deckName: string): void {
+    const module = this.ensureModule()
+    module.invalidateDeckCache(deckName)
+  }
+
+  /**
+   * 设置牌面展开预算（嵌套层数、展开后字节数、引用总数），非正数表示保持原值
+   */
+  setDeckTemplateLimits(
+    maxDepth: number,
+    maxOutputBytes: number = 0,
+    maxExpansions: number = 0
+  ): void {
+    const module = this.ensureModule()
+    module.setDeckTemplateLimits(maxDepth, maxOutputBytes, maxExpansions)
+  }
+
   /**
    * 获取牌堆大小
    */
@@ -282,6 +371,148 @@ export class DiceAdapter {
     return module.deckExists(deckName)
   }
 
+  /**
+   * 相似牌堆名（用于“你是不是要找”提示）
+   */
+  suggestDecks(query: string, limit: number = 5): string[] {
+    const module = this.ensureModule()
+    return module.suggestDecks(query, limit)
+  }
+
+  /**
+   * 按前缀列出牌堆名
+   */
+  listDecksByPrefix(prefix: string, limit: number = 20): string[] {
+    const module = this.ensureModule()
+    return module.listDecksByPrefix(prefix, limit)
+  }
+
+  /**
+   * 加载牌堆包；同一 packId 再次加载即热重载，只更新该包涉及的牌堆
+   * @param packId 包标识（通常为文件名）
+   * @param content 文件内容
+   * @param format 'json' | 'yaml'，省略时按扩展名或内容判断
+   */
+  loadDeckPack(
+    packId: string,
+    content: string,
+    format: string = ''
+  ): DeckPackLoadResult {
+    const module = this.ensureModule()
+    return module.loadDeckPack(packId, content, format)
+  }
+
+  /**
+   * 卸载牌堆包
+   */
+  unloadDeckPack(packId: string): boolean {
+    const module = this.ensureModule()
+    return module.unloadDeckPack(packId)
+  }
+
+  /**
+   * 各牌堆包的加载耗时与内存统计
+   */
+  getDeckPackStats(): DeckPackInfo[] {
+    const module = this.ensureModule()
+    return module.getDeckPackStats()
+  }
+
+  /**
+   * 牌堆内容字符串池的内存统计（含去重节省的字节数）
+   */
+  getDeckMemoryStats(): DeckMemoryStats {
+    const module = this.ensureModule()
+    return module.getDeckMemoryStats()
+  }
+
+  // ============ 频道牌堆 ============
+
+  /**
+   * 从公共牌堆创建频道牌堆（已存在时重新创建）
+   */
+  createChannelDeck(channelId: string, deckName: string): ChannelDeckResult {
+    const module = this.ensureModule()
+    return module.createChannelDeck(channelId, deckName)
+  }
+
+  /**
+   * 从频道牌堆抽牌（无放回，跨指令保持）
+   */
+  drawChannelDeck(
+    channelId: string,
+    deckName: string,
+    count: number = 1
+  ): ChannelDeckResult {
+    const module = this.ensureModule()
+    return module.drawChannelDeck(channelId, deckName, count)
+  }
+
+  /**
+   * 预览频道牌堆接下来的牌（不抽出）
+   */
+  peekChannelDeck(
+    channelId: string,
+    deckName: string,
+    count: number = 1
+  ): ChannelDeckResult {
+    const module = this.ensureModule()
+    return module.peekChannelDeck(channelId, deckName, count)
+  }
+
+  /**
+   * 将已抽出的牌放回频道牌堆
+   * @param card 牌面原文，省略时放回最近抽出的一张
+   */
+  returnChannelDeckCard(
+    channelId: string,
+    deckName: string,
+    card: string = ''
+  ): ChannelDeckResult {
+    const module = this.ensureModule()
+    return module.returnChannelDeckCard(channelId, deckName, card)
+  }
+
+  /**
+   * 收回频道牌堆的全部牌
+   */
+  resetChannelDeck(channelId: string, deckName: string): ChannelDeckResult {
+    const module = this.ensureModule()
+    return module.resetChannelDeck(channelId, deckName)
+  }
+
+  /**
+   * 删除频道牌堆
+   */
+  removeChannelDeck(channelId: string, deckName: string): boolean {
+    const module = this.ensureModule()
+    return module.removeChannelDeck(channelId, deckName)
+  }
+
+  /**
+   * 删除频道的全部频道牌堆
+   */
+  clearChannelDecks(channelId: string): boolean {
+    const module = this.ensureModule()
+    return module.clearChannelDecks(channelId)
+  }
+
+  /**
+   * 序列化频道牌堆（紧凑二进制快照的 Base64 文本）
+   */
+  serializeChannelDeck(channelId: string, deckName: string): string {
+    const module = this.ensureModule()
+    return module.serializeChannelDeck(channelId, deckName)
+  }
+
+  /**
+   * 从快照恢复频道牌堆（源牌堆内容变化时失败）
+   */
+  deserializeChannelDeck(channelId: string, snapshot: string): boolean {
+    const module = this.ensureModule()
+    return module.deserializeChannelDeck(channelId, snapshot)
+  }
+
   // ============ 规则查询功能 ============
 
   /**
@@ -316,6 +547,140 @@ export class DiceAdapter {
     return module.listRulesBySystem(system)
   }
 
+  // ============ 常驻人物卡 ============
+
+  /**
+   * 加载人物卡到 WASM 常驻存储（数据库仍为权威数据源）
+   * @param attributesJson 数据库中的 attributes 列
+   */
+  loadCard(
+    platform: string,
+    userId: string,
+    cardName: string,
+    attributesJson: string
+  ): boolean {
+    const module = this.ensureModule()
+    return module.loadCard(platform, userId, cardName, attributesJson)
+  }
+
+  /**
+   * 卸载常驻人物卡，有未写回的修改时返回其 JSON
+   */
+  unloadCard(
+    platform: string,
+    userId: string,
+    cardName: string
+  ): UnloadCardResult {
+    const module = this.ensureModule()
+    return module.unloadCard(platform, userId, cardName)
+  }
+
+  /**
+   * 人物卡是否已常驻
+   */
+  isCardLoaded(platform: string, userId: string, cardName: string): boolean {
+    const module = this.ensureModule()
+    return module.isCardLoaded(platform, userId, cardName)
+  }
+
+  /**
+   * 读取常驻人物卡属性
+   * @param names 属性名（支持同义词），空数组返回全部
+   * @returns 未加载时返回 null
+   */
+  getCardAttributes(
+    platform: string,
+    userId: string,
+    cardName: string,
+    names: string[] = []
+  ): Record<string, number> | null {
+    const module = this.ensureModule()
+    return module.getCardAttributes(platform, userId, cardName, names)
+  }
+
+  /**
+   * 写入常驻人物卡属性（标记为待写回）
+   */
+  setCardAttributes(
+    platform: string,
+    userId: string,
+    cardName: string,
+    attributes: Record<string, number>
+  ): boolean {
+    const module = this.ensureModule()
+    return module.setCardAttributes(platform, userId, cardName, attributes)
+  }
+
+  /**
+   * 对常驻人物卡执行 .st 命令，全部求值成功后才写入
+   */
+  applyStToCard(
+    platform: string,
+    userId: string,
+    cardName: string,
+    input: string,
+    system = 'COC7'
+  ): ApplyStResult {
+    const module = this.ensureModule()
+    return module.applyStToCard(platform, userId, cardName, input, system)
+  }
+
+  /**
+   * 导入人物卡文本到常驻人物卡（标记为待写回）
+   */
+  importSheetToCard(
+    platform: string,
+    userId: string,
+    cardName: string,
+    input: string
+  ): SheetImportResult {
+    const module = this.ensureModule()
+    return module.importSheetToCard(platform, userId, cardName, input)
+  }
+
+  /**
+   * 导出所有待写回的人物卡（不清除标记，写库成功后调用 ackDirtyCards）
+   */
+  exportDirtyCards(): DirtyCard[] {
+    const module = this.ensureModule()
+    return module.exportDirtyCards()
+  }
+
+  /**
+   * 确认已写回的人物卡，导出后又被修改的卡仍保持待写回
+   * @returns 已不再待写回的人物卡数量
+   */
+  ackDirtyCards(cards: Pick<DirtyCard, 'key' | 'generation'>[]): number {
+    const module = this.ensureModule()
+    return module.ackDirtyCards(
+      cards.map((card) => card.key),
+      cards.map((card) => card.generation)
+    )
+  }
+
+  /**
+   * 设置常驻人物卡容量与空闲超时（秒，0 为不超时）
+   */
+  setCardStoreLimits(maxCards: number, ttlSeconds: number = 0): void {
+    const module = this.ensureModule()
+    module.setCardStoreLimits(maxCards, ttlSeconds)
+  }
+
+  /**
+   * 常驻存储统计
+   */
+  getCardStoreStats(): {
+    cards: number
+    maxCards: number
+    dirty: number
+    spilled: number
+    evicted: number
+    internedAttributes: number
+  } {
+    const module = this.ensureModule()
+    return module.getCardStoreStats()
+  }
+
   /**
    * 创建角色卡
    */
@@ -421,6 +786,61 @@ export class DiceAdapter {
     return module.generateDNDCharacter(count)
   }
 
+  /**
+   * 结构化批量人物作成（直接返回属性表，无需解析文本）
+   * @param system 体系（COC7 / COC6 / DND）
+   * @param count 生成数量
+   * @param withText 是否同时返回格式化文本
+   */
+  generateCharacters(
+    system: string,
+    count = 1,
+    withText = false
+  ): GeneratedCharactersResult {
+    const module = this.ensureModule()
+    return module.generateCharacters(system, count, withText)
+  }
+
+  /**
+   * 按条件批量人物作成（如总和≥460、每项≥40、幸运≥50）
+   * @param system 体系（COC7 / COC6 / DND）
+   * @param count 需要的角色数量
+   * @param constraints 约束条件
+   * @param maxIterations 最多尝试次数，0表示使用默认值
+   */
+  generateCharactersWithConstraints(
+    system: string,
+    count: number,
+    constraints: CharacterConstraints,
+    maxIterations = 0
+  ): ConstrainedCharactersResult {
+    const module = this.ensureModule()
+    return module.generateCharactersWithConstraints(
+      system,
+      count,
+      constraints,
+      maxIterations
+    )
+  }
+
+  /**
+   * 生成单个角色的属性
+   * @param system 体系（COC7 / COC6 / DND）
+   * @returns 属性名到属性值的映射，体系不支持时返回空对象
+   */
+  generateAttributes(system: string): Record<string, number> {
+    const result = this.generateCharacters(system, 1)
+    const attributes: Record<string, number> = {}
+    if (!result.success) {
+      return attributes
+    }
+
+    result.columns.forEach((column, i) => {
+      attributes[column] = result.table[i]
+    })
+    return attributes
+  }
+
   // ============ 人物卡解析功能 ============
 
   /**
@@ -433,6 +853,16 @@ export class DiceAdapter {
     return module.parseCOCAttributes(input)
   }
 
+  /**
+   * 解析 COC 生成结果中的全部角色
+   * @param input COC 输出字符串（如 .coc 5 的结果）
+   * @returns 每个角色的属性对象
+   */
+  parseCOCCharacters(input: string): Array<Record<string, number>> {
+    const module = this.ensureModule()
+    return JSON.parse(module.parseCOCCharacters(input))
+  }
+
   /**
    * 规范化属性名
    * @param name 属性名
@@ -450,12 +880,51 @@ export class DiceAdapter {
    */
   parseStCommand(input: string): {
     cardName?: string
-    operations: Array<{ attr: string; op: string; value: number }>
+    operations: Array<{ attr: string; op: string; value: number | string }>
   } {
     const module = this.ensureModule()
     return module.parseStCommand(input)
   }
 
+  /**
+   * 解析并执行 .st 命令（支持 力量+10 理智-1d6 等增减写法）
+   * @param input 输入字符串
+   * @param attributes 当前属性表
+   * @param system 体系（COC7 / COC6 / DND），用于更新受影响的派生属性；传空字符串不更新
+   * @returns 各操作的旧值、新值与掷骰过程，以及变化的派生属性
+   */
+  applyStCommand(
+    input: string,
+    attributes: Record<string, number>,
+    system = ''
+  ): ApplyStResult {
+    const module = this.ensureModule()
+    return module.applyStCommand(input, attributes, system)
+  }
+
+  /**
+   * 按修改过的属性增量更新派生属性（生命、魔法、体格、移动力、伤害加值等）
+   * @param attributes 当前属性表（应已包含本次修改）
+   * @param changedNames 本次修改的属性名
+   */
+  updateDerivedAttributes(
+    system: string,
+    attributes: Record<string, number>,
+    changedNames: string[]
+  ): DerivedUpdateResult {
+    const module = this.ensureModule()
+    return module.updateDerivedAttributes(system, attributes, changedNames)
+  }
+
+  /**
+   * 导入人物卡文本（支持 "侦查60聆听50" 等无分隔符的导出格式）
+   * @param input 人物卡文本，可带 "名称--" 前缀
+   */
+  importCharacterSheet(input: string): SheetImportResult {
+    const module = this.ensureModule()
+    return module.importCharacterSheet(input)
+  }
+
   /**
    * 解析属性名列表
    * @param input 输入字符串
@@ -486,6 +955,44 @@ export class DiceAdapter {
     return module.sanityCheck(currentSan, successLoss, failureLoss)
   }
 
+  /**
+   * 理智检定（含疯狂判定）
+   * 损失触发疯狂时同时完成智力检定和症状抽取
+   * @param currentSan 当前理智值
+   * @param lossSpec 损失表达式 (如 "1/1d6")
+   * @param intelligence 智力值，0表示不进行智力检定
+   * @param rule COC房规（0-5）；默认 -1 使用内置判定（大成功≤5，技能未过时96-100大失败）
+   */
+  sanityCheckWithInsanity(
+    currentSan: number,
+    lossSpec: string,
+    intelligence = 0,
+    rule = -1
+  ): SanityCheckWithInsanityResult {
+    const module = this.ensureModule()
+    return module.sanityCheckWithInsanity(
+      currentSan,
+      lossSpec,
+      intelligence,
+      rule
+    )
+  }
+
+  /**
+   * 全队理智检定（一次调用完成所有调查员）
+   * @param investigators 调查员列表
+   * @param lossSpec 损失表达式 (如 "1d3/1d10")
+   * @param defaultRule 未单独指定时使用的COC房规（0-5）；默认 -1 使用内置判定（大成功≤5，技能未过时96-100大失败）
+   */
+  sanityCheckBatch(
+    investigators: SanityBatchInvestigator[],
+    lossSpec: string,
+    defaultRule = -1
+  ): SanityCheckBatchResult {
+    const module = this.ensureModule()
+    return module.sanityCheckBatch(investigators, lossSpec, defaultRule)
+  }
+
   // ============ 疯狂症状功能 ============
 
   /**
@@ -547,6 +1054,15 @@ export class DiceAdapter {
     return module.rollInitiative(channelId, name, modifier)
   }
 
+  /**
+   * 批量先攻检定
+   * @param groups 各组怪物，如 [{ name: '深潜者', count: 6, modifier: 2 }]
+   */
+  rollInitiativeBatch(channelId: string, groups: InitiativeBatchGroup[]): InitiativeBatchResult {
+    const module = this.ensureModule()
+    return module.rollInitiativeBatch(channelId, groups)
+  }
+
   /**
    * 移除先攻条目
    */
@@ -587,6 +1103,62 @@ export class DiceAdapter {
     return module.getInitiativeCount(channelId)
   }
 
+  /**
+   * 修改先攻值（保留当前回合）
+   */
+  updateInitiative(channelId: string, name: string, initiative: number): InitiativeUpdateResult {
+    const module = this.ensureModule()
+    return module.updateInitiative(channelId, name, initiative)
+  }
+
+  /**
+   * 延迟行动
+   */
+  delayInitiative(channelId: string, name: string): InitiativeUpdateResult {
+    const module = this.ensureModule()
+    return module.delayInitiative(channelId, name)
+  }
+
+  /**
+   * 结束延迟，插入到当前行动者之前立即行动
+   */
+  readyInitiative(channelId: string, name: string): InitiativeUpdateResult {
+    const module = this.ensureModule()
+    return module.readyInitiative(channelId, name)
+  }
+
+  /**
+   * 添加状态效果
+   * @param rounds 持续轮数，第 rounds 次轮到参照角色时到期
+   * @param anchor 参照角色，缺省为当前行动者
+   */
+  addInitiativeCondition(
+    channelId: string,
+    target: string,
+    label: string,
+    rounds: number,
+    anchor: string = ''
+  ): InitiativeConditionResult {
+    const module = this.ensureModule()
+    return module.addInitiativeCondition(channelId, target, label, rounds, anchor)
+  }
+
+  /**
+   * 移除状态效果
+   */
+  removeInitiativeCondition(channelId: string, id: number): boolean {
+    const module = this.ensureModule()
+    return module.removeInitiativeCondition(channelId, id)
+  }
+
+  /**
+   * 获取所有状态效果
+   */
+  getInitiativeConditions(channelId: string): InitiativeCondition[] {
+    const module = this.ensureModule()
+    return module.getInitiativeConditions(channelId)
+  }
+
   /**
    * 序列化先攻列表
    */
@@ -596,13 +1168,79 @@ export class DiceAdapter {
   }
 
   /**
-   * 反序列化先攻列表
+   * 反序列化先攻列表（JSON 或二进制快照）
    */
   deserializeInitiative(channelId: string, jsonStr: string): boolean {
     const module = this.ensureModule()
     return module.deserializeInitiative(channelId, jsonStr)
   }
 
+  /**
+   * 生成先攻列表二进制快照（Base64），并清空该频道的变更日志
+   */
+  serializeInitiativeBinary(channelId: string): string {
+    const module = this.ensureModule()
+    return module.serializeInitiativeBinary(channelId)
+  }
+
+  /**
+   * 批量导出所有频道自上次导出以来的先攻变更
+   */
+  flushInitiativeChanges(): InitiativeChange[] {
+    const module = this.ensureModule()
+    return module.flushInitiativeChanges()
+  }
+
+  /**
+   * 回放一条先攻增量
+   */
+  applyInitiativeDelta(channelId: string, delta: string): boolean {
+    const module = this.ensureModule()
+    return module.applyInitiativeDelta(channelId, delta)
+  }
+
+  /**
+   * 频道先攻列表是否驻留在内存中
+   */
+  isInitiativeLoaded(channelId: string): boolean {
+    const module = this.ensureModule()
+    return module.isInitiativeLoaded(channelId)
+  }
+
+  /**
+   * 设置先攻状态表容量与空闲超时（秒，0 为不超时）
+   */
+  setInitiativeTableLimits(maxChannels: number, ttlSeconds: number = 0): void {
+    const module = this.ensureModule()
+    module.setInitiativeTableLimits(maxChannels, ttlSeconds)
+  }
+
+  /**
+   * 设置先攻列表逐出回调，接收频道快照用于落盘
+   */
+  setInitiativeEvictionHandler(
+    handler: ((channelId: string, snapshot: string, reason: 'capacity' | 'expired') => void) | null
+  ): void {
+    const module = this.ensureModule()
+    module.setInitiativeEvictionHandler(handler)
+  }
+
+  /**
+   * 设置先攻列表同步载入回调，返回快照或 undefined
+   */
+  setInitiativeLoadHandler(handler: ((channelId: string) => string | undefined) | null): void {
+    const module = this.ensureModule()
+    module.setInitiativeLoadHandler(handler)
+  }
+
+  /**
+   * 获取先攻状态表统计
+   */
+  getInitiativeTableStats(): InitiativeTableStats {
+    const module = this.ensureModule()
+    return module.getInitiativeTableStats()
+  }
+
   // ============ 扩展系统 ============
 
   /**
@@ -60,6 +60,170 @@ export interface SanityCheckResult {
   errorMsg: string
 }
 
+/**
+ * 结构化角色生成结果
+ * table 按行存放，每个角色 stride 列，列名见 columns
+ */
+export interface GeneratedCharactersResult {
+  success: boolean
+  errorMsg?: string
+  system: string
+  count: number
+  columns: string[]
+  stride: number
+  table: Int32Array
+  totals: Int32Array // 基础属性总和（COC 不含幸运）
+  damageBonus: string[]
+  text?: string
+}
+
+/**
+ * 角色生成约束
+ */
+export interface CharacterConstraints {
+  minTotal?: number // 基础属性总和下限（COC 不含幸运）
+  maxTotal?: number
+  minEach?: number // 每项基础属性下限
+  maxEach?: number
+  attributes?: Record<string, { min?: number; max?: number }>
+}
+
+/**
+ * 条件约束角色生成结果
+ */
+export interface ConstrainedCharactersResult extends GeneratedCharactersResult {
+  complete: boolean // 是否生成了全部请求数量
+  requested: number
+  iterations: number
+  maxIterations: number
+  acceptanceRate: number
+}
+
+/**
+ * 常驻人物卡卸载结果
+ */
+export interface UnloadCardResult {
+  success: boolean
+  dirty: boolean
+  attributes?: string // 有未写回的修改时附带的 JSON
+}
+
+/**
+ * .st 操作的求值结果
+ */
+export interface AttributeUpdate {
+  attr: string
+  op: 'set' | 'add' | 'sub'
+  oldValue: number
+  newValue: number
+  delta: number // 本次求得的数值（set 时为新值）
+  detail: string // 掷骰过程，常数时为空
+}
+
+/**
+ * 派生属性变化
+ */
+export interface DerivedChange {
+  attr: string
+  oldValue?: number // 变化前不存在时省略
+  newValue: number
+  text?: string // 文本形式的值（如伤害加值 "+1D4"）
+}
+
+/**
+ * .st 命令执行结果
+ */
+export interface ApplyStResult {
+  success: boolean
+  cardName?: string
+  updates?: AttributeUpdate[]
+  derived?: DerivedChange[] // 受影响的派生属性
+  attributes?: Record<string, number> // 被修改属性（含派生属性）的新值
+  errorMsg: string
+}
+
+/**
+ * 派生属性增量更新结果
+ */
+export interface DerivedUpdateResult {
+  success: boolean
+  derived?: DerivedChange[]
+  attributes?: Record<string, number> // 变化的派生数值属性
+  errorMsg: string
+}
+
+/**
+ * 人物卡文本导入结果
+ */
+export interface SheetImportResult {
+  success: boolean
+  cardName?: string
+  count: number // 识别到的属性数（含重复）
+  skipped: number // 被跳过的片段数
+  attributes?: Record<string, number> // importSheetToCard 不返回
+  errorMsg: string
+}
+
+/**
+ * 待写回的常驻人物卡
+ */
+export interface DirtyCard {
+  key: string // 确认写回时原样传给 ackDirtyCards
+  generation: number // 导出时的版本
+  platform: string
+  userId: string
+  cardName: string
+  attributes: string
+}
+
+/**
+ * 疯狂判定结果
+ */
+export interface InsanityResult {
+  type: 'none' | 'temporary' | 'indefinite' | 'permanent'
+  intCheckRequired: boolean // 损失达到5点但未提供智力
+  intRoll: number
+  symptomIndex: number
+  duration: number
+  symptom: string // 已替换 {dur}/{detail_roll}/{detail}，保留 {pc}/{nick}
+  detailIndex: number
+  detail: string
+}
+
+/**
+ * 理智检定结果（含疯狂判定）
+ */
+export interface SanityCheckWithInsanityResult extends SanityCheckResult {
+  insanity: InsanityResult
+}
+
+/**
+ * 全队理智检定中的调查员
+ */
+export interface SanityBatchInvestigator {
+  name: string
+  currentSan: number
+  intelligence?: number
+  rule?: number
+}
+
+/**
+ * 全队理智检定结果
+ * table 按行存放，每行 stride 列，列名见 columns
+ * insanityType: 0-无, 1-临时, 2-不定, 3-永久
+ */
+export interface SanityCheckBatchResult {
+  success: boolean
+  errorMsg?: string
+  count: number
+  columns: string[]
+  stride: number
+  table: Int32Array
+  names: string[]
+  lossDetails: string[]
+  symptoms: string[]
+}
+
 /**
  * 先攻检定结果
  */
@@ -70,6 +234,51 @@ export interface InitiativeRollResult {
   message?: string
 }
 
+/**
+ * 批量先攻检定的一组怪物
+ */
+export interface InitiativeBatchGroup {
+  name: string
+  count?: number
+  modifier?: number
+  tiebreak?: number
+}
+
+/**
+ * 批量先攻检定结果
+ * table 按行排列，每行依次为 columns 中的 roll / modifier / initiative / tiebreak
+ */
+export interface InitiativeBatchResult {
+  success: boolean
+  message?: string
+  count: number
+  names: string[]
+  columns: string[]
+  stride: number
+  table: Int32Array
+}
+
+/**
+ * 先攻状态效果
+ * 在第 expireRound 轮轮到 anchor 行动时到期（anchor 为空表示该轮开始时）
+ */
+export interface InitiativeCondition {
+  id: number
+  target: string
+  label: string
+  anchor: string
+  expireRound: number
+  duration: number
+  remainingRounds?: number
+}
+
+/**
+ * 到期的状态效果；late 表示参照角色该轮没有行动，在轮末补发
+ */
+export interface InitiativeConditionEvent extends InitiativeCondition {
+  late: boolean
+}
+
 /**
  * 先攻回合结果
  */
@@ -78,9 +287,60 @@ export interface InitiativeTurnResult {
   currentName: string
   currentInitiative: number
   currentRound: number
+  expired?: InitiativeConditionEvent[]
   message?: string
 }
 
+/**
+ * 先攻条目调整结果（修改先攻、延迟、结束延迟）
+ */
+export interface InitiativeUpdateResult {
+  success: boolean
+  message: string
+  currentName?: string
+  currentInitiative?: number
+  currentRound?: number
+  expired?: InitiativeConditionEvent[]
+}
+
+/**
+ * 添加状态效果结果
+ */
+export interface InitiativeConditionResult extends InitiativeUpdateResult {
+  id?: number
+  anchor?: string
+  expireRound?: number
+}
+
+/**
+ * 先攻变更导出项（flushInitiativeChanges）
+ * delta 需按顺序追加回放；snapshot 可替换此前保存的快照与增量；removed 表示列表已清空
+ */
+export interface InitiativeChange {
+  channelId: string
+  kind: 'delta' | 'snapshot' | 'removed'
+  data: string
+}
+
+/**
+ * 先攻频道状态表统计
+ */
+export interface InitiativeTableStats {
+  channels: number
+  maxChannels: number
+  ttlSeconds: number
+  entries: number
+  memoryBytes: number
+  hits: number
+  misses: number
+  reloads: number
+  evictedCapacity: number
+  evictedExpired: number
+  dirtyChannels: number
+  spilledChannels: number
+  spilledBytes: number
+}
+
 /**
  * 牌堆抽取结果
  */
@@ -88,6 +348,54 @@ export interface DeckDrawResult {
   success: boolean
   message?: string
   cards: string[]
+  totalCards?: number // 牌堆总张数（按权重计）
+}
+
+/**
+ * 牌堆包信息（加载结果与统计）
+ */
+export interface DeckPackInfo {
+  packId: string
+  title: string
+  author: string
+  decks: number
+  cards: number
+  sourceBytes: number // 文件字节数
+  cardBytes: number // 牌面文本字节数（去重前）
+  indexBytes: number // 牌堆索引占用字节数
+  loadMs: number // 解析耗时
+}
+
+/**
+ * 牌堆内容字符串池统计
+ */
+export interface DeckMemoryStats {
+  strings: number // 不同文本数
+  references: number // 引用总数
+  storedBytes: number // 实际存放的文本字节数
+  referencedBytes: number // 不去重时需要的文本字节数
+  savedBytes: number // 牌堆包因去重节省的字节数（不含编译缓存等的引用）
+  blockBytes: number // 竞技场已分配字节数
+  blocks: number
+  reclaimedBlocks: number // 累计整体回收的块数
+  packs: number
+}
+
+export interface DeckPackLoadResult extends Partial<DeckPackInfo> {
+  success: boolean
+  message: string
+  reloaded?: boolean
+}
+
+/**
+ * 频道牌堆操作结果
+ */
+export interface ChannelDeckResult {
+  success: boolean
+  message: string
+  cards: string[]
+  remaining?: number // 剩余张数
+  total?: number // 总张数（按权重计）
 }
 
 /**
@@ -135,6 +443,18 @@ export interface DiceModule {
     defaultDice?: number
   ): CommandResult
   processCheck(rawCommand: string, userId: string, rule?: number): any
+  processCheckWithAttributes(
+    rawCommand: string,
+    rule: number,
+    attributes: Record<string, number> | null
+  ): any
+  processCheckWithCard(
+    rawCommand: string,
+    rule: number,
+    platform: string,
+    userId: string,
+    cardName: string
+  ): any
   processCOCCheck(skillValue: number, bonusDice?: number): COCCheckResult
 
   // === 旧接口（保持兼容） ===
@@ -153,14 +473,36 @@ export interface DiceModule {
   generateCOC7Multiple(count: number): string
   generateCOC6Multiple(count: number): string
   generateDNDCharacter(count?: number): string
+  generateCharacters(
+    system: string,
+    count: number,
+    withText: boolean
+  ): GeneratedCharactersResult
+  generateCharactersWithConstraints(
+    system: string,
+    count: number,
+    constraints: CharacterConstraints,
+    maxIterations: number
+  ): ConstrainedCharactersResult
 
   // 人物卡解析功能
   parseCOCAttributes(input: string): string
+  parseCOCCharacters(input: string): string
   normalizeAttributeName(name: string): string
   parseStCommand(input: string): {
     cardName?: string
-    operations: Array<{ attr: string; op: string; value: number }>
+    operations: Array<{ attr: string; op: string; value: number | string }>
   }
+  applyStCommand(
+    input: string,
+    attributes: Record<string, number>,
+    system: string
+  ): ApplyStResult
+  updateDerivedAttributes(
+    system: string,
+    attributes: Record<string, number>,
+    changedNames: string[]
+  ): DerivedUpdateResult
   parseAttributeList(input: string): {
     cardName?: string
     attributes: string[]
@@ -172,6 +514,17 @@ export interface DiceModule {
     successLoss: string,
     failureLoss: string
   ): SanityCheckResult
+  sanityCheckWithInsanity(
+    currentSan: number,
+    lossSpec: string,
+    intelligence: number,
+    rule: number
+  ): SanityCheckWithInsanityResult
+  sanityCheckBatch(
+    investigators: SanityBatchInvestigator[],
+    lossSpec: string,
+    defaultRule: number
+  ): SanityCheckBatchResult
 
   // 疯狂症状功能
   getTempInsanity(index: number): string
@@ -186,20 +539,83 @@ export interface DiceModule {
     name: string,
     modifier?: number
   ): InitiativeRollResult
+  rollInitiativeBatch(channelId: string, groups: InitiativeBatchGroup[]): InitiativeBatchResult
   removeInitiative(channelId: string, name: string): boolean
   clearInitiative(channelId: string): boolean
   nextInitiativeTurn(channelId: string): InitiativeTurnResult
   getInitiativeList(channelId: string): string
   getInitiativeCount(channelId: string): number
+  updateInitiative(channelId: string, name: string, initiative: number): InitiativeUpdateResult
+  delayInitiative(channelId: string, name: string): InitiativeUpdateResult
+  readyInitiative(channelId: string, name: string): InitiativeUpdateResult
+  addInitiativeCondition(
+    channelId: string,
+    target: string,
+    label: string,
+    rounds: number,
+    anchor: string
+  ): InitiativeConditionResult
+  removeInitiativeCondition(channelId: string, id: number): boolean
+  getInitiativeConditions(channelId: string): InitiativeCondition[]
   serializeInitiative(channelId: string): string
   deserializeInitiative(channelId: string, jsonStr: string): boolean
+  serializeInitiativeBinary(channelId: string): string
+  flushInitiativeChanges(): InitiativeChange[]
+  applyInitiativeDelta(channelId: string, delta: string): boolean
+  isInitiativeLoaded(channelId: string): boolean
+  setInitiativeTableLimits(maxChannels: number, ttlSeconds: number): void
+  setInitiativeEvictionHandler(
+    handler: ((channelId: string, snapshot: string, reason: 'capacity' | 'expired') => void) | null
+  ): void
+  setInitiativeLoadHandler(handler: ((channelId: string) => string | undefined) | null): void
+  getInitiativeTableStats(): InitiativeTableStats
 
   // 牌堆功能
   drawFromDeck(deckName: string, count?: number): DeckDrawResult
   shuffleDeck(deckName: string, count?: number): DeckDrawResult
+  drawFromDeckWithReplacement(deckName: string, count: number): DeckDrawResult
   listDecks(): string
   getDeckSize(deckName: string): number
   deckExists(deckName: string): boolean
+  suggestDecks(query: string, limit: number): string[]
+  listDecksByPrefix(prefix: string, limit: number): string[]
+  loadDeckPack(
+    packId: string,
+    content: string,
+    format: string
+  ): DeckPackLoadResult
+  unloadDeckPack(packId: string): boolean
+  getDeckPackStats(): DeckPackInfo[]
+  getDeckMemoryStats(): DeckMemoryStats
+  invalidateDeckCache(deckName: string): void
+  setDeckTemplateLimits(
+    maxDepth: number,
+    maxOutputBytes: number,
+    maxExpansions: number
+  ): void
+
+  // 频道牌堆（跨指令无放回发牌）
+  createChannelDeck(channelId: string, deckName: string): ChannelDeckResult
+  drawChannelDeck(
+    channelId: string,
+    deckName: string,
+    count: number
+  ): ChannelDeckResult
+  peekChannelDeck(
+    channelId: string,
+    deckName: string,
+    count: number
+  ): ChannelDeckResult
+  returnChannelDeckCard(
+    channelId: string,
+    deckName: string,
+    card: string
+  ): ChannelDeckResult
+  resetChannelDeck(channelId: string, deckName: string): ChannelDeckResult
+  removeChannelDeck(channelId: string, deckName: string): boolean
+  clearChannelDecks(channelId: string): boolean
+  serializeChannelDeck(channelId: string, deckName: string): string
+  deserializeChannelDeck(channelId: string, snapshot: string): boolean
 
   // 规则查询功能
   queryRule(query: string): RuleQueryResult
@@ -207,6 +623,56 @@ export interface DiceModule {
   listRuleKeys(): string[]
   listRulesBySystem(system: string): string[]
 
+  // 常驻人物卡
+  loadCard(
+    platform: string,
+    userId: string,
+    cardName: string,
+    attributesJson: string
+  ): boolean
+  unloadCard(
+    platform: string,
+    userId: string,
+    cardName: string
+  ): UnloadCardResult
+  isCardLoaded(platform: string, userId: string, cardName: string): boolean
+  getCardAttributes(
+    platform: string,
+    userId: string,
+    cardName: string,
+    names: string[]
+  ): Record<string, number> | null
+  setCardAttributes(
+    platform: string,
+    userId: string,
+    cardName: string,
+    attributes: Record<string, number>
+  ): boolean
+  applyStToCard(
+    platform: string,
+    userId: string,
+    cardName: string,
+    input: string,
+    system: string
+  ): ApplyStResult
+  importSheetToCard(
+    platform: string,
+    userId: string,
+    cardName: string,
+    input: string
+  ): SheetImportResult
+  exportDirtyCards(): DirtyCard[]
+  ackDirtyCards(keys: string[], generations: number[]): number
+  setCardStoreLimits(maxCards: number, ttlSeconds: number): void
+  getCardStoreStats(): {
+    cards: number
+    maxCards: number
+    dirty: number
+    spilled: number
+    evicted: number
+    internedAttributes: number
+  }
+
   // 角色卡功能
   createCharacter(characterName: string): boolean
   setCharacterAttr(
@@ -0,0 +1,72 @@
+// 属性同义词查找：旧版（小写副本 + unordered_map）对比编译期完美哈希
+#include "bench_common.h"
+#include "core/attribute_alias.h"
+#include "features/character_parser.h"
+#include <algorithm>
+#include <cctype>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace koidice;
+
+namespace {
+
+// 旧版实现，原样保留作为对照
+const std::unordered_map<std::string, std::string> LEGACY_ALIASES = {
+    {"str", "力量"}, {"力量", "力量"}, {"strength", "力量"},
+    {"con", "体质"}, {"体质", "体质"}, {"constitution", "体质"},
+    {"siz", "体型"}, {"体型", "体型"}, {"size", "体型"},
+    {"dex", "敏捷"}, {"敏捷", "敏捷"}, {"dexterity", "敏捷"},
+    {"app", "外貌"}, {"外貌", "外貌"}, {"appearance", "外貌"},
+    {"int", "智力"}, {"智力", "智力"}, {"intelligence", "智力"},
+    {"pow", "意志"}, {"意志", "意志"}, {"power", "意志"},
+    {"edu", "教育"}, {"教育", "教育"}, {"education", "教育"},
+    {"luck", "幸运"}, {"幸运", "幸运"}, {"luk", "幸运"},
+    {"san", "理智"}, {"理智", "理智"}, {"sanity", "理智"},
+    {"hp", "生命"}, {"生命", "生命"}, {"生命值", "生命"},
+    {"mp", "魔法"}, {"魔法", "魔法"}, {"魔法值", "魔法"},
+    {"db", "伤害加值"}, {"伤害加值", "伤害加值"}, {"伤害奖励", "伤害加值"},
+    {"mov", "移动力"}, {"移动力", "移动力"}, {"move", "移动力"}
+};
+
+std::string legacyNormalizeAttributeName(const std::string& name) {
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    lower.erase(std::remove_if(lower.begin(), lower.end(), ::isspace), lower.end());
+
+    auto it = LEGACY_ALIASES.find(lower);
+    if (it != LEGACY_ALIASES.end()) {
+        return it->second;
+    }
+    return name;
+}
+
+// 规范名、英文缩写、大小写混合、带空格与不认识的名称各占一部分
+const std::vector<std::string> NAMES = {
+    "力量", "STR", "dex", "Sanity", "hp", "生命值", "意志", "edu",
+    "伤害加值", "Move", "luck", " app ", "克苏鲁神话", "自定义技能", "xyz"
+};
+
+constexpr size_t ITERATIONS = 2000000;
+
+} // namespace
+
+int main() {
+    double legacy = bench::measureNs(ITERATIONS, [](size_t i) {
+        bench::consume(legacyNormalizeAttributeName(NAMES[i % NAMES.size()]).size());
+    });
+    double normalized = bench::measureNs(ITERATIONS, [](size_t i) {
+        bench::consume(normalizeAttributeName(NAMES[i % NAMES.size()]).size());
+    });
+    double lookup = bench::measureNs(ITERATIONS, [](size_t i) {
+        bench::consume(lookupAttributeAlias(NAMES[i % NAMES.size()]));
+    });
+
+    bench::report("legacy normalizeAttributeName", legacy);
+    bench::report("normalizeAttributeName", normalized);
+    bench::report("lookupAttributeAlias", lookup);
+    bench::finish();
+    return 0;
+}
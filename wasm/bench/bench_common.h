@@ -0,0 +1,47 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+namespace koidice {
+namespace bench {
+
+// 被测结果累加到这里并在结束时输出，避免调用被优化掉
+inline uint64_t& checksum() {
+    static uint64_t value = 0;
+    return value;
+}
+
+inline void consume(uint64_t value) {
+    checksum() = checksum() * 31 + value;
+}
+
+/**
+ * 先预热 1/10 的次数，再计时调用 fn(i) iterations 次
+ * @return 每次调用的平均纳秒数
+ */
+template <typename F>
+double measureNs(size_t iterations, F&& fn) {
+    for (size_t i = 0; i < iterations / 10 + 1; i++) {
+        fn(i);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        fn(i);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(iterations);
+}
+
+inline void report(const char* name, double ns) {
+    std::printf("%-36s %12.1f ns/op\n", name, ns);
+}
+
+inline void finish() {
+    std::printf("(checksum %llu)\n", static_cast<unsigned long long>(checksum()));
+}
+
+} // namespace bench
+} // namespace koidice
@@ -0,0 +1,121 @@
+// 技能检定吞吐（按房规）：旧版逐轮 RD + RollSuccessLevel 对比特化调度表
+#include "bench_common.h"
+#include "core/check_handler.h"
+#include "core/utils.h"
+#include "../../Dice/Dice/RD.h"
+#include <cstdio>
+#include <string>
+
+using namespace koidice;
+
+namespace {
+
+// 旧版 CheckHandler::check，原样保留作为对照：每轮一个 RD，成功等级逐次调用 RollSuccessLevel
+CheckRoundResult legacyCheckOnce(int skillValue, int bonusDice, bool autoSuccess, int rule) {
+    CheckRoundResult result;
+    result.skillValue = skillValue;
+
+    std::string expression;
+    if (bonusDice > 0) {
+        expression = std::to_string(bonusDice) + "B";
+    } else if (bonusDice < 0) {
+        expression = std::to_string(-bonusDice) + "P";
+    } else {
+        expression = "1D100";
+    }
+
+    RD rd(expression, 100);
+    int_errno err = rd.Roll();
+
+    if (err != 0) {
+        result.rollValue = 0;
+        result.successLevel = SuccessLevel::Failure;
+        result.description = "掷骰失败: " + getErrorMessage(err);
+        return result;
+    }
+
+    result.rollValue = rd.intTotal;
+
+    SuccessLevel level = autoSuccess && result.rollValue <= skillValue
+        ? SuccessLevel::RegularSuccess
+        : static_cast<SuccessLevel>(RollSuccessLevel(result.rollValue, skillValue, rule));
+
+    result.successLevel = level;
+    result.description = getSuccessLevelDesc(static_cast<int>(level), autoSuccess);
+    return result;
+}
+
+emscripten::val legacyCheck(const std::string& skillName, int skillValue, int rounds, int bonusDice,
+                            Difficulty difficulty, bool autoSuccess, int rule) {
+    emscripten::val result = emscripten::val::object();
+
+    int finalSkillValue = skillValue / static_cast<int>(difficulty);
+    emscripten::val results = emscripten::val::array();
+
+    for (int i = 0; i < rounds; i++) {
+        CheckRoundResult roundResult = legacyCheckOnce(finalSkillValue, bonusDice, autoSuccess, rule);
+
+        emscripten::val jsRound = emscripten::val::object();
+        jsRound.set("rollValue", roundResult.rollValue);
+        jsRound.set("skillValue", roundResult.skillValue);
+        jsRound.set("successLevel", static_cast<int>(roundResult.successLevel));
+        jsRound.set("description", roundResult.description);
+
+        results.call<void>("push", jsRound);
+    }
+
+    result.set("success", true);
+    result.set("skillName", skillName);
+    result.set("originalSkillValue", skillValue);
+    result.set("finalSkillValue", finalSkillValue);
+    result.set("difficulty", static_cast<int>(difficulty));
+    result.set("rounds", rounds);
+    result.set("results", results);
+    return result;
+}
+
+struct Scenario {
+    const char* name;
+    int rounds;
+    int bonusDice;
+    Difficulty difficulty;
+};
+
+const Scenario SCENARIOS[] = {
+    {"1 round", 1, 0, Difficulty::Normal},
+    {"3 rounds hard", 3, 0, Difficulty::Hard},
+    {"1 round 2 bonus dice", 1, 2, Difficulty::Normal},
+    {"3 rounds 1 penalty die", 3, -1, Difficulty::Normal},
+};
+
+constexpr size_t ITERATIONS = 200000;
+
+} // namespace
+
+int main() {
+    ensureRandomInit();
+    const std::string skillName = "侦查";
+
+    std::printf("%-6s %-24s %12s %12s %8s\n", "rule", "scenario", "legacy", "dispatch", "speedup");
+    for (int rule = 0; rule <= 5; rule++) {
+        for (const Scenario& scenario : SCENARIOS) {
+            // 技能值随迭代变化，覆盖成功等级表缓存的常见取值
+            double legacy = bench::measureNs(ITERATIONS, [&](size_t i) {
+                emscripten::val result = legacyCheck(skillName, 30 + static_cast<int>(i % 60), scenario.rounds,
+                                                     scenario.bonusDice, scenario.difficulty, false, rule);
+                bench::consume(result["finalSkillValue"].as<int>());
+            });
+            double dispatch = bench::measureNs(ITERATIONS, [&](size_t i) {
+                emscripten::val result = CheckHandler::check(skillName, 30 + static_cast<int>(i % 60), scenario.rounds,
+                                                             scenario.bonusDice, scenario.difficulty, false, rule);
+                bench::consume(result["finalSkillValue"].as<int>());
+            });
+
+            std::printf("%-6d %-24s %9.0f ns %9.0f ns %7.2fx\n", rule, scenario.name, legacy, dispatch,
+                        legacy / dispatch);
+        }
+    }
+
+    bench::finish();
+    return 0;
+}
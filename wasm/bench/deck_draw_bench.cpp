@@ -0,0 +1,93 @@
+// 无放回抽牌延迟与牌堆大小：旧版全量洗牌 / Fenwick 加权抽样 / 部分 Fisher–Yates
+#include "bench_common.h"
+#include "core/utils.h"
+#include "core/weighted_sampler.h"
+#include <algorithm>
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+using namespace koidice;
+
+namespace {
+
+// 旧版 shuffleDeck：展开后整副洗牌，每次交换取一个随机数
+size_t legacyFullShuffle(size_t n, size_t k) {
+    std::vector<uint32_t> deck(n);
+    for (size_t i = 0; i < n; i++) {
+        deck[i] = static_cast<uint32_t>(i);
+    }
+    for (int i = static_cast<int>(deck.size()) - 1; i > 0; i--) {
+        int j = getSecureRandomInt(0, i);
+        std::swap(deck[i], deck[j]);
+    }
+
+    size_t sum = 0;
+    for (size_t i = 0; i < k; i++) {
+        sum += deck[i];
+    }
+    return sum;
+}
+
+// 与 shuffleDeck 相同：每次抽取新建随机缓冲区，按抽取数量预取
+size_t fenwickDraw(const FenwickTree& tree, size_t k) {
+    SecureRandomBuffer rng;
+    rng.reserve(k * 2);
+    FenwickSampler sampler(tree);
+
+    size_t sum = 0;
+    for (size_t i = 0; i < k; i++) {
+        sum += sampler.drawOne(rng);
+    }
+    return sum;
+}
+
+size_t partialShuffleDraw(size_t n, size_t k) {
+    SecureRandomBuffer rng;
+    rng.reserve(k * 2);
+    PartialShuffle shuffle(n, k);
+
+    size_t sum = 0;
+    for (size_t i = 0; i < k; i++) {
+        sum += shuffle.drawOne(rng);
+    }
+    return sum;
+}
+
+// 旧版每次调用的代价与 n 成正比，按 n 缩减次数使每组耗时相近
+size_t iterationsFor(size_t n, size_t budget) {
+    return std::max<size_t>(5, budget / n);
+}
+
+} // namespace
+
+int main() {
+    const size_t sizes[] = {10, 100, 1000, 10000, 100000};
+    const size_t draws[] = {1, 5};
+
+    std::printf("%-16s %14s %14s %14s\n", "n / k", "full shuffle", "fenwick", "partial");
+    for (size_t n : sizes) {
+        // 无权重牌堆：每项权重为 1；树在编译牌堆时构建一次，不计入抽取
+        FenwickTree tree;
+        tree.build(std::vector<uint32_t>(n, 1));
+
+        for (size_t k : draws) {
+            double full = bench::measureNs(iterationsFor(n, 2000000), [&](size_t) {
+                bench::consume(legacyFullShuffle(n, k));
+            });
+            double fenwick = bench::measureNs(200000, [&](size_t) {
+                bench::consume(fenwickDraw(tree, k));
+            });
+            double partial = bench::measureNs(200000, [&](size_t) {
+                bench::consume(partialShuffleDraw(n, k));
+            });
+
+            char label[32];
+            std::snprintf(label, sizeof(label), "n=%zu k=%zu", n, k);
+            std::printf("%-16s %11.0f ns %11.0f ns %11.0f ns\n", label, full, fenwick, partial);
+        }
+    }
+
+    bench::finish();
+    return 0;
+}
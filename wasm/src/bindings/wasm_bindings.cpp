@@ -8,6 +8,14 @@
 #include "../features/initiative.h"
 #include "../features/deck.h"
 #include "../features/rule.h"
+#include "../features/card_store.h"
+#include "../features/deck_compiler.h"
+#include "../features/deck_registry.h"
+#include "../features/deck_pack.h"
+#include "../features/channel_deck.h"
+#include "../features/deck_template.h"
+#include "../features/sheet_parser.h"
+#include "../features/derived_attributes.h"
 #include "../dice_character_parse.h"
 #include "../extensions/extension_manager.h"
 #include "../../../Dice/Dice/RD.h"
@@ -23,25 +31,73 @@ using koidice::generateCOC6CharacterDetailed;
 using koidice::generateCOC7Multiple;
 using koidice::generateCOC6Multiple;
 using koidice::generateDNDCharacter;
+using koidice::generateCharacters;
+using koidice::generateCharactersWithConstraints;
 using koidice::getTempInsanity;
 using koidice::getLongInsanity;
 using koidice::getPhobia;
 using koidice::getMania;
 using koidice::sanityCheck;
+using koidice::sanityCheckWithInsanity;
+using koidice::sanityCheckBatch;
 using koidice::addInitiative;
 using koidice::rollInitiative;
+using koidice::rollInitiativeBatch;
 using koidice::removeInitiative;
 using koidice::clearInitiative;
 using koidice::nextInitiativeTurn;
 using koidice::getInitiativeList;
 using koidice::getInitiativeCount;
+using koidice::updateInitiative;
+using koidice::delayInitiative;
+using koidice::readyInitiative;
+using koidice::addInitiativeCondition;
+using koidice::removeInitiativeCondition;
+using koidice::getInitiativeConditions;
 using koidice::serializeInitiative;
 using koidice::deserializeInitiative;
+using koidice::serializeInitiativeBinary;
+using koidice::flushInitiativeChanges;
+using koidice::applyInitiativeDelta;
+using koidice::isInitiativeLoaded;
+using koidice::setInitiativeTableLimits;
+using koidice::setInitiativeEvictionHandler;
+using koidice::setInitiativeLoadHandler;
+using koidice::getInitiativeTableStats;
 using koidice::drawFromDeck;
 using koidice::listDecks;
 using koidice::getDeckSize;
 using koidice::deckExists;
 using koidice::shuffleDeck;
+using koidice::drawFromDeckWithReplacement;
+using koidice::setDeckTemplateLimits;
+using koidice::suggestDecks;
+using koidice::listDecksByPrefix;
+using koidice::loadDeckPack;
+using koidice::unloadDeckPack;
+using koidice::getDeckPackStats;
+using koidice::getDeckMemoryStats;
+using koidice::createChannelDeck;
+using koidice::drawChannelDeck;
+using koidice::peekChannelDeck;
+using koidice::returnChannelDeckCard;
+using koidice::resetChannelDeck;
+using koidice::removeChannelDeck;
+using koidice::clearChannelDecks;
+using koidice::serializeChannelDeck;
+using koidice::deserializeChannelDeck;
+using koidice::loadCard;
+using koidice::unloadCard;
+using koidice::isCardLoaded;
+using koidice::getCardAttributes;
+using koidice::setCardAttributes;
+using koidice::applyStToCard;
+using koidice::processCheckWithCard;
+using koidice::importSheetToCard;
+using koidice::exportDirtyCards;
+using koidice::ackDirtyCards;
+using koidice::setCardStoreLimits;
+using koidice::getCardStoreStats;
 using koidice::queryRule;
 using koidice::queryRuleBySystem;
 using koidice::listRuleKeys;
@@ -64,6 +120,7 @@ EMSCRIPTEN_BINDINGS(dice_module) {
     // === 核心命令处理 ===
     function("processRoll", &CommandProcessor::processRoll);
     function("processCheck", &CommandProcessor::processCheck);
+    function("processCheckWithAttributes", &CommandProcessor::processCheckWithAttributes);
     function("processCOCCheck", &CommandProcessor::processCOCCheck);
 
     // === 基础掷骰 ===
@@ -82,9 +139,13 @@ EMSCRIPTEN_BINDINGS(dice_module) {
     function("generateCOC7Multiple", &generateCOC7Multiple);
     function("generateCOC6Multiple", &generateCOC6Multiple);
     function("generateDNDCharacter", &generateDNDCharacter);
+    function("generateCharacters", &generateCharacters);
+    function("generateCharactersWithConstraints", &generateCharactersWithConstraints);
 
     // === 理智检定 ===
     function("sanityCheck", &sanityCheck);
+    function("sanityCheckWithInsanity", &sanityCheckWithInsanity);
+    function("sanityCheckBatch", &sanityCheckBatch);
     function("getTempInsanity", &getTempInsanity);
     function("getLongInsanity", &getLongInsanity);
     function("getPhobia", &getPhobia);
@@ -93,20 +154,57 @@ EMSCRIPTEN_BINDINGS(dice_module) {
     // === 先攻系统 ===
     function("addInitiative", &addInitiative);
     function("rollInitiative", &rollInitiative);
+    function("rollInitiativeBatch", &rollInitiativeBatch);
     function("removeInitiative", &removeInitiative);
     function("clearInitiative", &clearInitiative);
     function("nextInitiativeTurn", &nextInitiativeTurn);
     function("getInitiativeList", &getInitiativeList);
     function("getInitiativeCount", &getInitiativeCount);
+    function("updateInitiative", &updateInitiative);
+    function("delayInitiative", &delayInitiative);
+    function("readyInitiative", &readyInitiative);
+    function("addInitiativeCondition", &addInitiativeCondition);
+    function("removeInitiativeCondition", &removeInitiativeCondition);
+    function("getInitiativeConditions", &getInitiativeConditions);
     function("serializeInitiative", &serializeInitiative);
     function("deserializeInitiative", &deserializeInitiative);
+    function("serializeInitiativeBinary", &serializeInitiativeBinary);
+    function("flushInitiativeChanges", &flushInitiativeChanges);
+    function("applyInitiativeDelta", &applyInitiativeDelta);
+    function("isInitiativeLoaded", &isInitiativeLoaded);
+    function("setInitiativeTableLimits", &setInitiativeTableLimits);
+    function("setInitiativeEvictionHandler", &setInitiativeEvictionHandler);
+    function("setInitiativeLoadHandler", &setInitiativeLoadHandler);
+    function("getInitiativeTableStats", &getInitiativeTableStats);
 
     // === 牌堆系统 ===
     function("drawFromDeck", &drawFromDeck);
     function("shuffleDeck", &shuffleDeck);
+    function("drawFromDeckWithReplacement", &drawFromDeckWithReplacement);
     function("listDecks", &listDecks);
     function("getDeckSize", &getDeckSize);
+    function("invalidateDeckCache", &koidice::invalidateDeckCache);
     function("deckExists", &deckExists);
+    function("setDeckTemplateLimits", &setDeckTemplateLimits);
+    function("suggestDecks", &suggestDecks);
+    function("listDecksByPrefix", &listDecksByPrefix);
+
+    // 牌堆包（JSON / YAML 牌堆文件）
+    function("loadDeckPack", &loadDeckPack);
+    function("unloadDeckPack", &unloadDeckPack);
+    function("getDeckPackStats", &getDeckPackStats);
+    function("getDeckMemoryStats", &getDeckMemoryStats);
+
+    // 频道牌堆（跨指令无放回发牌）
+    function("createChannelDeck", &createChannelDeck);
+    function("drawChannelDeck", &drawChannelDeck);
+    function("peekChannelDeck", &peekChannelDeck);
+    function("returnChannelDeckCard", &returnChannelDeckCard);
+    function("resetChannelDeck", &resetChannelDeck);
+    function("removeChannelDeck", &removeChannelDeck);
+    function("clearChannelDecks", &clearChannelDecks);
+    function("serializeChannelDeck", &serializeChannelDeck);
+    function("deserializeChannelDeck", &deserializeChannelDeck);
 
     // === 规则查询 ===
     function("queryRule", &queryRule);
@@ -116,10 +214,28 @@ EMSCRIPTEN_BINDINGS(dice_module) {
 
     // === 人物卡解析 ===
     function("parseCOCAttributes", &parseCOCAttributes);
+    function("parseCOCCharacters", &parseCOCCharacters);
     function("normalizeAttributeName", &koidice::normalizeAttributeName);
     function("parseStCommand", &koidice::parseStCommand);
+    function("applyStCommand", &koidice::applyStCommand);
+    function("updateDerivedAttributes", &koidice::updateDerivedAttributes);
+    function("importCharacterSheet", &koidice::importCharacterSheet);
     function("parseAttributeList", &koidice::parseAttributeList);
 
+    // === 常驻人物卡 ===
+    function("loadCard", &loadCard);
+    function("unloadCard", &unloadCard);
+    function("isCardLoaded", &isCardLoaded);
+    function("getCardAttributes", &getCardAttributes);
+    function("setCardAttributes", &setCardAttributes);
+    function("applyStToCard", &applyStToCard);
+    function("processCheckWithCard", &processCheckWithCard);
+    function("importSheetToCard", &importSheetToCard);
+    function("exportDirtyCards", &exportDirtyCards);
+    function("ackDirtyCards", &ackDirtyCards);
+    function("setCardStoreLimits", &setCardStoreLimits);
+    function("getCardStoreStats", &getCardStoreStats);
+
     // === 工具函数 ===
     function("initialize", &initialize);
 
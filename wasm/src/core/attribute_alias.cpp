@@ -0,0 +1,341 @@
+#include "attribute_alias.h"
+#include "attribute_names.h"
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+
+namespace koidice {
+
+namespace {
+
+struct AliasEntry {
+    std::string_view alias;      // 已规范化：无空白、ASCII 小写、全角已转半角
+    std::string_view canonical;  // 规范属性名
+};
+
+// 属性同义词表（规范属性名本身也必须列出）
+constexpr AliasEntry ALIAS_ENTRIES[] = {
+    // COC 基础属性
+    {"力量", "力量"}, {"str", "力量"}, {"strength", "力量"},
+    {"体质", "体质"}, {"con", "体质"}, {"constitution", "体质"},
+    {"体型", "体型"}, {"siz", "体型"}, {"size", "体型"}, {"体形", "体型"},
+    {"敏捷", "敏捷"}, {"dex", "敏捷"}, {"dexterity", "敏捷"},
+    {"外貌", "外貌"}, {"app", "外貌"}, {"appearance", "外貌"},
+    {"智力", "智力"}, {"int", "智力"}, {"intelligence", "智力"},
+    {"意志", "意志"}, {"pow", "意志"}, {"power", "意志"},
+    {"教育", "教育"}, {"edu", "教育"}, {"education", "教育"},
+    {"幸运", "幸运"}, {"luck", "幸运"}, {"luk", "幸运"}, {"运气", "幸运"},
+
+    // 派生属性
+    {"理智", "理智"}, {"san", "理智"}, {"sanity", "理智"}, {"理智值", "理智"}, {"san值", "理智"},
+    {"生命", "生命"}, {"hp", "生命"}, {"生命值", "生命"}, {"体力", "生命"},
+    {"魔法", "魔法"}, {"mp", "魔法"}, {"魔法值", "魔法"},
+    {"伤害加值", "伤害加值"}, {"db", "伤害加值"}, {"伤害奖励", "伤害加值"},
+    {"移动力", "移动力"}, {"mov", "移动力"}, {"move", "移动力"},
+    {"体格", "体格"}, {"build", "体格"},
+    {"灵感", "灵感"}, {"idea", "灵感"},
+    {"知识", "知识"}, {"know", "知识"},
+
+    // DND 属性
+    {"感知", "感知"}, {"wis", "感知"}, {"wisdom", "感知"},
+    {"魅力", "魅力"}, {"cha", "魅力"}, {"charisma", "魅力"},
+
+    // COC7 技能
+    {"会计", "会计"}, {"accounting", "会计"},
+    {"人类学", "人类学"}, {"anthropology", "人类学"},
+    {"估价", "估价"}, {"appraise", "估价"},
+    {"考古学", "考古学"}, {"archaeology", "考古学"},
+    {"魅惑", "魅惑"}, {"取悦", "魅惑"}, {"charm", "魅惑"},
+    {"攀爬", "攀爬"}, {"climb", "攀爬"},
+    {"计算机使用", "计算机使用"}, {"计算机", "计算机使用"}, {"电脑", "计算机使用"},
+    {"电脑使用", "计算机使用"}, {"computeruse", "计算机使用"},
+    {"信用评级", "信用评级"}, {"信用", "信用评级"}, {"信誉", "信用评级"},
+    {"信用度", "信用评级"}, {"cr", "信用评级"}, {"creditrating", "信用评级"},
+    {"克苏鲁神话", "克苏鲁神话"}, {"克苏鲁", "克苏鲁神话"}, {"cm", "克苏鲁神话"},
+    {"cthulhumythos", "克苏鲁神话"},
+    {"乔装", "乔装"}, {"伪装", "乔装"}, {"disguise", "乔装"},
+    {"闪避", "闪避"}, {"dodge", "闪避"},
+    {"汽车驾驶", "汽车驾驶"}, {"汽车", "汽车驾驶"}, {"驾驶汽车", "汽车驾驶"},
+    {"开车", "汽车驾驶"}, {"driveauto", "汽车驾驶"},
+    {"电气维修", "电气维修"}, {"电器维修", "电气维修"}, {"electricalrepair", "电气维修"},
+    {"电子学", "电子学"}, {"electronics", "电子学"},
+    {"话术", "话术"}, {"快速交谈", "话术"}, {"fasttalk", "话术"},
+    {"斗殴", "斗殴"}, {"格斗:斗殴", "斗殴"}, {"格斗(斗殴)", "斗殴"}, {"brawl", "斗殴"},
+    {"手枪", "手枪"}, {"射击:手枪", "手枪"}, {"射击(手枪)", "手枪"}, {"handgun", "手枪"},
+    {"急救", "急救"}, {"firstaid", "急救"},
+    {"历史", "历史"}, {"history", "历史"},
+    {"恐吓", "恐吓"}, {"威吓", "恐吓"}, {"intimidate", "恐吓"},
+    {"跳跃", "跳跃"}, {"jump", "跳跃"},
+    {"母语", "母语"}, {"languageown", "母语"},
+    {"法律", "法律"}, {"law", "法律"},
+    {"图书馆使用", "图书馆使用"}, {"图书馆", "图书馆使用"}, {"图书馆利用", "图书馆使用"},
+    {"libraryuse", "图书馆使用"},
+    {"聆听", "聆听"}, {"listen", "聆听"},
+    {"锁匠", "锁匠"}, {"开锁", "锁匠"}, {"locksmith", "锁匠"},
+    {"机械维修", "机械维修"}, {"机械", "机械维修"}, {"mechanicalrepair", "机械维修"},
+    {"医学", "医学"}, {"medicine", "医学"},
+    {"博物学", "博物学"}, {"自然学", "博物学"}, {"自然史", "博物学"}, {"naturalworld", "博物学"},
+    {"领航", "领航"}, {"导航", "领航"}, {"navigate", "领航"},
+    {"神秘学", "神秘学"}, {"occult", "神秘学"},
+    {"操作重型机械", "操作重型机械"}, {"重型机械", "操作重型机械"}, {"重型操作", "操作重型机械"},
+    {"重机械操作", "操作重型机械"}, {"operateheavymachinery", "操作重型机械"},
+    {"说服", "说服"}, {"persuade", "说服"},
+    {"精神分析", "精神分析"}, {"psychoanalysis", "精神分析"},
+    {"心理学", "心理学"}, {"psychology", "心理学"},
+    {"骑术", "骑术"}, {"骑乘", "骑术"}, {"ride", "骑术"},
+    {"妙手", "妙手"}, {"sleightofhand", "妙手"},
+    {"侦查", "侦查"}, {"侦察", "侦查"}, {"spothidden", "侦查"},
+    {"潜行", "潜行"}, {"隐匿", "潜行"}, {"躲藏", "潜行"}, {"stealth", "潜行"},
+    {"生存", "生存"}, {"survival", "生存"},
+    {"游泳", "游泳"}, {"swim", "游泳"},
+    {"投掷", "投掷"}, {"throw", "投掷"},
+    {"追踪", "追踪"}, {"track", "追踪"},
+    {"驯兽", "驯兽"}, {"动物驯养", "驯兽"}, {"animalhandling", "驯兽"},
+    {"潜水", "潜水"}, {"diving", "潜水"},
+    {"爆破", "爆破"}, {"demolitions", "爆破"},
+    {"读唇", "读唇"}, {"唇语", "读唇"}, {"readlips", "读唇"},
+    {"催眠", "催眠"}, {"hypnosis", "催眠"},
+    {"炮术", "炮术"}, {"artillery", "炮术"},
+    {"步霰", "步霰"}, {"步枪", "步霰"}, {"霰弹枪", "步霰"}, {"步枪/霰弹枪", "步霰"},
+    {"射击:步霰", "步霰"}, {"射击:步枪/霰弹枪", "步霰"}, {"rifle/shotgun", "步霰"},
+    {"冲锋枪", "冲锋枪"}, {"射击:冲锋枪", "冲锋枪"}, {"smg", "冲锋枪"},
+    {"弓", "弓"}, {"弓术", "弓"}, {"射击:弓", "弓"}, {"bow", "弓"},
+    {"剑", "剑"}, {"格斗:剑", "剑"}, {"sword", "剑"},
+    {"斧", "斧"}, {"格斗:斧", "斧"}, {"axe", "斧"},
+    {"鞭", "鞭"}, {"鞭子", "鞭"}, {"格斗:鞭", "鞭"}, {"whip", "鞭"},
+    {"链锯", "链锯"}, {"电锯", "链锯"}, {"格斗:链锯", "链锯"}, {"chainsaw", "链锯"},
+    {"连枷", "连枷"}, {"格斗:连枷", "连枷"}, {"flail", "连枷"},
+    {"绞索", "绞索"}, {"格斗:绞索", "绞索"}, {"garrote", "绞索"},
+    {"矛", "矛"}, {"格斗:矛", "矛"}, {"spear", "矛"},
+    {"火焰喷射器", "火焰喷射器"}, {"射击:火焰喷射器", "火焰喷射器"}, {"flamethrower", "火焰喷射器"},
+    {"重武器", "重武器"}, {"射击:重武器", "重武器"}, {"heavyweapons", "重武器"},
+    {"机枪", "机枪"}, {"射击:机枪", "机枪"}, {"machinegun", "机枪"},
+    {"外语", "外语"}, {"languageother", "外语"},
+    {"艺术", "艺术"}, {"艺术与手艺", "艺术"}, {"艺术和手艺", "艺术"}, {"手艺", "艺术"},
+    {"artcraft", "艺术"}, {"art/craft", "艺术"},
+    {"科学", "科学"}, {"science", "科学"},
+    {"驾驶", "驾驶"}, {"pilot", "驾驶"},
+};
+
+constexpr size_t ALIAS_COUNT = sizeof(ALIAS_ENTRIES) / sizeof(ALIAS_ENTRIES[0]);
+
+// 完美哈希参数：一级桶选择位移种子，二级槽位无冲突
+constexpr size_t BUCKET_COUNT = 256;
+constexpr size_t SLOT_COUNT = 1024;
+constexpr size_t MAX_ALIAS_BYTES = 64;
+
+static_assert((SLOT_COUNT & (SLOT_COUNT - 1)) == 0, "SLOT_COUNT 必须为 2 的幂");
+static_assert(ALIAS_COUNT < SLOT_COUNT, "同义词数量超过槽位数");
+
+constexpr uint32_t aliasHash(std::string_view key, uint32_t seed) {
+    uint32_t h = 2166136261u ^ (seed * 0x9E3779B9u);
+    for (char ch : key) {
+        h ^= static_cast<uint8_t>(ch);
+        h *= 16777619u;
+    }
+    h ^= h >> 15;
+    h *= 0x2C1B3C6Du;
+    h ^= h >> 12;
+    return h;
+}
+
+constexpr bool viewEquals(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i] != b[i]) return false;
+    }
+    return true;
+}
+
+constexpr AttributeId canonicalIdOf(std::string_view name) {
+    for (size_t i = 0; i < CANONICAL_ATTRIBUTE_COUNT; i++) {
+        if (viewEquals(CANONICAL_ATTRIBUTE_NAMES[i], name)) {
+            return static_cast<AttributeId>(i);
+        }
+    }
+    throw std::logic_error("同义词指向未知的规范属性");
+}
+
+struct PerfectHashTable {
+    std::array<uint16_t, BUCKET_COUNT> seeds{};
+    std::array<uint16_t, SLOT_COUNT> slots{};        // 同义词下标 + 1，0 表示空槽
+    std::array<AttributeId, ALIAS_COUNT> ids{};
+};
+
+constexpr PerfectHashTable buildPerfectHashTable() {
+    PerfectHashTable table;
+
+    for (size_t i = 0; i < ALIAS_COUNT; i++) {
+        table.ids[i] = canonicalIdOf(ALIAS_ENTRIES[i].canonical);
+        for (size_t j = 0; j < i; j++) {
+            if (viewEquals(ALIAS_ENTRIES[i].alias, ALIAS_ENTRIES[j].alias)) {
+                throw std::logic_error("同义词重复");
+            }
+        }
+    }
+
+    // 规范属性名本身必须可查
+    for (size_t c = 0; c < CANONICAL_ATTRIBUTE_COUNT; c++) {
+        bool found = false;
+        for (size_t i = 0; i < ALIAS_COUNT && !found; i++) {
+            found = viewEquals(ALIAS_ENTRIES[i].alias, CANONICAL_ATTRIBUTE_NAMES[c]);
+        }
+        if (!found) {
+            throw std::logic_error("规范属性名缺少同义词条目");
+        }
+    }
+
+    // 按桶分组（计数排序）
+    std::array<uint16_t, BUCKET_COUNT + 1> bucketStart{};
+    std::array<uint16_t, ALIAS_COUNT> bucketOf{};
+    for (size_t i = 0; i < ALIAS_COUNT; i++) {
+        bucketOf[i] = static_cast<uint16_t>(aliasHash(ALIAS_ENTRIES[i].alias, 0) % BUCKET_COUNT);
+        bucketStart[bucketOf[i] + 1]++;
+    }
+    for (size_t b = 0; b < BUCKET_COUNT; b++) {
+        bucketStart[b + 1] += bucketStart[b];
+    }
+
+    std::array<uint16_t, ALIAS_COUNT> members{};
+    std::array<uint16_t, BUCKET_COUNT> fill{};
+    for (size_t i = 0; i < ALIAS_COUNT; i++) {
+        uint16_t b = bucketOf[i];
+        members[bucketStart[b] + fill[b]++] = static_cast<uint16_t>(i);
+    }
+
+    // 大桶优先放置
+    std::array<uint16_t, BUCKET_COUNT> order{};
+    for (size_t b = 0; b < BUCKET_COUNT; b++) {
+        order[b] = static_cast<uint16_t>(b);
+    }
+    for (size_t i = 1; i < BUCKET_COUNT; i++) {
+        uint16_t b = order[i];
+        size_t size = bucketStart[b + 1] - bucketStart[b];
+        size_t j = i;
+        while (j > 0 && static_cast<size_t>(bucketStart[order[j - 1] + 1] - bucketStart[order[j - 1]]) < size) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = b;
+    }
+
+    for (size_t o = 0; o < BUCKET_COUNT; o++) {
+        uint16_t b = order[o];
+        size_t begin = bucketStart[b];
+        size_t end = bucketStart[b + 1];
+        if (begin == end) break;
+
+        for (uint32_t seed = 1;; seed++) {
+            if (seed > 0xFFFF) {
+                throw std::logic_error("无法构造完美哈希");
+            }
+
+            std::array<uint16_t, 16> placed{};
+            size_t placedCount = 0;
+            bool ok = end - begin <= placed.size();
+
+            for (size_t m = begin; ok && m < end; m++) {
+                uint16_t slot = static_cast<uint16_t>(aliasHash(ALIAS_ENTRIES[members[m]].alias, seed) & (SLOT_COUNT - 1));
+                ok = table.slots[slot] == 0;
+                for (size_t p = 0; ok && p < placedCount; p++) {
+                    ok = placed[p] != slot;
+                }
+                placed[placedCount++] = slot;
+            }
+
+            if (ok) {
+                for (size_t m = begin; m < end; m++) {
+                    table.slots[placed[m - begin]] = static_cast<uint16_t>(members[m] + 1);
+                }
+                table.seeds[b] = static_cast<uint16_t>(seed);
+                break;
+            }
+        }
+    }
+
+    return table;
+}
+
+constexpr PerfectHashTable ALIAS_TABLE = buildPerfectHashTable();
+
+/**
+ * 规范化属性名到 out：去除空白（含全角空格）、ASCII 转小写、全角 ASCII 转半角
+ * @return 规范化后的长度；超过缓冲区时返回 SIZE_MAX
+ */
+size_t foldAttributeName(std::string_view name, char* out, size_t capacity) {
+    size_t len = 0;
+    size_t i = 0;
+
+    while (i < name.size()) {
+        unsigned char c = static_cast<unsigned char>(name[i]);
+        char ascii = 0;
+        size_t consumed = 1;
+
+        if (c < 0x80) {
+            ascii = static_cast<char>(c);
+        } else if (c == 0xEF && i + 2 < name.size()) {
+            // U+FF01-FF5E 全角 ASCII：EF BC 81-BF / EF BD 80-9E
+            unsigned char c1 = static_cast<unsigned char>(name[i + 1]);
+            unsigned char c2 = static_cast<unsigned char>(name[i + 2]);
+            if (c1 == 0xBC && c2 >= 0x81 && c2 <= 0xBF) {
+                ascii = static_cast<char>(c2 - 0x60);
+                consumed = 3;
+            } else if (c1 == 0xBD && c2 >= 0x80 && c2 <= 0x9E) {
+                ascii = static_cast<char>(c2 - 0x20);
+                consumed = 3;
+            }
+        } else if (c == 0xE3 && i + 2 < name.size() &&
+                   static_cast<unsigned char>(name[i + 1]) == 0x80 &&
+                   static_cast<unsigned char>(name[i + 2]) == 0x80) {
+            // U+3000 全角空格
+            i += 3;
+            continue;
+        }
+
+        if (ascii != 0 || c < 0x80) {
+            i += consumed;
+            if (ascii == ' ' || ascii == '\t' || ascii == '\n' || ascii == '\r' || ascii == '\f' || ascii == '\v') {
+                continue;
+            }
+            if (ascii >= 'A' && ascii <= 'Z') {
+                ascii = static_cast<char>(ascii - 'A' + 'a');
+            }
+            if (len >= capacity) return SIZE_MAX;
+            out[len++] = ascii;
+            continue;
+        }
+
+        // 其他多字节字符原样复制
+        if (len >= capacity) return SIZE_MAX;
+        out[len++] = name[i++];
+    }
+
+    return len;
+}
+
+} // namespace
+
+AttributeId lookupAttributeAlias(std::string_view name) {
+    char buffer[MAX_ALIAS_BYTES];
+    size_t len = foldAttributeName(name, buffer, sizeof(buffer));
+    if (len == SIZE_MAX || len == 0) {
+        return INVALID_ATTRIBUTE;
+    }
+
+    std::string_view key(buffer, len);
+    uint32_t bucket = aliasHash(key, 0) % BUCKET_COUNT;
+    uint32_t slot = aliasHash(key, ALIAS_TABLE.seeds[bucket]) & (SLOT_COUNT - 1);
+    uint16_t entry = ALIAS_TABLE.slots[slot];
+
+    if (entry == 0 || ALIAS_ENTRIES[entry - 1].alias != key) {
+        return INVALID_ATTRIBUTE;
+    }
+    return ALIAS_TABLE.ids[entry - 1];
+}
+
+AttributeId findResolvedAttributeId(const std::string& name) {
+    AttributeId id = lookupAttributeAlias(name);
+    return id != INVALID_ATTRIBUTE ? id : findAttributeId(name);
+}
+
+} // namespace koidice
@@ -0,0 +1,24 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include "attribute_registry.h"
+
+namespace koidice {
+
+/**
+ * 查找属性同义词
+ * 在栈上完成规范化（去除空白、ASCII 小写、全角字符转半角），
+ * 再通过编译期生成的完美哈希表查找，不产生堆分配
+ *
+ * @param name 原始属性名（UTF-8）
+ * @return 规范属性ID；不是已知同义词时返回 INVALID_ATTRIBUTE
+ */
+AttributeId lookupAttributeAlias(std::string_view name);
+
+/**
+ * 查找属性名对应的属性ID，不登记新名称
+ * @return 未知名称返回 INVALID_ATTRIBUTE
+ */
+AttributeId findResolvedAttributeId(const std::string& name);
+
+} // namespace koidice
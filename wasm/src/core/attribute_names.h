@@ -0,0 +1,29 @@
+#pragma once
+#include <string_view>
+#include <cstddef>
+
+namespace koidice {
+
+// 规范属性名（顺序即属性ID，只可在末尾追加）
+inline constexpr std::string_view CANONICAL_ATTRIBUTE_NAMES[] = {
+    // COC 基础属性
+    "力量", "体质", "体型", "敏捷", "外貌", "智力", "意志", "教育", "幸运",
+    // 派生属性
+    "理智", "生命", "魔法", "伤害加值", "移动力", "体格", "灵感", "知识",
+    // DND 属性
+    "感知", "魅力",
+    // COC7 技能
+    "会计", "人类学", "估价", "考古学", "魅惑", "攀爬", "计算机使用", "信用评级",
+    "克苏鲁神话", "乔装", "闪避", "汽车驾驶", "电气维修", "电子学", "话术", "斗殴",
+    "手枪", "急救", "历史", "恐吓", "跳跃", "母语", "法律", "图书馆使用", "聆听",
+    "锁匠", "机械维修", "医学", "博物学", "领航", "神秘学", "操作重型机械", "说服",
+    "精神分析", "心理学", "骑术", "妙手", "侦查", "潜行", "生存", "游泳", "投掷",
+    "追踪", "驯兽", "潜水", "爆破", "读唇", "催眠", "炮术", "步霰", "冲锋枪", "弓",
+    "剑", "斧", "鞭", "链锯", "连枷", "绞索", "矛", "火焰喷射器", "重武器", "机枪",
+    "外语", "艺术", "科学", "驾驶",
+};
+
+inline constexpr size_t CANONICAL_ATTRIBUTE_COUNT =
+    sizeof(CANONICAL_ATTRIBUTE_NAMES) / sizeof(CANONICAL_ATTRIBUTE_NAMES[0]);
+
+} // namespace koidice
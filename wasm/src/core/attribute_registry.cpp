@@ -0,0 +1,60 @@
+#include "attribute_registry.h"
+#include "attribute_names.h"
+#include <unordered_map>
+#include <vector>
+
+namespace koidice {
+
+struct AttributeTable {
+    std::vector<std::string> names;
+    std::unordered_map<std::string, AttributeId> ids;
+
+    AttributeTable() {
+        names.reserve(CANONICAL_ATTRIBUTE_COUNT * 2);
+        for (std::string_view name : CANONICAL_ATTRIBUTE_NAMES) {
+            ids.emplace(std::string(name), static_cast<AttributeId>(names.size()));
+            names.emplace_back(name);
+        }
+    }
+};
+
+static AttributeTable& getAttributeTable() {
+    static AttributeTable table;
+    return table;
+}
+
+size_t canonicalAttributeCount() {
+    return CANONICAL_ATTRIBUTE_COUNT;
+}
+
+AttributeId internAttribute(const std::string& name) {
+    AttributeTable& table = getAttributeTable();
+
+    auto it = table.ids.find(name);
+    if (it != table.ids.end()) {
+        return it->second;
+    }
+
+    AttributeId id = static_cast<AttributeId>(table.names.size());
+    table.ids.emplace(name, id);
+    table.names.push_back(name);
+    return id;
+}
+
+AttributeId findAttributeId(const std::string& name) {
+    AttributeTable& table = getAttributeTable();
+    auto it = table.ids.find(name);
+    return it != table.ids.end() ? it->second : INVALID_ATTRIBUTE;
+}
+
+const std::string& getAttributeName(AttributeId id) {
+    static const std::string empty;
+    AttributeTable& table = getAttributeTable();
+    return id < table.names.size() ? table.names[id] : empty;
+}
+
+size_t internedAttributeCount() {
+    return getAttributeTable().names.size();
+}
+
+} // namespace koidice
@@ -0,0 +1,43 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace koidice {
+
+/**
+ * 属性ID
+ * 规范属性（COC/DND 基础属性、派生属性与 COC7 技能）占用 [0, canonicalAttributeCount()) 的连续编号，
+ * 可直接作为稠密数组下标；其余属性名在首次出现时分配更大的编号
+ */
+using AttributeId = uint32_t;
+
+constexpr AttributeId INVALID_ATTRIBUTE = UINT32_MAX;
+
+// 规范属性数量
+size_t canonicalAttributeCount();
+
+// 是否为规范属性
+inline bool isCanonicalAttribute(AttributeId id) {
+    return id < canonicalAttributeCount();
+}
+
+/**
+ * 获取属性ID，未登记的名称会被登记
+ * @param name 已规范化的属性名
+ */
+AttributeId internAttribute(const std::string& name);
+
+/**
+ * 查找属性ID，不登记新名称
+ * @return 未登记时返回 INVALID_ATTRIBUTE
+ */
+AttributeId findAttributeId(const std::string& name);
+
+// 属性ID对应的名称（无效ID返回空字符串）
+const std::string& getAttributeName(AttributeId id);
+
+// 已登记的属性总数
+size_t internedAttributeCount();
+
+} // namespace koidice
@@ -0,0 +1,213 @@
+#include "binary_codec.h"
+#include <array>
+#include <cstring>
+
+namespace koidice {
+
+// ============ ByteWriter ============
+
+void ByteWriter::u16(uint16_t value) {
+    bytes.push_back(static_cast<uint8_t>(value));
+    bytes.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+void ByteWriter::u32(uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        bytes.push_back(static_cast<uint8_t>(value >> (i * 8)));
+    }
+}
+
+void ByteWriter::u64(uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+        bytes.push_back(static_cast<uint8_t>(value >> (i * 8)));
+    }
+}
+
+void ByteWriter::varint(uint64_t value) {
+    while (value >= 0x80) {
+        bytes.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back(static_cast<uint8_t>(value));
+}
+
+void ByteWriter::svarint(int64_t value) {
+    varint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+void ByteWriter::str(std::string_view value) {
+    varint(value.size());
+    raw(value.data(), value.size());
+}
+
+void ByteWriter::raw(const void* data, size_t size) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    bytes.insert(bytes.end(), p, p + size);
+}
+
+// ============ ByteReader ============
+
+bool ByteReader::u8(uint8_t& value) {
+    if (!good || cur == end) {
+        return fail();
+    }
+    value = *cur++;
+    return true;
+}
+
+bool ByteReader::u16(uint16_t& value) {
+    if (!good || left() < 2) {
+        return fail();
+    }
+    value = static_cast<uint16_t>(cur[0] | (cur[1] << 8));
+    cur += 2;
+    return true;
+}
+
+bool ByteReader::u32(uint32_t& value) {
+    if (!good || left() < 4) {
+        return fail();
+    }
+    value = 0;
+    for (int i = 0; i < 4; i++) {
+        value |= static_cast<uint32_t>(cur[i]) << (i * 8);
+    }
+    cur += 4;
+    return true;
+}
+
+bool ByteReader::u64(uint64_t& value) {
+    if (!good || left() < 8) {
+        return fail();
+    }
+    value = 0;
+    for (int i = 0; i < 8; i++) {
+        value |= static_cast<uint64_t>(cur[i]) << (i * 8);
+    }
+    cur += 8;
+    return true;
+}
+
+bool ByteReader::varint(uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        uint8_t byte;
+        if (!u8(byte)) {
+            return false;
+        }
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return fail();
+}
+
+bool ByteReader::svarint(int64_t& value) {
+    uint64_t raw;
+    if (!varint(raw)) {
+        return false;
+    }
+    value = static_cast<int64_t>(raw >> 1) ^ -static_cast<int64_t>(raw & 1);
+    return true;
+}
+
+bool ByteReader::str(std::string& value, size_t maxSize) {
+    uint64_t size;
+    if (!varint(size) || size > maxSize || size > left()) {
+        return fail();
+    }
+    value.assign(reinterpret_cast<const char*>(cur), static_cast<size_t>(size));
+    cur += size;
+    return true;
+}
+
+bool ByteReader::expect(const void* data, size_t size) {
+    if (!good || left() < size || std::memcmp(cur, data, size) != 0) {
+        return fail();
+    }
+    cur += size;
+    return true;
+}
+
+// ============ Base64 ============
+
+static constexpr char BASE64_CHARS[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static constexpr std::array<int8_t, 256> makeBase64Table() {
+    std::array<int8_t, 256> table{};
+    for (auto& v : table) {
+        v = -1;
+    }
+    for (int i = 0; i < 64; i++) {
+        table[static_cast<uint8_t>(BASE64_CHARS[i])] = static_cast<int8_t>(i);
+    }
+    return table;
+}
+
+static constexpr std::array<int8_t, 256> BASE64_TABLE = makeBase64Table();
+
+std::string base64Encode(const std::vector<uint8_t>& bytes) {
+    std::string out;
+    out.reserve((bytes.size() + 2) / 3 * 4);
+
+    size_t i = 0;
+    for (; i + 3 <= bytes.size(); i += 3) {
+        uint32_t n = (bytes[i] << 16) | (bytes[i + 1] << 8) | bytes[i + 2];
+        out.push_back(BASE64_CHARS[(n >> 18) & 63]);
+        out.push_back(BASE64_CHARS[(n >> 12) & 63]);
+        out.push_back(BASE64_CHARS[(n >> 6) & 63]);
+        out.push_back(BASE64_CHARS[n & 63]);
+    }
+
+    size_t rest = bytes.size() - i;
+    if (rest > 0) {
+        uint32_t n = bytes[i] << 16;
+        if (rest == 2) {
+            n |= bytes[i + 1] << 8;
+        }
+        out.push_back(BASE64_CHARS[(n >> 18) & 63]);
+        out.push_back(BASE64_CHARS[(n >> 12) & 63]);
+        out.push_back(rest == 2 ? BASE64_CHARS[(n >> 6) & 63] : '=');
+        out.push_back('=');
+    }
+    return out;
+}
+
+bool base64Decode(std::string_view text, std::vector<uint8_t>& out) {
+    out.clear();
+    if (text.size() % 4 != 0) {
+        return false;
+    }
+    out.reserve(text.size() / 4 * 3);
+
+    for (size_t i = 0; i < text.size(); i += 4) {
+        bool last = i + 4 == text.size();
+        int padding = 0;
+        uint32_t n = 0;
+        for (size_t k = 0; k < 4; k++) {
+            char c = text[i + k];
+            if (c == '=' && last && k >= 2) {
+                padding++;
+                n <<= 6;
+                continue;
+            }
+            int8_t v = BASE64_TABLE[static_cast<uint8_t>(c)];
+            if (v < 0 || padding > 0) {
+                return false;
+            }
+            n = (n << 6) | static_cast<uint32_t>(v);
+        }
+        out.push_back(static_cast<uint8_t>(n >> 16));
+        if (padding < 2) {
+            out.push_back(static_cast<uint8_t>(n >> 8));
+        }
+        if (padding < 1) {
+            out.push_back(static_cast<uint8_t>(n));
+        }
+    }
+    return true;
+}
+
+} // namespace koidice
@@ -0,0 +1,64 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace koidice {
+
+/**
+ * 紧凑二进制快照的写入器
+ * 定长整数一律小端序；变长整数为 LEB128，适合大多很小的下标与计数
+ */
+class ByteWriter {
+public:
+    void u8(uint8_t value) { bytes.push_back(value); }
+    void u16(uint16_t value);
+    void u32(uint32_t value);
+    void u64(uint64_t value);
+    void varint(uint64_t value);
+    void svarint(int64_t value);             // zigzag 编码的有符号变长整数
+    void str(std::string_view value);        // 变长长度 + 原始字节
+    void raw(const void* data, size_t size);
+
+    const std::vector<uint8_t>& data() const { return bytes; }
+
+private:
+    std::vector<uint8_t> bytes;
+};
+
+/**
+ * 快照读取器
+ * 所有读取都做边界检查，越界或编码非法时返回 false 并保持失败状态
+ */
+class ByteReader {
+public:
+    ByteReader(const uint8_t* data, size_t size) : cur(data), end(data + size) {}
+
+    bool u8(uint8_t& value);
+    bool u16(uint16_t& value);
+    bool u32(uint32_t& value);
+    bool u64(uint64_t& value);
+    bool varint(uint64_t& value);
+    bool svarint(int64_t& value);
+    bool str(std::string& value, size_t maxSize);
+    bool expect(const void* data, size_t size);  // 比较并跳过固定字节（如魔数）
+
+    bool ok() const { return good; }
+    bool atEnd() const { return good && cur == end; }
+    size_t left() const { return static_cast<size_t>(end - cur); }
+
+private:
+    bool fail() { good = false; return false; }
+
+    const uint8_t* cur;
+    const uint8_t* end;
+    bool good = true;
+};
+
+// Base64 编解码（标准字母表，带填充），用于通过字符串接口传递二进制快照
+std::string base64Encode(const std::vector<uint8_t>& bytes);
+bool base64Decode(std::string_view text, std::vector<uint8_t>& out);
+
+} // namespace koidice
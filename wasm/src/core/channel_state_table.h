@@ -0,0 +1,192 @@
+#pragma once
+#include <string>
+#include <list>
+#include <unordered_map>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+
+namespace koidice {
+
+// 频道状态被逐出的原因
+enum class EvictReason {
+    Capacity,   // 超出容量，逐出最久未访问的频道
+    Expired     // 超过空闲时限
+};
+
+/**
+ * 按频道ID索引的状态表
+ * 哈希表查找，双向链表维护访问顺序：访问时移到表头，容量满时从表尾逐出（LRU），
+ * 空闲超时的频道在每次访问时从表尾顺带清理，代价只与过期数量有关。
+ * 逐出时调用 onEvict 交出状态（用于落盘），未命中时调用 onLoad 尝试重新载入。
+ * find/obtain 可能逐出其他频道，之前取得的指针只在下一次 find/obtain/assign 前有效
+ */
+template <typename T>
+class ChannelStateTable {
+public:
+    using Clock = std::chrono::steady_clock;
+    using EvictHandler = std::function<void(const std::string& key, T& state, EvictReason reason)>;
+    using LoadHandler = std::function<bool(const std::string& key, T& state)>;
+
+    struct Limits {
+        size_t maxEntries = 1024;
+        uint32_t ttlSeconds = 0;   // 0 表示不按空闲时间逐出
+    };
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t reloads = 0;
+        uint64_t evictedCapacity = 0;
+        uint64_t evictedExpired = 0;
+    };
+
+    void setLimits(const Limits& value) {
+        limits = value;
+        if (limits.maxEntries == 0) {
+            limits.maxEntries = 1;
+        }
+        sweep();
+        while (map.size() > limits.maxEntries) {
+            evictOldest(EvictReason::Capacity);
+        }
+    }
+    const Limits& getLimits() const { return limits; }
+
+    void setEvictHandler(EvictHandler handler) { onEvict = std::move(handler); }
+    void setLoadHandler(LoadHandler handler) { onLoad = std::move(handler); }
+
+    size_t size() const { return map.size(); }
+    const Stats& stats() const { return counters; }
+
+    // 查找并刷新访问时间；不在表中时尝试 onLoad 载入，仍没有则返回 nullptr
+    T* find(const std::string& key) {
+        sweep();
+        auto it = map.find(key);
+        if (it != map.end()) {
+            counters.hits++;
+            touch(*it);
+            return &it->second.state;
+        }
+        counters.misses++;
+
+        if (onLoad) {
+            T state;
+            if (onLoad(key, state)) {
+                counters.reloads++;
+                return &insert(key, std::move(state));
+            }
+        }
+        return nullptr;
+    }
+
+    // 查找或创建；created 非空时写入是否新建了空状态（未命中且未能载入）
+    T& obtain(const std::string& key, bool* created = nullptr) {
+        T* state = find(key);
+        if (created) {
+            *created = !state;
+        }
+        return state ? *state : insert(key, T());
+    }
+
+    // 放入（覆盖已有状态）
+    T& assign(const std::string& key, T&& state) {
+        auto it = map.find(key);
+        if (it != map.end()) {
+            it->second.state = std::move(state);
+            touch(*it);
+            return it->second.state;
+        }
+        return insert(key, std::move(state));
+    }
+
+    // 只读查看，不刷新访问时间也不触发载入
+    T* peek(const std::string& key) {
+        auto it = map.find(key);
+        return it == map.end() ? nullptr : &it->second.state;
+    }
+
+    // 直接移除（不调用 onEvict）
+    bool erase(const std::string& key) {
+        auto it = map.find(key);
+        if (it == map.end()) {
+            return false;
+        }
+        lru.erase(it->second.position);
+        map.erase(it);
+        return true;
+    }
+
+    // 逐出所有空闲超时的频道
+    void sweep() {
+        if (limits.ttlSeconds == 0) {
+            return;
+        }
+        auto deadline = Clock::now() - std::chrono::seconds(limits.ttlSeconds);
+        while (!lru.empty() && lru.back()->second.lastAccess < deadline) {
+            evictOldest(EvictReason::Expired);
+        }
+    }
+
+    template <typename F>
+    void forEach(F&& fn) const {
+        for (const auto& [key, node] : map) {
+            fn(key, node.state);
+        }
+    }
+
+private:
+    struct Node;
+    using Map = std::unordered_map<std::string, Node>;
+    using Entry = typename Map::value_type;
+
+    struct Node {
+        T state;
+        Clock::time_point lastAccess;
+        typename std::list<Entry*>::iterator position;
+    };
+
+    void touch(Entry& entry) {
+        entry.second.lastAccess = Clock::now();
+        lru.splice(lru.begin(), lru, entry.second.position);
+    }
+
+    T& insert(const std::string& key, T&& state) {
+        while (map.size() >= limits.maxEntries) {
+            evictOldest(EvictReason::Capacity);
+        }
+        auto [it, inserted] = map.emplace(key, Node{std::move(state), Clock::now(), {}});
+        lru.push_front(&*it);
+        it->second.position = lru.begin();
+        return it->second.state;
+    }
+
+    // 先从表中摘下再回调，回调里再访问本表也不会看到半删除的状态
+    void evictOldest(EvictReason reason) {
+        auto it = map.find(lru.back()->first);
+        std::string key = it->first;
+        T state = std::move(it->second.state);
+        lru.pop_back();
+        map.erase(it);
+
+        if (reason == EvictReason::Capacity) {
+            counters.evictedCapacity++;
+        } else {
+            counters.evictedExpired++;
+        }
+        if (onEvict) {
+            onEvict(key, state, reason);
+        }
+    }
+
+    Map map;
+    std::list<Entry*> lru;   // 表头为最近访问
+    Limits limits;
+    Stats counters;
+    EvictHandler onEvict;
+    LoadHandler onLoad;
+};
+
+} // namespace koidice
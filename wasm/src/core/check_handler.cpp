@@ -1,10 +1,115 @@
 #include "check_handler.h"
 #include "utils.h"
+#include "success_table.h"
 #include "../../../Dice/Dice/RD.h"
 #include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <vector>
 
 namespace koidice {
 
+namespace {
+
+// 单轮允许的最大奖惩骰数量
+constexpr int MAX_BONUS_DICE = 10;
+
+/**
+ * 批量投掷 D100
+ * BonusSign: 0=普通, 1=奖励骰, -1=惩罚骰
+ * 所有随机数一次取出，避免每颗骰子一次 JS 调用
+ */
+template <int BonusSign>
+void rollD100Batch(int bonusCount, int rounds, int* out) {
+    if constexpr (BonusSign == 0) {
+        getSecureRandomInts(1, 100, out, rounds);
+    } else {
+        // 每轮：1个个位骰 + (1 + bonusCount)个十位骰
+        const int stride = bonusCount + 2;
+        std::vector<int> digits(static_cast<size_t>(stride) * rounds);
+        getSecureRandomInts(0, 9, digits.data(), digits.size());
+
+        for (int i = 0; i < rounds; i++) {
+            const int* d = digits.data() + static_cast<size_t>(i) * stride;
+            const int units = d[0];
+            int best = BonusSign > 0 ? 100 : 1;
+            for (int k = 1; k < stride; k++) {
+                int value = d[k] * 10 + units;
+                value += (value == 0) * 100;  // 00 + 0 视为 100
+                best = BonusSign > 0 ? std::min(best, value) : std::max(best, value);
+            }
+            out[i] = best;
+        }
+    }
+}
+
+using CheckEvaluator = void (*)(int skillValue, int rounds, int bonusCount, int rule,
+                                CheckRoundResult* out);
+
+/**
+ * 按 (难度, 奖惩骰方向, 自动成功) 特化的检定求值器
+ * 难度除数为编译期常量，成功等级阈值预先展开成查找表，
+ * 多轮循环内只剩查表
+ */
+template <Difficulty D, int BonusSign, bool AutoSuccess>
+void evaluateCheck(int skillValue, int rounds, int bonusCount, int rule, CheckRoundResult* out) {
+    constexpr int divisor = static_cast<int>(D);
+    const int finalSkillValue = skillValue / divisor;
+
+    const SuccessTable* table = &getSuccessTable(rule, finalSkillValue);
+    SuccessTable autoTable;
+    if constexpr (AutoSuccess) {
+        autoTable = *table;
+        const int limit = std::min(finalSkillValue, 100);
+        for (int roll = 1; roll <= limit; roll++) {
+            autoTable[roll] = static_cast<int8_t>(SuccessLevel::RegularSuccess);
+        }
+        table = &autoTable;
+    }
+
+    std::vector<int> rolls(rounds);
+    rollD100Batch<BonusSign>(bonusCount, rounds, rolls.data());
+
+    for (int i = 0; i < rounds; i++) {
+        out[i].rollValue = rolls[i];
+        out[i].skillValue = finalSkillValue;
+        out[i].successLevel = static_cast<SuccessLevel>((*table)[rolls[i]]);
+    }
+}
+
+// 调度表：下标 = 难度序号 * 6 + (奖惩方向 + 1) * 2 + 自动成功
+constexpr std::array<CheckEvaluator, 18> CHECK_EVALUATORS = {
+    &evaluateCheck<Difficulty::Normal, -1, false>,
+    &evaluateCheck<Difficulty::Normal, -1, true>,
+    &evaluateCheck<Difficulty::Normal, 0, false>,
+    &evaluateCheck<Difficulty::Normal, 0, true>,
+    &evaluateCheck<Difficulty::Normal, 1, false>,
+    &evaluateCheck<Difficulty::Normal, 1, true>,
+    &evaluateCheck<Difficulty::Hard, -1, false>,
+    &evaluateCheck<Difficulty::Hard, -1, true>,
+    &evaluateCheck<Difficulty::Hard, 0, false>,
+    &evaluateCheck<Difficulty::Hard, 0, true>,
+    &evaluateCheck<Difficulty::Hard, 1, false>,
+    &evaluateCheck<Difficulty::Hard, 1, true>,
+    &evaluateCheck<Difficulty::Extreme, -1, false>,
+    &evaluateCheck<Difficulty::Extreme, -1, true>,
+    &evaluateCheck<Difficulty::Extreme, 0, false>,
+    &evaluateCheck<Difficulty::Extreme, 0, true>,
+    &evaluateCheck<Difficulty::Extreme, 1, false>,
+    &evaluateCheck<Difficulty::Extreme, 1, true>,
+};
+
+int difficultyIndex(Difficulty difficulty) {
+    switch (difficulty) {
+        case Difficulty::Normal: return 0;
+        case Difficulty::Hard: return 1;
+        case Difficulty::Extreme: return 2;
+        default: return -1;
+    }
+}
+
+} // namespace
+
 emscripten::val CheckHandler::check(
     const std::string& skillName,
     int skillValue,
@@ -24,20 +129,42 @@ emscripten::val CheckHandler::check(
             return result;
         }
 
+        int diffIndex = difficultyIndex(difficulty);
+        if (diffIndex < 0) {
+            result.set("success", false);
+            result.set("errorMsg", "难度等级无效");
+            return result;
+        }
+
+        int bonusCount = std::abs(bonusDice);
+        if (bonusCount > MAX_BONUS_DICE) {
+            result.set("success", false);
+            result.set("errorMsg", "奖惩骰数量过多");
+            return result;
+        }
+
+        if (rounds < 1) {
+            rounds = 1;
+        }
+
         // 应用难度修正
         int finalSkillValue = skillValue / static_cast<int>(difficulty);
 
-        // 执行多轮检定
-        emscripten::val results = emscripten::val::array();
+        // 选择特化求值器并执行多轮检定
+        int bonusSign = (bonusDice > 0) - (bonusDice < 0);
+        CheckEvaluator evaluator = CHECK_EVALUATORS[diffIndex * 6 + (bonusSign + 1) * 2 + (autoSuccess ? 1 : 0)];
 
-        for (int i = 0; i < rounds; i++) {
-            CheckRoundResult roundResult = checkOnce(finalSkillValue, bonusDice, autoSuccess, rule);
+        std::vector<CheckRoundResult> roundResults(rounds);
+        evaluator(skillValue, rounds, bonusCount, rule, roundResults.data());
+
+        emscripten::val results = emscripten::val::array();
 
+        for (const CheckRoundResult& roundResult : roundResults) {
             emscripten::val jsRound = emscripten::val::object();
             jsRound.set("rollValue", roundResult.rollValue);
             jsRound.set("skillValue", roundResult.skillValue);
             jsRound.set("successLevel", static_cast<int>(roundResult.successLevel));
-            jsRound.set("description", roundResult.description);
+            jsRound.set("description", getSuccessLevelDesc(static_cast<int>(roundResult.successLevel), autoSuccess));
 
             results.call<void>("push", jsRound);
         }
@@ -144,46 +271,4 @@ emscripten::val CheckHandler::cocCheck(int skillValue, int bonusDice) {
     return result;
 }
 
-CheckRoundResult CheckHandler::checkOnce(
-    int skillValue,
-    int bonusDice,
-    bool autoSuccess,
-    int rule
-) {
-    CheckRoundResult result;
-    result.skillValue = skillValue;
-
-    // 使用RD类的B/P骰子功能
-    std::string expression;
-    if (bonusDice > 0) {
-        expression = std::to_string(bonusDice) + "B";
-    } else if (bonusDice < 0) {
-        expression = std::to_string(-bonusDice) + "P";
-    } else {
-        expression = "1D100";
-    }
-
-    RD rd(expression, 100);
-    int_errno err = rd.Roll();
-
-    if (err != 0) {
-        result.rollValue = 0;
-        result.successLevel = SuccessLevel::Failure;
-        result.description = "掷骰失败: " + getErrorMessage(err);
-        return result;
-    }
-
-    result.rollValue = rd.intTotal;
-
-    // 使用Dice的RollSuccessLevel函数判定
-    SuccessLevel level = autoSuccess && result.rollValue <= skillValue
-        ? SuccessLevel::RegularSuccess
-        : static_cast<SuccessLevel>(RollSuccessLevel(result.rollValue, skillValue, rule));
-
-    result.successLevel = level;
-    result.description = getSuccessLevelDesc(static_cast<int>(level), autoSuccess);
-
-    return result;
-}
-
 } // namespace koidice
@@ -39,17 +39,6 @@ public:
      * @return JS对象，包含检定结果
      */
     static emscripten::val cocCheck(int skillValue, int bonusDice);
-
-private:
-    /**
-     * 单次检定
-     */
-    static CheckRoundResult checkOnce(
-        int skillValue,
-        int bonusDice,
-        bool autoSuccess,
-        int rule
-    );
 };
 
 } // namespace koidice
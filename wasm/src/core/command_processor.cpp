@@ -3,6 +3,9 @@
 #include "check_handler.h"
 #include "utils.h"
 #include "utf8_utils.h"
+#include "attribute_alias.h"
+#include <algorithm>
+#include <cctype>
 #include <regex>
 #include <sstream>
 
@@ -50,6 +53,114 @@ emscripten::val CommandProcessor::processCheck(
     return CheckHandler::check(skillName, skillValue, rounds, bonusDice, difficulty, autoSuccess, rule);
 }
 
+emscripten::val CommandProcessor::processCheckWithAttributes(
+    const std::string& rawCommand,
+    int rule,
+    const emscripten::val& attributes
+) {
+    bool hasTable = !attributes.isUndefined() && !attributes.isNull();
+
+    auto getByName = [&](const std::string& name, int& value) {
+        if (!hasTable) return false;
+        emscripten::val stored = attributes[name];
+        if (!stored.isNumber()) return false;
+        value = stored.as<int>();
+        return true;
+    };
+
+    return processCheckResolved(rawCommand, rule, [&](AttributeId id, int& value) {
+        return getByName(getAttributeName(id), value);
+    }, getByName);
+}
+
+emscripten::val CommandProcessor::processCheckResolved(
+    const std::string& rawCommand,
+    int rule,
+    const AttributeGetter& get,
+    const NamedAttributeGetter& getByName
+) {
+    ensureRandomInit();
+
+    std::string skillName;
+    int skillValue = 0;
+    int rounds = 1;
+    int bonusDice = 0;
+    Difficulty difficulty = Difficulty::Normal;
+    bool autoSuccess = false;
+
+    parseCheckExpression(normalizeCheckCommand(rawCommand), skillName, skillValue, rounds, bonusDice,
+                         difficulty, autoSuccess);
+
+    std::string skillSource = "input";
+    int modifier = 0;
+
+    if (skillValue < 0) {
+        modifier = splitSkillModifier(skillName);
+
+        if (skillName.empty()) {
+            emscripten::val result = emscripten::val::object();
+            result.set("success", false);
+            result.set("errorMsg", "请指定技能名或成功率");
+            return result;
+        }
+
+        AttributeId id = findResolvedAttributeId(skillName);
+        int baseValue = 0;
+        if (id != INVALID_ATTRIBUTE ? get(id, baseValue) : getByName(skillName, baseValue)) {
+            skillSource = "card";
+        } else if (id != INVALID_ATTRIBUTE && getCOC7SkillDefault(id, get, baseValue)) {
+            skillSource = "default";
+        } else {
+            emscripten::val result = emscripten::val::object();
+            result.set("success", false);
+            result.set("skillName", skillName);
+            result.set("errorMsg", "未找到技能 " + skillName);
+            return result;
+        }
+
+        skillValue = std::max(0, baseValue + modifier);
+    }
+
+    emscripten::val result = CheckHandler::check(skillName, skillValue, rounds, bonusDice, difficulty, autoSuccess, rule);
+    result.set("skillSource", skillSource);
+    result.set("modifier", modifier);
+    return result;
+}
+
+std::string CommandProcessor::normalizeCheckCommand(const std::string& rawCommand) {
+    // 带符号的末项是修正值而非成功率
+    std::string command = trim(rawCommand);
+    size_t spacePos = command.find_last_of(' ');
+    if (spacePos != std::string::npos && spacePos + 1 < command.size() &&
+        (command[spacePos + 1] == '+' || command[spacePos + 1] == '-')) {
+        command = trim(command.substr(0, spacePos)) + command.substr(spacePos + 1);
+    }
+    return command;
+}
+
+int CommandProcessor::splitSkillModifier(std::string& skillName) {
+    int modifier = 0;
+
+    // 可连续出现多个修正值（如 "侦查+20-10"），从末尾依次剥离
+    while (!skillName.empty()) {
+        size_t end = skillName.size();
+        size_t digits = end;
+        while (digits > 0 && std::isdigit(static_cast<unsigned char>(skillName[digits - 1]))) {
+            digits--;
+        }
+        if (digits == end || digits == 0 || end - digits > 4) break;
+
+        char sign = skillName[digits - 1];
+        if (sign != '+' && sign != '-') break;
+
+        int value = std::stoi(skillName.substr(digits));
+        modifier += sign == '-' ? -value : value;
+        skillName = trim(skillName.substr(0, digits - 1));
+    }
+
+    return modifier;
+}
+
 emscripten::val CommandProcessor::processCOCCheck(int skillValue, int bonusDice) {
     ensureRandomInit();
     return CheckHandler::cocCheck(skillValue, bonusDice);
@@ -165,6 +276,19 @@ void CommandProcessor::parseCheckExpression(
         skillName = expr;
         skillValue = -1; // 标记需要从人物卡获取
     }
+
+    // 技能名与成功率之间可以不加空格（如 "侦查60"）；前面是 +/- 时是修正值，留给调用方处理
+    if (skillValue < 0) {
+        size_t digits = skillName.size();
+        while (digits > 0 && std::isdigit(static_cast<unsigned char>(skillName[digits - 1]))) {
+            digits--;
+        }
+        if (digits > 0 && digits < skillName.size() && skillName.size() - digits <= 4 &&
+            skillName[digits - 1] != '+' && skillName[digits - 1] != '-') {
+            skillValue = std::stoi(skillName.substr(digits));
+            skillName = trim(skillName.substr(0, digits));
+        }
+    }
 }
 
 } // namespace koidice
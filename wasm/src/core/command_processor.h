@@ -2,6 +2,7 @@
 #include <string>
 #include <emscripten/val.h>
 #include "../types/common_types.h"
+#include "skill_defaults.h"
 
 namespace koidice {
 
@@ -57,6 +58,32 @@ public:
         int rule = 0
     );
 
+    /**
+     * 处理技能检定命令，未给出成功率时从属性快照中取值
+     * 技能名支持同义词与修正值（如 .rc 侦查+10、.rc 困难聆听 -20），
+     * 人物卡上没有的技能使用 COC7 基础值（如 闪避 = 敏捷/2、母语 = 教育）
+     *
+     * @param attributes JS对象 { 属性名: 数值 }，人物卡属性
+     * @return 与 processCheck 相同，另含 { skillSource: "input" | "card" | "default", modifier }
+     */
+    static emscripten::val processCheckWithAttributes(
+        const std::string& rawCommand,
+        int rule,
+        const emscripten::val& attributes
+    );
+
+    /**
+     * 处理技能检定命令（C++ 接口），通过回调读取属性
+     * @param get 读取人物卡属性，不存在时返回 false
+     * @param getByName 按原名读取不是已知属性名的技能
+     */
+    static emscripten::val processCheckResolved(
+        const std::string& rawCommand,
+        int rule,
+        const AttributeGetter& get,
+        const NamedAttributeGetter& getByName
+    );
+
     /**
      * 处理COC检定命令（简化版）
      * 格式：.coc 技能值 [奖惩骰数量]
@@ -80,6 +107,12 @@ private:
         int defaultDice
     );
 
+    // 从技能名末尾分离修正值（如 "侦查+10" -> "侦查", +10）
+    static int splitSkillModifier(std::string& skillName);
+
+    // 将 "侦查 +10" 中带符号的末项与技能名合并
+    static std::string normalizeCheckCommand(const std::string& rawCommand);
+
     // 解析检定表达式
     static void parseCheckExpression(
         const std::string& input,
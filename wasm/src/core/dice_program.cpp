@@ -0,0 +1,181 @@
+#include "dice_program.h"
+#include "../../../Dice/Dice/RD.h"
+#include <cctype>
+
+namespace koidice {
+
+// 超出该范围的表达式交给 RD 处理（包括报错）
+static constexpr int MAX_PROGRAM_DICE = 100;
+static constexpr int MAX_PROGRAM_SIDES = 1000;
+static constexpr int MAX_PROGRAM_CONSTANT = 100000;
+
+// 读取一段十进制数字，失败或超出上限时返回 -1
+static int readNumber(const std::string& str, size_t& pos, int limit) {
+    size_t start = pos;
+    long long value = 0;
+    while (pos < str.size() && std::isdigit(static_cast<unsigned char>(str[pos]))) {
+        value = value * 10 + (str[pos] - '0');
+        if (value > limit) {
+            return -1;
+        }
+        pos++;
+    }
+    return pos == start ? -1 : static_cast<int>(value);
+}
+
+DiceProgram DiceProgram::compile(const std::string& expression, int defaultDice) {
+    DiceProgram program;
+    program.expression = expression;
+    program.defaultDice = defaultDice;
+
+    std::string text;
+    for (char ch : expression) {
+        if (!std::isspace(static_cast<unsigned char>(ch))) {
+            text.push_back(ch);
+        }
+    }
+
+    if (text.empty()) {
+        return program;
+    }
+
+    size_t pos = 0;
+    bool first = true;
+    while (pos < text.size()) {
+        Term term{1, 0, 0};
+
+        if (text[pos] == '+' || text[pos] == '-') {
+            term.sign = text[pos] == '-' ? -1 : 1;
+            pos++;
+        } else if (!first) {
+            return program;
+        }
+        first = false;
+
+        // NdM / dM / Nd / 常数
+        int number = -1;
+        if (pos < text.size() && std::isdigit(static_cast<unsigned char>(text[pos]))) {
+            number = readNumber(text, pos, MAX_PROGRAM_CONSTANT);
+            if (number < 0) {
+                return program;
+            }
+        }
+
+        if (pos < text.size() && (text[pos] == 'd' || text[pos] == 'D')) {
+            pos++;
+            term.count = number < 0 ? 1 : number;
+            term.sides = defaultDice;
+            if (pos < text.size() && std::isdigit(static_cast<unsigned char>(text[pos]))) {
+                term.sides = readNumber(text, pos, MAX_PROGRAM_SIDES);
+            }
+            if (term.count <= 0 || term.count > MAX_PROGRAM_DICE ||
+                term.sides <= 0 || term.sides > MAX_PROGRAM_SIDES) {
+                return program;
+            }
+            program.totalDice += term.count;
+        } else if (number >= 0) {
+            term.count = number;
+        } else {
+            return program;
+        }
+
+        program.terms.push_back(term);
+    }
+
+    if (program.totalDice > MAX_PROGRAM_DICE) {
+        program.totalDice = 0;
+        program.terms.clear();
+        return program;
+    }
+
+    // 生成规范化写法（与 Dice 一致使用大写 D）
+    for (size_t i = 0; i < program.terms.size(); i++) {
+        const Term& term = program.terms[i];
+        if (term.sign < 0) {
+            program.canonical += '-';
+        } else if (i > 0) {
+            program.canonical += '+';
+        }
+        program.canonical += std::to_string(term.count);
+        if (term.sides > 0) {
+            program.canonical += 'D' + std::to_string(term.sides);
+        }
+    }
+
+    program.compiled = true;
+    return program;
+}
+
+int_errno DiceProgram::roll(SecureRandomBuffer& rng, int& total, std::string& detail) const {
+    if (!compiled) {
+        RD rd(expression, defaultDice);
+        int_errno err = rd.Roll();
+        if (err != 0) {
+            total = 0;
+            detail.clear();
+            return err;
+        }
+        total = rd.intTotal;
+        detail = rd.FormShortString();
+        return 0;
+    }
+
+    rng.reserve(totalDice);
+
+    std::string parts;
+    int valueCount = 0;
+    total = 0;
+
+    for (size_t i = 0; i < terms.size(); i++) {
+        const Term& term = terms[i];
+        int n = term.sides > 0 ? term.count : 1;
+        for (int k = 0; k < n; k++) {
+            int value = term.sides > 0 ? rng.next(1, term.sides) : term.count;
+            total += term.sign * value;
+
+            if (term.sign < 0) {
+                parts += '-';
+            } else if (valueCount > 0) {
+                parts += '+';
+            }
+            parts += std::to_string(value);
+            valueCount++;
+        }
+    }
+
+    detail = canonical + "=";
+    if (valueCount > 1) {
+        detail += parts + "=";
+    }
+    detail += std::to_string(total);
+    return 0;
+}
+
+int DiceProgram::max() const {
+    if (!compiled) {
+        return getMaxValue(expression, defaultDice);
+    }
+
+    int value = 0;
+    for (const Term& term : terms) {
+        // 常数项上下限相同；骰子项最小为每颗 1 点
+        int high = term.sides > 0 ? term.count * term.sides : term.count;
+        value += term.sign > 0 ? high : -term.count;
+    }
+    return value;
+}
+
+int DiceProgram::min() const {
+    if (!compiled) {
+        return getMinValue(expression, defaultDice);
+    }
+
+    int value = 0;
+    for (const Term& term : terms) {
+        int high = term.sides > 0 ? term.count * term.sides : term.count;
+        value += term.sign > 0 ? term.count : -high;
+    }
+    return value;
+}
+
+} // namespace koidice
@@ -0,0 +1,60 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "utils.h"
+
+namespace koidice {
+
+/**
+ * 预编译的简单掷骰表达式
+ * 支持由 +/- 连接的 NdM 与常数项（如 "1d6"、"1d4+1"、"2d10-1"），
+ * 即理智损失等场景的常见写法；其他表达式回退到 Dice 的 RD 计算
+ */
+class DiceProgram {
+public:
+    DiceProgram() = default;
+
+    /**
+     * 编译表达式
+     * @param expression 掷骰表达式
+     * @param defaultDice 省略面数时的默认面数
+     */
+    static DiceProgram compile(const std::string& expression, int defaultDice = 100);
+
+    // 是否已编译为内部形式（否则每次求值都回退到 RD）
+    bool isCompiled() const { return compiled; }
+
+    // 表达式中骰子的总数（用于预取随机数）
+    int diceCount() const { return totalDice; }
+
+    const std::string& source() const { return expression; }
+
+    /**
+     * 掷骰
+     * @param rng 随机数缓冲区
+     * @param total 输出：结果
+     * @param detail 输出：过程（如 "1D4+1=3+1=4"）
+     * @return 错误码（0 表示成功）
+     */
+    int_errno roll(SecureRandomBuffer& rng, int& total, std::string& detail) const;
+
+    // 最大值 / 最小值（失败时返回 -1）
+    int max() const;
+    int min() const;
+
+private:
+    struct Term {
+        int sign;   // +1 / -1
+        int count;  // 骰子数量；常数项时为常数值
+        int sides;  // 骰子面数；0 表示常数项
+    };
+
+    std::string expression;
+    std::string canonical;
+    std::vector<Term> terms;
+    int defaultDice = 100;
+    int totalDice = 0;
+    bool compiled = false;
+};
+
+} // namespace koidice
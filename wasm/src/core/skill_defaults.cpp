@@ -0,0 +1,92 @@
+#include "skill_defaults.h"
+#include "attribute_names.h"
+#include <array>
+#include <stdexcept>
+
+namespace koidice {
+
+namespace {
+
+struct SkillDefault {
+    std::string_view skill;
+    int base;                 // 固定基础值
+    std::string_view source;  // 非空时基础值 = 属性值 / divisor
+    int divisor;
+};
+
+// COC7 规则书技能表
+constexpr SkillDefault COC7_SKILL_DEFAULTS[] = {
+    {"会计", 5, "", 1}, {"人类学", 1, "", 1}, {"估价", 5, "", 1}, {"考古学", 1, "", 1},
+    {"魅惑", 15, "", 1}, {"攀爬", 20, "", 1}, {"计算机使用", 5, "", 1}, {"信用评级", 0, "", 1},
+    {"克苏鲁神话", 0, "", 1}, {"乔装", 5, "", 1}, {"闪避", 0, "敏捷", 2}, {"汽车驾驶", 20, "", 1},
+    {"电气维修", 10, "", 1}, {"电子学", 1, "", 1}, {"话术", 5, "", 1}, {"斗殴", 25, "", 1},
+    {"手枪", 20, "", 1}, {"急救", 30, "", 1}, {"历史", 5, "", 1}, {"恐吓", 15, "", 1},
+    {"跳跃", 20, "", 1}, {"母语", 0, "教育", 1}, {"法律", 5, "", 1}, {"图书馆使用", 20, "", 1},
+    {"聆听", 20, "", 1}, {"锁匠", 1, "", 1}, {"机械维修", 10, "", 1}, {"医学", 1, "", 1},
+    {"博物学", 10, "", 1}, {"领航", 10, "", 1}, {"神秘学", 5, "", 1}, {"操作重型机械", 1, "", 1},
+    {"说服", 10, "", 1}, {"精神分析", 1, "", 1}, {"心理学", 10, "", 1}, {"骑术", 5, "", 1},
+    {"妙手", 10, "", 1}, {"侦查", 25, "", 1}, {"潜行", 20, "", 1}, {"生存", 10, "", 1},
+    {"游泳", 20, "", 1}, {"投掷", 20, "", 1}, {"追踪", 10, "", 1}, {"驯兽", 5, "", 1},
+    {"潜水", 1, "", 1}, {"爆破", 1, "", 1}, {"读唇", 1, "", 1}, {"催眠", 1, "", 1},
+    {"炮术", 1, "", 1}, {"步霰", 25, "", 1}, {"冲锋枪", 15, "", 1}, {"弓", 15, "", 1},
+    {"剑", 20, "", 1}, {"斧", 15, "", 1}, {"鞭", 5, "", 1}, {"链锯", 10, "", 1},
+    {"连枷", 10, "", 1}, {"绞索", 15, "", 1}, {"矛", 20, "", 1}, {"火焰喷射器", 10, "", 1},
+    {"重武器", 10, "", 1}, {"机枪", 10, "", 1}, {"外语", 1, "", 1}, {"艺术", 5, "", 1},
+    {"科学", 1, "", 1}, {"驾驶", 1, "", 1},
+    // 灵感 / 知识检定
+    {"灵感", 0, "智力", 1}, {"知识", 0, "教育", 1},
+};
+
+constexpr AttributeId canonicalId(std::string_view name) {
+    for (size_t i = 0; i < CANONICAL_ATTRIBUTE_COUNT; i++) {
+        if (CANONICAL_ATTRIBUTE_NAMES[i] == name) {
+            return static_cast<AttributeId>(i);
+        }
+    }
+    throw std::logic_error("技能基础值指向未知的规范属性");
+}
+
+struct DefaultEntry {
+    bool present = false;
+    int base = 0;
+    AttributeId source = INVALID_ATTRIBUTE;
+    int divisor = 1;
+};
+
+// 以规范属性ID为下标的基础值表
+constexpr std::array<DefaultEntry, CANONICAL_ATTRIBUTE_COUNT> buildDefaultTable() {
+    std::array<DefaultEntry, CANONICAL_ATTRIBUTE_COUNT> table{};
+    for (const SkillDefault& skill : COC7_SKILL_DEFAULTS) {
+        DefaultEntry& entry = table[canonicalId(skill.skill)];
+        entry.present = true;
+        entry.base = skill.base;
+        entry.source = skill.source.empty() ? INVALID_ATTRIBUTE : canonicalId(skill.source);
+        entry.divisor = skill.divisor;
+    }
+    return table;
+}
+
+constexpr std::array<DefaultEntry, CANONICAL_ATTRIBUTE_COUNT> DEFAULT_TABLE = buildDefaultTable();
+
+} // namespace
+
+bool getCOC7SkillDefault(AttributeId id, const AttributeGetter& get, int& value) {
+    if (!isCanonicalAttribute(id) || !DEFAULT_TABLE[id].present) {
+        return false;
+    }
+
+    const DefaultEntry& entry = DEFAULT_TABLE[id];
+    if (entry.source == INVALID_ATTRIBUTE) {
+        value = entry.base;
+        return true;
+    }
+
+    int source = 0;
+    if (!get(entry.source, source)) {
+        return false;
+    }
+    value = source / entry.divisor;
+    return true;
+}
+
+} // namespace koidice
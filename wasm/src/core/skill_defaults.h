@@ -0,0 +1,24 @@
+#pragma once
+#include <functional>
+#include "attribute_registry.h"
+
+namespace koidice {
+
+// 属性读取回调：属性存在时写入 value 并返回 true
+using AttributeGetter = std::function<bool(AttributeId, int&)>;
+
+// 按名称读取未登记属性（人物卡上的自定义技能等）的回调
+using NamedAttributeGetter = std::function<bool(const std::string&, int&)>;
+
+/**
+ * COC7 技能基础值
+ * 固定基础值直接返回（如 侦查 25），依赖属性的按属性计算（如 闪避 = 敏捷/2、母语 = 教育）
+ *
+ * @param id 技能的属性ID
+ * @param get 读取人物卡属性
+ * @param value 输出：基础值
+ * @return 没有基础值或依赖的属性缺失时返回 false
+ */
+bool getCOC7SkillDefault(AttributeId id, const AttributeGetter& get, int& value);
+
+} // namespace koidice
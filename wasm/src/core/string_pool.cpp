@@ -0,0 +1,184 @@
+#include "string_pool.h"
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <cstring>
+
+namespace koidice {
+
+// 块大小；超过四分之一块的文本单独成块
+static constexpr size_t POOL_BLOCK_SIZE = 64 * 1024;
+
+struct PoolSlot {
+    std::string_view text;
+    uint32_t refs = 0;
+    uint32_t block = 0;
+    uint32_t generation = 0;
+};
+
+struct PoolBlock {
+    std::unique_ptr<char[]> data;
+    size_t size = 0;
+    size_t used = 0;
+    uint32_t live = 0;   // 块内存活的字符串数
+};
+
+struct StringPool {
+    std::vector<PoolSlot> slots;
+    std::vector<PooledStringId> freeSlots;
+    std::unordered_map<std::string_view, PooledStringId> index;
+    std::vector<PoolBlock> blocks;
+    std::vector<uint32_t> freeBlocks;
+    uint32_t current = UINT32_MAX;   // 正在填充的块
+    StringPoolStats stats;
+};
+
+static StringPool& getPool() {
+    static StringPool pool;
+    return pool;
+}
+
+static uint32_t newBlock(StringPool& pool, size_t size) {
+    uint32_t id;
+    if (!pool.freeBlocks.empty()) {
+        id = pool.freeBlocks.back();
+        pool.freeBlocks.pop_back();
+    } else {
+        id = static_cast<uint32_t>(pool.blocks.size());
+        pool.blocks.emplace_back();
+    }
+    PoolBlock& block = pool.blocks[id];
+    block.data = std::make_unique<char[]>(size);
+    block.size = size;
+    block.used = 0;
+    block.live = 0;
+    pool.stats.blockBytes += size;
+    pool.stats.blocks++;
+    return id;
+}
+
+// 复制文本到竞技场，返回所在块
+static uint32_t storeText(StringPool& pool, std::string_view text, const char*& stored) {
+    uint32_t id;
+    if (text.size() > POOL_BLOCK_SIZE / 4) {
+        id = newBlock(pool, text.size());
+    } else {
+        if (pool.current == UINT32_MAX ||
+            pool.blocks[pool.current].size - pool.blocks[pool.current].used < text.size()) {
+            pool.current = newBlock(pool, POOL_BLOCK_SIZE);
+        }
+        id = pool.current;
+    }
+
+    PoolBlock& block = pool.blocks[id];
+    char* dest = block.data.get() + block.used;
+    std::memcpy(dest, text.data(), text.size());
+    block.used += text.size();
+    block.live++;
+    stored = dest;
+    return id;
+}
+
+static void releaseBlockString(StringPool& pool, uint32_t id) {
+    PoolBlock& block = pool.blocks[id];
+    if (--block.live > 0) {
+        return;
+    }
+    if (id == pool.current) {
+        block.used = 0;   // 当前块清空后原地复用
+        return;
+    }
+    pool.stats.blockBytes -= block.size;
+    pool.stats.blocks--;
+    pool.stats.reclaimedBlocks++;
+    block.data.reset();
+    block.size = 0;
+    block.used = 0;
+    pool.freeBlocks.push_back(id);
+}
+
+PooledStringId acquireString(std::string_view text) {
+    StringPool& pool = getPool();
+    pool.stats.references++;
+    pool.stats.referencedBytes += text.size();
+
+    auto it = pool.index.find(text);
+    if (it != pool.index.end()) {
+        pool.slots[it->second].refs++;
+        return it->second;
+    }
+
+    PooledStringId id;
+    if (!pool.freeSlots.empty()) {
+        id = pool.freeSlots.back();
+        pool.freeSlots.pop_back();
+    } else {
+        id = static_cast<PooledStringId>(pool.slots.size());
+        pool.slots.emplace_back();
+    }
+
+    PoolSlot& slot = pool.slots[id];
+    const char* stored = nullptr;
+    if (!text.empty()) {
+        slot.block = storeText(pool, text, stored);
+    } else {
+        slot.block = UINT32_MAX;
+    }
+    slot.text = std::string_view(stored, text.size());
+    slot.refs = 1;
+
+    pool.index.emplace(slot.text, id);
+    pool.stats.strings++;
+    pool.stats.storedBytes += text.size();
+    return id;
+}
+
+void retainString(PooledStringId id) {
+    StringPool& pool = getPool();
+    if (id >= pool.slots.size() || pool.slots[id].refs == 0) {
+        return;
+    }
+    pool.slots[id].refs++;
+    pool.stats.references++;
+    pool.stats.referencedBytes += pool.slots[id].text.size();
+}
+
+void releaseString(PooledStringId id) {
+    StringPool& pool = getPool();
+    if (id >= pool.slots.size() || pool.slots[id].refs == 0) {
+        return;
+    }
+
+    PoolSlot& slot = pool.slots[id];
+    pool.stats.references--;
+    pool.stats.referencedBytes -= slot.text.size();
+    if (--slot.refs > 0) {
+        return;
+    }
+
+    pool.index.erase(slot.text);
+    pool.stats.strings--;
+    pool.stats.storedBytes -= slot.text.size();
+    if (slot.block != UINT32_MAX) {
+        releaseBlockString(pool, slot.block);
+    }
+    slot.text = std::string_view();
+    slot.generation++;
+    pool.freeSlots.push_back(id);
+}
+
+std::string_view getPooledString(PooledStringId id) {
+    StringPool& pool = getPool();
+    return id < pool.slots.size() ? pool.slots[id].text : std::string_view();
+}
+
+uint32_t getPooledStringGeneration(PooledStringId id) {
+    StringPool& pool = getPool();
+    return id < pool.slots.size() ? pool.slots[id].generation : 0;
+}
+
+StringPoolStats getStringPoolStats() {
+    return getPool().stats;
+}
+
+} // namespace koidice
@@ -0,0 +1,41 @@
+#pragma once
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+
+namespace koidice {
+
+/**
+ * 共享字符串池（牌堆内容）
+ * 相同文本只存一份，按引用计数回收；文本存放在分块的竞技场中，地址在释放前固定。
+ * 一个块内的字符串全部释放后整块归还，同一批加载（同一牌堆包）的文本通常位于相同的块，
+ * 卸载时可以整体回收
+ */
+using PooledStringId = uint32_t;
+
+// 登记文本并增加引用
+PooledStringId acquireString(std::string_view text);
+
+// 增加 / 减少引用，引用归零时释放
+void retainString(PooledStringId id);
+void releaseString(PooledStringId id);
+
+// 文本（已释放的ID返回空串）
+std::string_view getPooledString(PooledStringId id);
+
+// ID 的代数：ID 释放后被复用时递增，按ID缓存派生数据的一方用它判断缓存是否过期
+uint32_t getPooledStringGeneration(PooledStringId id);
+
+struct StringPoolStats {
+    size_t strings = 0;          // 存活的不同文本数
+    size_t references = 0;       // 引用总数
+    size_t storedBytes = 0;      // 实际存放的文本字节数
+    size_t referencedBytes = 0;  // 不去重时需要的文本字节数
+    size_t blockBytes = 0;       // 竞技场已分配字节数
+    size_t blocks = 0;           // 存活的块数
+    size_t reclaimedBlocks = 0;  // 累计整体回收的块数
+};
+
+StringPoolStats getStringPoolStats();
+
+} // namespace koidice
@@ -0,0 +1,33 @@
+#include "success_table.h"
+#include "../../../Dice/Dice/RD.h"
+#include <unordered_map>
+
+namespace koidice {
+
+// 缓存上限，超过后整体清空（常用技能值很快会重新填充）
+static constexpr size_t MAX_CACHED_TABLES = 512;
+
+static std::unordered_map<uint64_t, SuccessTable> successTableCache;
+
+const SuccessTable& getSuccessTable(int rule, int skillValue) {
+    uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(rule)) << 32)
+        | static_cast<uint32_t>(skillValue);
+
+    auto it = successTableCache.find(key);
+    if (it != successTableCache.end()) {
+        return it->second;
+    }
+
+    if (successTableCache.size() >= MAX_CACHED_TABLES) {
+        successTableCache.clear();
+    }
+
+    SuccessTable table{};
+    for (int roll = 1; roll <= 100; roll++) {
+        table[roll] = static_cast<int8_t>(RollSuccessLevel(roll, skillValue, rule));
+    }
+
+    return successTableCache.emplace(key, table).first->second;
+}
+
+} // namespace koidice
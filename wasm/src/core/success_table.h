@@ -0,0 +1,24 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+namespace koidice {
+
+/**
+ * 成功等级表
+ * 下标为 1D100 出目（1-100），值为对应的成功等级（与 RollSuccessLevel 一致）
+ */
+using SuccessTable = std::array<int8_t, 101>;
+
+/**
+ * 获取指定房规与技能值下的成功等级表
+ * 表在首次使用时由 Dice 的 RollSuccessLevel 生成并缓存，
+ * 之后每次检定只需一次查表
+ *
+ * @param rule COC房规
+ * @param skillValue 技能值（已应用难度修正）
+ * @return 成功等级表引用（在下一次缓存清理前有效）
+ */
+const SuccessTable& getSuccessTable(int rule, int skillValue);
+
+} // namespace koidice
@@ -86,27 +86,32 @@ std::string utf8RemovePrefix(const std::string& str, const std::string& prefix)
 bool isValidAttributeName(const std::string& name) {
     if (name.empty() || !isValidUTF8(name)) return false;
 
-    // 转换为 UTF-32 以便逐字符检查
-    size_t expectedLength = simdutf::utf32_length_from_utf8(name.c_str(), name.length());
-    std::u32string u32str(expectedLength, 0);
-
-    size_t actualLength = simdutf::convert_utf8_to_utf32(
-        name.c_str(),
-        name.length(),
-        reinterpret_cast<char32_t*>(&u32str[0])
-    );
-
-    u32str.resize(actualLength);
-
-    for (char32_t ch : u32str) {
-        bool isLetter = (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z');
-        bool isDigit = (ch >= '0' && ch <= '9');
-        bool isChinese = (ch >= 0x4E00 && ch <= 0x9FFF);  // CJK 统一汉字
-        bool isUnderscore = (ch == '_');
+    // 已通过校验，直接逐字符解码，无需转换为 UTF-32 缓冲区
+    size_t pos = 0;
+    while (pos < name.size()) {
+        unsigned char c = static_cast<unsigned char>(name[pos]);
+
+        if (c < 0x80) {
+            bool isLetter = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+            bool isDigit = (c >= '0' && c <= '9');
+            if (!isLetter && !isDigit && c != '_') {
+                return false;
+            }
+            pos++;
+            continue;
+        }
 
-        if (!isLetter && !isDigit && !isChinese && !isUnderscore) {
+        // CJK 统一汉字 U+4E00-9FFF 均为三字节序列
+        if (c < 0xE0 || c >= 0xF0) {
+            return false;
+        }
+        char32_t ch = (static_cast<char32_t>(c & 0x0F) << 12) |
+                      (static_cast<char32_t>(static_cast<unsigned char>(name[pos + 1]) & 0x3F) << 6) |
+                      static_cast<char32_t>(static_cast<unsigned char>(name[pos + 2]) & 0x3F);
+        if (ch < 0x4E00 || ch > 0x9FFF) {
             return false;
         }
+        pos += 3;
     }
 
     return true;
@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <cctype>
 #include <sstream>
+#include <vector>
 
 using namespace emscripten;
 
@@ -41,6 +42,118 @@ int getSecureRandomInt(int min, int max) {
     return min + result;
 }
 
+void getSecureRandomInts(int min, int max, int* out, size_t count) {
+    if (count == 0) {
+        return;
+    }
+
+    if (min > max) {
+        std::swap(min, max);
+    }
+
+    if (min == max) {
+        std::fill(out, out + count, min);
+        return;
+    }
+
+    // getRandomValues 单次最多填充 65536 字节
+    static constexpr size_t MAX_WORDS_PER_CALL = 65536 / sizeof(uint32_t);
+
+    std::vector<uint32_t> buffer(std::min(count, MAX_WORDS_PER_CALL));
+    val crypto = val::global("crypto");
+    unsigned int range = max - min + 1;
+
+    size_t filled = 0;
+    while (filled < count) {
+        size_t chunk = std::min(count - filled, buffer.size());
+
+        // 直接填充 WASM 内存中的缓冲区，避免逐个读取 JS 数组元素
+        crypto.call<void>("getRandomValues",
+                          val(typed_memory_view(chunk, buffer.data())));
+
+        for (size_t i = 0; i < chunk; i++) {
+            unsigned long long product = static_cast<unsigned long long>(buffer[i]) * range;
+            out[filled + i] = min + static_cast<int>(product >> 32);
+        }
+        filled += chunk;
+    }
+}
+
+SecureRandomBuffer::SecureRandomBuffer(size_t blockSize)
+    : pos(0), blockSize(std::max<size_t>(blockSize, 1)) {}
+
+void SecureRandomBuffer::reserve(size_t count) {
+    if (words.size() - pos < count) {
+        refill(count);
+    }
+}
+
+int SecureRandomBuffer::next(int min, int max) {
+    if (min > max) {
+        std::swap(min, max);
+    }
+
+    if (min == max) {
+        return min;
+    }
+
+    if (pos >= words.size()) {
+        refill(blockSize);
+    }
+
+    unsigned int range = max - min + 1;
+    unsigned long long product = static_cast<unsigned long long>(words[pos++]) * range;
+    return min + static_cast<int>(product >> 32);
+}
+
+uint32_t SecureRandomBuffer::nextWord() {
+    if (pos >= words.size()) {
+        refill(blockSize);
+    }
+    return words[pos++];
+}
+
+uint64_t SecureRandomBuffer::nextBelow(uint64_t bound) {
+    if (bound <= 1) {
+        return 0;
+    }
+    if (bound <= UINT32_MAX) {
+        return (static_cast<uint64_t>(nextWord()) * bound) >> 32;
+    }
+
+    // 64 位乘高位映射
+    uint64_t word = (static_cast<uint64_t>(nextWord()) << 32) | nextWord();
+    return static_cast<uint64_t>((static_cast<unsigned __int128>(word) * bound) >> 64);
+}
+
+void SecureRandomBuffer::refill(size_t count) {
+    // 保留尚未使用的随机字，再追加新取出的部分
+    words.erase(words.begin(), words.begin() + pos);
+    pos = 0;
+
+    size_t remaining = words.size();
+    size_t needed = std::max(count, blockSize);
+    if (needed <= remaining) {
+        return;
+    }
+
+    static constexpr size_t MAX_WORDS_PER_CALL = 65536 / sizeof(uint32_t);
+
+    words.resize(needed);
+    val crypto = val::global("crypto");
+    for (size_t filled = remaining; filled < needed;) {
+        size_t chunk = std::min(needed - filled, MAX_WORDS_PER_CALL);
+        crypto.call<void>("getRandomValues",
+                          val(typed_memory_view(chunk, words.data() + filled)));
+        filled += chunk;
+    }
+}
+
+val toInt32Array(const int32_t* data, size_t count) {
+    // 以内存视图为源构造新数组即完成复制，之后内存增长也不会影响返回值
+    return val::global("Int32Array").new_(val(typed_memory_view(count, data)));
+}
+
 std::string getErrorMessage(int_errno err) {
     switch (err) {
         case Value_Err: return "数值错误";
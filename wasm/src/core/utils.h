@@ -1,5 +1,8 @@
 #pragma once
 #include <string>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
 #include <emscripten/val.h>
 #include "../../Dice/Dice/RDConstant.h"
 
@@ -11,6 +14,41 @@ void ensureRandomInit();
 // 使用 JavaScript 的加密随机数生成器
 int getSecureRandomInt(int min, int max);
 
+// 批量获取加密随机数（一次 JS 调用填充 count 个 [min, max] 内的整数）
+void getSecureRandomInts(int min, int max, int* out, size_t count);
+
+/**
+ * 加密随机数缓冲区
+ * 按块从 crypto.getRandomValues 取出随机字，之后在 WASM 内映射到任意区间，
+ * 适合一次调用内需要大量、区间各不相同的随机数的场景
+ */
+class SecureRandomBuffer {
+public:
+    explicit SecureRandomBuffer(size_t blockSize = 256);
+
+    // 确保缓冲区中至少还有 count 个随机字（已知需求量时一次取够）
+    void reserve(size_t count);
+
+    // 取一个 [min, max] 内的随机整数
+    int next(int min, int max);
+
+    // 取一个原始 32 位随机字
+    uint32_t nextWord();
+
+    // 取一个 [0, bound) 内的 64 位随机整数（bound 为 0 时返回 0）
+    uint64_t nextBelow(uint64_t bound);
+
+private:
+    void refill(size_t count);
+
+    std::vector<uint32_t> words;
+    size_t pos;
+    size_t blockSize;
+};
+
+// 将 WASM 内存中的整数数组复制为独立的 JS Int32Array
+emscripten::val toInt32Array(const int32_t* data, size_t count);
+
 // 错误消息转换
 std::string getErrorMessage(int_errno err);
 
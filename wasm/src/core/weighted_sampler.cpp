@@ -0,0 +1,165 @@
+#include "weighted_sampler.h"
+
+namespace koidice {
+
+// ============ AliasTable ============
+
+void AliasTable::build(const std::vector<uint32_t>& weights) {
+    size_t n = weights.size();
+    threshold.assign(n, UINT32_MAX);
+    alias.resize(n);
+
+    uint64_t total = 0;
+    for (uint32_t w : weights) total += w;
+    if (n == 0 || total == 0) {
+        threshold.clear();
+        alias.clear();
+        return;
+    }
+
+    // 以 n * w_i 与总权重比较，全部使用整数运算
+    std::vector<uint64_t> scaled(n);
+    std::vector<uint32_t> small;
+    std::vector<uint32_t> large;
+    for (size_t i = 0; i < n; i++) {
+        alias[i] = static_cast<uint32_t>(i);
+        scaled[i] = static_cast<uint64_t>(weights[i]) * n;
+        (scaled[i] < total ? small : large).push_back(static_cast<uint32_t>(i));
+    }
+
+    while (!small.empty() && !large.empty()) {
+        uint32_t s = small.back();
+        small.pop_back();
+        uint32_t l = large.back();
+
+        threshold[s] = static_cast<uint32_t>((static_cast<unsigned __int128>(scaled[s]) << 32) / total);
+        alias[s] = l;
+
+        scaled[l] -= total - scaled[s];
+        if (scaled[l] < total) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+
+    // 剩余列（含舍入误差）概率为 1
+    for (uint32_t i : small) threshold[i] = UINT32_MAX;
+    for (uint32_t i : large) threshold[i] = UINT32_MAX;
+}
+
+size_t AliasTable::sample(SecureRandomBuffer& rng) const {
+    size_t column = static_cast<size_t>(rng.nextBelow(threshold.size()));
+    return rng.nextWord() < threshold[column] ? column : alias[column];
+}
+
+// ============ FenwickTree ============
+
+void FenwickTree::build(const std::vector<uint32_t>& weights) {
+    count = weights.size();
+    nodes.assign(count + 1, 0);
+    totalWeight = 0;
+
+    // O(n) 构建：每个节点把自己的和加到父节点
+    for (size_t i = 1; i <= count; i++) {
+        nodes[i] += weights[i - 1];
+        totalWeight += weights[i - 1];
+        size_t parent = i + (i & (~i + 1));
+        if (parent <= count) {
+            nodes[parent] += nodes[i];
+        }
+    }
+}
+
+// ============ FenwickSampler ============
+
+FenwickSampler::FenwickSampler(const FenwickTree& tree) : tree(tree) {
+    topStep = 1;
+    while (topStep * 2 <= tree.size()) {
+        topStep *= 2;
+    }
+}
+
+uint64_t FenwickSampler::node(size_t i) const {
+    uint64_t value = tree.node(i);
+    if (!taken.empty()) {
+        auto it = taken.find(i);
+        if (it != taken.end()) {
+            value -= it->second;
+        }
+    }
+    return value;
+}
+
+size_t FenwickSampler::drawOne(SecureRandomBuffer& rng) {
+    size_t n = tree.size();
+    uint64_t r = rng.nextBelow(remaining());
+
+    // 自顶向下查找前缀和首次超过 r 的位置
+    size_t pos = 0;
+    for (size_t step = n == 0 ? 0 : topStep; step > 0; step >>= 1) {
+        size_t next = pos + step;
+        if (next <= n) {
+            uint64_t value = node(next);
+            if (value <= r) {
+                pos = next;
+                r -= value;
+            }
+        }
+    }
+
+    // pos 为 0 起始下标；抽走一份权重
+    for (size_t i = pos + 1; i <= n; i += i & (~i + 1)) {
+        taken[i]++;
+    }
+    removed++;
+    return pos;
+}
+
+// ============ PartialShuffle ============
+
+// 抽取张数达到总数的 1/8 以上时使用稠密数组
+static constexpr size_t DENSE_DRAW_RATIO = 8;
+
+PartialShuffle::PartialShuffle(size_t n, size_t expectedDraws)
+    : total(n), dense(expectedDraws * DENSE_DRAW_RATIO >= n && n <= UINT32_MAX) {
+    if (dense) {
+        permutation.resize(n);
+        for (size_t i = 0; i < n; i++) {
+            permutation[i] = static_cast<uint32_t>(i);
+        }
+    } else {
+        swapped.reserve(expectedDraws * 2);
+    }
+}
+
+size_t PartialShuffle::at(size_t i) const {
+    if (dense) {
+        return permutation[i];
+    }
+    auto it = swapped.find(i);
+    return it == swapped.end() ? i : it->second;
+}
+
+void PartialShuffle::assign(size_t i, size_t value) {
+    if (dense) {
+        permutation[i] = static_cast<uint32_t>(value);
+    } else {
+        swapped[i] = value;
+    }
+}
+
+size_t PartialShuffle::drawOne(SecureRandomBuffer& rng) {
+    // 从 [cursor, total) 中选一个位置与 cursor 交换
+    size_t j = cursor + static_cast<size_t>(rng.nextBelow(total - cursor));
+    size_t picked = at(j);
+    if (j != cursor) {
+        assign(j, at(cursor));
+    }
+    if (!dense) {
+        swapped.erase(cursor);  // cursor 之前的位置不会再被访问
+    }
+    cursor++;
+    return picked;
+}
+
+} // namespace koidice
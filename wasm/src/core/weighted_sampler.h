@@ -0,0 +1,104 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <unordered_map>
+#include "utils.h"
+
+namespace koidice {
+
+/**
+ * Walker 别名表
+ * O(n) 构建，之后每次有放回加权抽样 O(1)（一次取下标、一次比较）
+ */
+class AliasTable {
+public:
+    void build(const std::vector<uint32_t>& weights);
+
+    bool empty() const { return threshold.empty(); }
+
+    // 抽取一个下标
+    size_t sample(SecureRandomBuffer& rng) const;
+
+private:
+    std::vector<uint32_t> threshold;  // 保留本列的概率 * 2^32
+    std::vector<uint32_t> alias;
+};
+
+/**
+ * 只读树状数组（Fenwick 树），保存各项权重的前缀和
+ * 构建一次后由 FenwickSampler 共享，多次无放回抽样之间不需要复制
+ */
+class FenwickTree {
+public:
+    void build(const std::vector<uint32_t>& weights);
+
+    size_t size() const { return count; }
+    uint64_t total() const { return totalWeight; }
+
+    // 节点值（下标从 1 开始）
+    uint64_t node(size_t i) const { return nodes[i]; }
+
+private:
+    std::vector<uint64_t> nodes;
+    size_t count = 0;
+    uint64_t totalWeight = 0;
+};
+
+/**
+ * 无放回加权抽样
+ * 在共享的 FenwickTree 之上以稀疏差值记录已抽走的权重，
+ * 每抽一张 O(log n)，内存只与抽取数量有关
+ */
+class FenwickSampler {
+public:
+    explicit FenwickSampler(const FenwickTree& tree);
+
+    // 剩余权重
+    uint64_t remaining() const { return tree.total() - removed; }
+
+    /**
+     * 抽取一个下标并将其权重减 1（即抽走一张副本）
+     * 调用前需确认 remaining() > 0
+     */
+    size_t drawOne(SecureRandomBuffer& rng);
+
+private:
+    uint64_t node(size_t i) const;
+
+    const FenwickTree& tree;
+    std::unordered_map<size_t, uint64_t> taken;  // 节点 -> 已抽走的权重
+    uint64_t removed = 0;
+    size_t topStep = 0;
+};
+
+/**
+ * 部分 Fisher–Yates 洗牌
+ * 只对实际抽出的位置做交换：抽 k 张只需 k 个随机数；
+ * 抽取比例较小时用稀疏交换表记录被换动的位置，不分配 n 大小的数组
+ */
+class PartialShuffle {
+public:
+    /**
+     * @param n 总张数
+     * @param expectedDraws 预计抽取张数，用于选择稠密或稀疏存储
+     */
+    PartialShuffle(size_t n, size_t expectedDraws);
+
+    size_t remaining() const { return total - cursor; }
+
+    // 抽取一个尚未抽出的下标，调用前需确认 remaining() > 0
+    size_t drawOne(SecureRandomBuffer& rng);
+
+private:
+    size_t at(size_t i) const;
+    void assign(size_t i, size_t value);
+
+    size_t total;
+    size_t cursor = 0;
+    bool dense;
+    std::vector<uint32_t> permutation;               // 稠密模式
+    std::unordered_map<size_t, size_t> swapped;      // 稀疏模式：位置 -> 当前值
+};
+
+} // namespace koidice
@@ -4,17 +4,229 @@
  */
 #include "dice_character_parse.h"
 #include "features/character_parser.h"
-#include <regex>
-#include <sstream>
-#include <map>
+#include "core/attribute_alias.h"
+#include "core/utf8_utils.h"
+#include "../../Dice/Dice/Jsonio.h"
+#include <string_view>
+#include <vector>
+
+namespace {
+
+using koidice::AttributeId;
+using koidice::INVALID_ATTRIBUTE;
+
+// 生成结果中的汇总项，不属于属性
+constexpr std::string_view SUMMARY_NAMES[] = {
+    "共计", "总计", "合计", "总和", "总数", "TOTAL", "Total", "total"
+};
+
+bool isSummaryName(std::string_view name) {
+    for (std::string_view summary : SUMMARY_NAMES) {
+        if (name == summary) return true;
+    }
+    return false;
+}
+
+bool isTokenSeparator(std::string_view text, size_t pos, size_t& length) {
+    unsigned char c = static_cast<unsigned char>(text[pos]);
+    length = 1;
+    if (c == ' ' || c == '\t' || c == '\r' || c == ',' || c == ';') {
+        return true;
+    }
+    // 全角逗号 U+FF0C (EF BC 8C)、分号 U+FF1B (EF BC 9B)、顿号 U+3001 (E3 80 81)、全角空格 U+3000 (E3 80 80)
+    if (c == 0xEF && pos + 2 < text.size() && static_cast<unsigned char>(text[pos + 1]) == 0xBC) {
+        unsigned char c2 = static_cast<unsigned char>(text[pos + 2]);
+        if (c2 == 0x8C || c2 == 0x9B) {
+            length = 3;
+            return true;
+        }
+    }
+    if (c == 0xE3 && pos + 2 < text.size() && static_cast<unsigned char>(text[pos + 1]) == 0x80) {
+        unsigned char c2 = static_cast<unsigned char>(text[pos + 2]);
+        if (c2 == 0x80 || c2 == 0x81) {
+            length = 3;
+            return true;
+        }
+    }
+    return false;
+}
 
 /**
- * 解析 COC 输出格式的属性
- * 格式：力量STR=3D6*5=60/30/12 体质CON=3D6*5=40/20/8
- * 提取：力量=60, 体质=40
+ * 解析数值部分：取最后一个 '=' 之后、第一个 '/' 之前的整数
+ * "3D6*5=60/30/12" -> 60，"60" -> 60，"-1" -> -1，"+1D4" -> 失败
  */
+bool parseCOCValue(std::string_view text, int& value) {
+    size_t eq = text.rfind('=');
+    if (eq != std::string_view::npos) {
+        text = text.substr(eq + 1);
+    }
+    size_t slash = text.find('/');
+    if (slash != std::string_view::npos) {
+        text = text.substr(0, slash);
+    }
+
+    size_t pos = 0;
+    bool negative = false;
+    if (pos < text.size() && (text[pos] == '+' || text[pos] == '-')) {
+        negative = text[pos] == '-';
+        pos++;
+    }
+    if (pos >= text.size() || text.size() - pos > 9) {
+        return false;
+    }
+
+    int result = 0;
+    for (; pos < text.size(); pos++) {
+        if (text[pos] < '0' || text[pos] > '9') {
+            return false;
+        }
+        result = result * 10 + (text[pos] - '0');
+    }
+    value = negative ? -result : result;
+    return true;
+}
+
+/**
+ * 解析属性名："力量STR" 先按中文部分查找，再按英文缩写查找
+ * @param name 输出：规范属性名；未知属性原样保留中文部分
+ */
+bool resolveCOCName(std::string_view text, std::string& name) {
+    size_t latinStart = text.size();
+    while (latinStart > 0) {
+        char ch = text[latinStart - 1];
+        bool latin = (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z');
+        if (!latin) break;
+        latinStart--;
+    }
+
+    std::string_view local = text.substr(0, latinStart);
+    std::string_view latin = text.substr(latinStart);
+    if (local.empty()) {
+        local = latin;
+        latin = std::string_view();
+    }
+
+    if (local.empty() || isSummaryName(local) || isSummaryName(latin)) {
+        return false;
+    }
+
+    AttributeId id = koidice::lookupAttributeAlias(local);
+    if (id == INVALID_ATTRIBUTE && !latin.empty()) {
+        id = koidice::lookupAttributeAlias(latin);
+    }
+    if (id != INVALID_ATTRIBUTE) {
+        name = koidice::getAttributeName(id);
+        return true;
+    }
+
+    name.assign(local.data(), local.size());
+    return koidice::isValidAttributeName(name);
+}
+
+/**
+ * 单遍扫描 COC 生成结果
+ * 记号以空白或逗号分隔，形如 名称[英文缩写](=|:|：)[表达式=]数值[/半值/五分之一]
+ */
+std::vector<nlohmann::json> scanCOCOutput(const std::string& input) {
+    std::vector<nlohmann::json> characters;
+    nlohmann::json current = nlohmann::json::object();
+    std::string_view text(input);
+    std::string name;
+
+    auto finishCharacter = [&]() {
+        if (!current.empty()) {
+            characters.push_back(std::move(current));
+            current = nlohmann::json::object();
+        }
+    };
+
+    size_t pos = 0;
+    while (pos < text.size()) {
+        // 换行：连续两个换行（空行）结束当前角色
+        if (text[pos] == '\n') {
+            size_t next = pos + 1;
+            while (next < text.size() && (text[next] == ' ' || text[next] == '\t' || text[next] == '\r')) {
+                next++;
+            }
+            if (next < text.size() && text[next] == '\n') {
+                finishCharacter();
+            }
+            pos = next;
+            continue;
+        }
+
+        size_t length = 1;
+        if (isTokenSeparator(text, pos, length)) {
+            pos += length;
+            continue;
+        }
+
+        // 读取一个记号
+        size_t tokenStart = pos;
+        while (pos < text.size() && text[pos] != '\n' && !isTokenSeparator(text, pos, length)) {
+            pos++;
+        }
+        std::string_view token = text.substr(tokenStart, pos - tokenStart);
+
+        // 名称与数值的分界：第一个 '='、':' 或 '：'（EF BC 9A）
+        size_t split = std::string_view::npos;
+        size_t splitLength = 1;
+        for (size_t i = 0; i < token.size(); i++) {
+            if (token[i] == '=' || token[i] == ':') {
+                split = i;
+                break;
+            }
+            if (static_cast<unsigned char>(token[i]) == 0xEF && i + 2 < token.size() &&
+                static_cast<unsigned char>(token[i + 1]) == 0xBC &&
+                static_cast<unsigned char>(token[i + 2]) == 0x9A) {
+                split = i;
+                splitLength = 3;
+                break;
+            }
+        }
+        if (split == std::string_view::npos || split == 0) {
+            continue;
+        }
+
+        int value = 0;
+        if (!resolveCOCName(token.substr(0, split), name) ||
+            !parseCOCValue(token.substr(split + splitLength), value)) {
+            continue;
+        }
+
+        // 同一属性再次出现：上一个角色已结束（.coc 多个结果之间可能没有空行）
+        if (current.contains(name)) {
+            finishCharacter();
+        }
+        current[name] = value;
+    }
+
+    finishCharacter();
+    return characters;
+}
+
+} // namespace
+
 std::string parseCOCAttributes(const std::string& input) {
-    // 简单返回空 JSON，不做任何解析
-    return "{}";
+    try {
+        std::vector<nlohmann::json> characters = scanCOCOutput(input);
+        if (characters.empty()) {
+            return "{}";
+        }
+        return characters.front().dump();
+    } catch (...) {
+        return "{}";
+    }
 }
 
+std::string parseCOCCharacters(const std::string& input) {
+    try {
+        nlohmann::json result = nlohmann::json::array();
+        for (nlohmann::json& character : scanCOCOutput(input)) {
+            result.push_back(std::move(character));
+        }
+        return result.dump();
+    } catch (...) {
+        return "[]";
+    }
+}
@@ -6,8 +6,17 @@
 
 /**
  * 解析 COC 输出格式的属性
+ * 支持 "力量STR=3D6*5=60/30/12" 与 "力量:60" 两种写法；
+ * 输入包含多个角色时只返回第一个
  * @param input COC 输出字符串
  * @return JSON 格式的属性对象
  */
 std::string parseCOCAttributes(const std::string& input);
 
+/**
+ * 解析 COC 输出中的全部角色
+ * 空行或属性重复出现时视为新角色开始
+ * @param input COC 输出字符串（如 .coc 5 的结果）
+ * @return JSON 数组，每个元素为一个角色的属性对象
+ */
+std::string parseCOCCharacters(const std::string& input);
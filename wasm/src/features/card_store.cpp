@@ -0,0 +1,505 @@
+#include "card_store.h"
+#include "character_parser.h"
+#include "derived_attributes.h"
+#include "../core/attribute_alias.h"
+#include "../core/command_processor.h"
+#include "../core/channel_state_table.h"
+#include "../../../Dice/Dice/Jsonio.h"
+#include <algorithm>
+
+using namespace emscripten;
+
+namespace koidice {
+
+// ============ ResidentCard ============
+
+ResidentCard::ResidentCard()
+    : canonical(canonicalAttributeCount(), 0),
+      present(canonicalAttributeCount(), 0),
+      count(0),
+      version(0),
+      savedVersion(0) {}
+
+bool ResidentCard::get(AttributeId id, int& value) const {
+    if (isCanonicalAttribute(id)) {
+        if (!present[id]) return false;
+        value = canonical[id];
+        return true;
+    }
+    return getOverflow(getAttributeName(id), value);
+}
+
+void ResidentCard::set(AttributeId id, int value) {
+    if (!isCanonicalAttribute(id)) {
+        setOverflow(getAttributeName(id), value);
+        return;
+    }
+
+    count += present[id] ? 0 : 1;
+    present[id] = 1;
+    canonical[id] = value;
+    extras.erase(getAttributeName(id));
+    version++;
+}
+
+bool ResidentCard::remove(AttributeId id) {
+    if (!isCanonicalAttribute(id)) {
+        return removeOverflow(getAttributeName(id));
+    }
+
+    bool removed = present[id] != 0;
+    present[id] = 0;
+    if (removed) {
+        count--;
+    }
+    removed = extras.erase(getAttributeName(id)) > 0 || removed;
+    version += removed ? 1 : 0;
+    return removed;
+}
+
+bool ResidentCard::get(const std::string& name, int& value) const {
+    AttributeId id = findResolvedAttributeId(name);
+    return id != INVALID_ATTRIBUTE ? get(id, value) : getOverflow(name, value);
+}
+
+void ResidentCard::set(const std::string& name, int value) {
+    AttributeId id = findResolvedAttributeId(name);
+    if (id != INVALID_ATTRIBUTE) {
+        set(id, value);
+    } else {
+        setOverflow(name, value);
+    }
+}
+
+bool ResidentCard::remove(const std::string& name) {
+    AttributeId id = findResolvedAttributeId(name);
+    return id != INVALID_ATTRIBUTE ? remove(id) : removeOverflow(name);
+}
+
+bool ResidentCard::getOverflow(const std::string& name, int& value) const {
+    auto it = overflow.find(name);
+    if (it == overflow.end()) return false;
+    value = it->second;
+    return true;
+}
+
+void ResidentCard::setOverflow(const std::string& name, int value) {
+    auto [it, inserted] = overflow.insert_or_assign(name, value);
+    count += inserted ? 1 : 0;
+    extras.erase(name);
+    version++;
+}
+
+bool ResidentCard::removeOverflow(const std::string& name) {
+    bool removed = overflow.erase(name) > 0;
+    if (removed) {
+        count--;
+    }
+    removed = extras.erase(name) > 0 || removed;
+    version += removed ? 1 : 0;
+    return removed;
+}
+
+size_t ResidentCard::size() const {
+    return count;
+}
+
+void ResidentCard::markSaved(uint32_t savedAt) {
+    // 确认可能乱序到达，只前进不后退
+    if (savedAt > savedVersion && savedAt <= version) {
+        savedVersion = savedAt;
+    }
+}
+
+bool ResidentCard::loadJSON(const std::string& json) {
+    nlohmann::json j = nlohmann::json::parse(json.empty() ? "{}" : json, nullptr, false);
+    if (j.is_discarded() || !j.is_object()) {
+        return false;
+    }
+
+    std::fill(present.begin(), present.end(), 0);
+    overflow.clear();
+    extras.clear();
+    count = 0;
+
+    for (auto it = j.begin(); it != j.end(); ++it) {
+        const nlohmann::json& value = it.value();
+        if (value.is_number()) {
+            int number = value.is_number_integer()
+                ? static_cast<int>(value.get<long long>())
+                : static_cast<int>(value.get<double>());
+            set(it.key(), number);
+        } else {
+            extras[it.key()] = value.dump();
+        }
+    }
+
+    savedVersion = version;
+    return true;
+}
+
+std::string ResidentCard::toJSON() const {
+    nlohmann::json j = nlohmann::json::object();
+
+    for (const auto& [name, text] : extras) {
+        j[name] = nlohmann::json::parse(text, nullptr, false);
+    }
+    forEach([&j](const std::string& name, int value) {
+        j[name] = value;
+    });
+
+    return j.dump();
+}
+
+// ============ 常驻存储 ============
+
+struct CardStoreEntry {
+    std::string platform;
+    std::string userId;
+    std::string cardName;
+    ResidentCard card;
+};
+
+// 被逐出时仍有未写回修改的人物卡，确认写回前保留，再次访问时放回常驻存储
+static std::unordered_map<std::string, CardStoreEntry> spilledCards;
+
+static void spillCard(const std::string& key, CardStoreEntry& entry, EvictReason) {
+    if (entry.card.isDirty()) {
+        spilledCards.insert_or_assign(key, std::move(entry));
+    }
+}
+
+static bool reloadCard(const std::string& key, CardStoreEntry& entry) {
+    auto it = spilledCards.find(key);
+    if (it == spilledCards.end()) {
+        return false;
+    }
+    entry = std::move(it->second);
+    spilledCards.erase(it);
+    return true;
+}
+
+// 常驻人物卡（LRU/空闲超时逐出），键见 makeCardKey
+static ChannelStateTable<CardStoreEntry>& cardStore() {
+    static ChannelStateTable<CardStoreEntry> table = [] {
+        ChannelStateTable<CardStoreEntry> t;
+        t.setEvictHandler(spillCard);
+        t.setLoadHandler(reloadCard);
+        return t;
+    }();
+    return table;
+}
+
+static std::string makeCardKey(const std::string& platform, const std::string& userId, const std::string& cardName) {
+    std::string key;
+    key.reserve(platform.size() + userId.size() + cardName.size() + 2);
+    key.append(platform).push_back('\x1f');
+    key.append(userId).push_back('\x1f');
+    key.append(cardName);
+    return key;
+}
+
+ResidentCard* findResidentCard(const std::string& platform, const std::string& userId, const std::string& cardName) {
+    CardStoreEntry* entry = cardStore().find(makeCardKey(platform, userId, cardName));
+    return entry ? &entry->card : nullptr;
+}
+
+bool loadCard(const std::string& platform, const std::string& userId, const std::string& cardName, const std::string& attributesJson) {
+    try {
+        CardStoreEntry entry;
+        entry.platform = platform;
+        entry.userId = userId;
+        entry.cardName = cardName;
+        if (!entry.card.loadJSON(attributesJson)) {
+            return false;
+        }
+
+        std::string key = makeCardKey(platform, userId, cardName);
+        spilledCards.erase(key);
+        cardStore().assign(key, std::move(entry));
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+val unloadCard(const std::string& platform, const std::string& userId, const std::string& cardName) {
+    val result = val::object();
+
+    std::string key = makeCardKey(platform, userId, cardName);
+    CardStoreEntry* entry = cardStore().find(key);
+    if (!entry) {
+        result.set("success", false);
+        result.set("dirty", false);
+        return result;
+    }
+
+    bool dirty = entry->card.isDirty();
+    result.set("success", true);
+    result.set("dirty", dirty);
+    if (dirty) {
+        result.set("attributes", entry->card.toJSON());
+    }
+
+    cardStore().erase(key);
+    return result;
+}
+
+bool isCardLoaded(const std::string& platform, const std::string& userId, const std::string& cardName) {
+    return findResidentCard(platform, userId, cardName) != nullptr;
+}
+
+val getCardAttributes(const std::string& platform, const std::string& userId, const std::string& cardName, const val& names) {
+    ResidentCard* card = findResidentCard(platform, userId, cardName);
+    if (!card) {
+        return val::null();
+    }
+
+    val result = val::object();
+    int length = names["length"].as<int>();
+
+    if (length == 0) {
+        card->forEach([&result](const std::string& name, int value) {
+            result.set(name, value);
+        });
+        return result;
+    }
+
+    for (int i = 0; i < length; i++) {
+        std::string name = names[i].as<std::string>();
+        AttributeId id = findResolvedAttributeId(name);
+        int value = 0;
+        if (id != INVALID_ATTRIBUTE ? card->get(id, value) : card->get(name, value)) {
+            result.set(id != INVALID_ATTRIBUTE ? getAttributeName(id) : name, value);
+        }
+    }
+
+    return result;
+}
+
+bool setCardAttributes(const std::string& platform, const std::string& userId, const std::string& cardName, const val& attributes) {
+    ResidentCard* card = findResidentCard(platform, userId, cardName);
+    if (!card) {
+        return false;
+    }
+
+    try {
+        val keys = val::global("Object").call<val>("keys", attributes);
+        int length = keys["length"].as<int>();
+        for (int i = 0; i < length; i++) {
+            std::string key = keys[i].as<std::string>();
+            val value = attributes[key];
+            if (value.isNumber()) {
+                card->set(key, value.as<int>());
+            }
+        }
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+val applyStToCard(const std::string& platform, const std::string& userId, const std::string& cardName,
+                  const std::string& input, const std::string& system) {
+    val result = val::object();
+
+    try {
+        ResidentCard* card = findResidentCard(platform, userId, cardName);
+        if (!card) {
+            result.set("success", false);
+            result.set("errorMsg", "人物卡未加载");
+            return result;
+        }
+
+        CharacterSystem sys = CharacterSystem::COC7;
+        bool withDerived = !system.empty();
+        if (withDerived && !parseCharacterSystem(system, sys)) {
+            result.set("success", false);
+            result.set("errorMsg", "不支持的体系: " + system);
+            return result;
+        }
+
+        std::string inputCardName;
+        std::vector<AttributeOperation> operations = parseStOperations(input, inputCardName);
+        if (!inputCardName.empty()) {
+            result.set("cardName", inputCardName);
+        }
+
+        if (operations.empty()) {
+            result.set("success", false);
+            result.set("errorMsg", "未识别到有效的属性设置");
+            return result;
+        }
+
+        // 先全部求值，出错时不修改人物卡
+        std::vector<AttributeUpdate> updates(operations.size());
+        // 已知属性名规范化后作为键，其余属性名原样作为键，不登记到属性表
+        std::vector<AttributeId> ids;
+        std::unordered_map<std::string, int> pending;
+        SecureRandomBuffer rng;
+
+        for (size_t i = 0; i < operations.size(); i++) {
+            AttributeId id = findResolvedAttributeId(operations[i].attr);
+            const std::string& key = id != INVALID_ATTRIBUTE ? getAttributeName(id) : operations[i].attr;
+
+            int oldValue = 0;
+            auto it = pending.find(key);
+            if (it != pending.end()) {
+                oldValue = it->second;
+            } else if (id != INVALID_ATTRIBUTE) {
+                card->get(id, oldValue);
+            } else {
+                card->get(key, oldValue);
+            }
+
+            int_errno err = evaluateAttributeOperation(operations[i], oldValue, rng, updates[i]);
+            if (err != 0) {
+                result.set("success", false);
+                result.set("errorMsg", operations[i].attr + ": " + getErrorMessage(err));
+                return result;
+            }
+            pending[key] = updates[i].newValue;
+            if (id != INVALID_ATTRIBUTE) {
+                ids.push_back(id);
+            }
+        }
+
+        // 派生属性基于本次修改后的值计算
+        std::vector<DerivedChange> derived;
+        if (withDerived) {
+            auto get = [&](AttributeId id, int& value) {
+                auto it = pending.find(getAttributeName(id));
+                if (it != pending.end()) {
+                    value = it->second;
+                    return true;
+                }
+                return card->get(id, value);
+            };
+            auto set = [&](AttributeId id, int value) { pending[getAttributeName(id)] = value; };
+            DerivedAttributeGraph::forSystem(sys).update(ids, get, set, derived);
+        }
+
+        val changed = val::object();
+        for (const auto& [name, value] : pending) {
+            card->set(name, value);
+            changed.set(name, value);
+        }
+
+        result.set("success", true);
+        result.set("updates", attributeUpdatesToJS(updates));
+        result.set("derived", derivedChangesToJS(derived));
+        result.set("attributes", changed);
+        result.set("errorMsg", "");
+    } catch (const std::exception& e) {
+        result.set("success", false);
+        result.set("errorMsg", std::string("异常: ") + e.what());
+    } catch (...) {
+        result.set("success", false);
+        result.set("errorMsg", "未知异常");
+    }
+
+    return result;
+}
+
+val processCheckWithCard(const std::string& rawCommand, int rule, const std::string& platform,
+                         const std::string& userId, const std::string& cardName) {
+    const ResidentCard* card = findResidentCard(platform, userId, cardName);
+    if (!card) {
+        val result = val::object();
+        result.set("success", false);
+        result.set("errorMsg", "人物卡未加载");
+        return result;
+    }
+
+    return CommandProcessor::processCheckResolved(rawCommand, rule, [card](AttributeId id, int& value) {
+        return card->get(id, value);
+    }, [card](const std::string& name, int& value) {
+        return card->get(name, value);
+    });
+}
+
+val exportDirtyCards() {
+    val result = val::array();
+    int index = 0;
+
+    auto exportEntry = [&](const std::string& key, const CardStoreEntry& entry) {
+        if (!entry.card.isDirty()) {
+            return;
+        }
+
+        val item = val::object();
+        item.set("key", key);
+        item.set("generation", static_cast<double>(entry.card.getVersion()));
+        item.set("platform", entry.platform);
+        item.set("userId", entry.userId);
+        item.set("cardName", entry.cardName);
+        item.set("attributes", entry.card.toJSON());
+        result.set(index++, item);
+    };
+
+    // 脏标记等宿主确认写回后再清除，写库失败时下次仍会导出
+    cardStore().forEach(exportEntry);
+    for (const auto& [key, entry] : spilledCards) {
+        exportEntry(key, entry);
+    }
+
+    return result;
+}
+
+int ackDirtyCards(const val& keys, const val& generations) {
+    int cleaned = 0;
+
+    try {
+        int length = std::min(keys["length"].as<int>(), generations["length"].as<int>());
+        for (int i = 0; i < length; i++) {
+            std::string key = keys[i].as<std::string>();
+            uint32_t generation = static_cast<uint32_t>(generations[i].as<double>());
+
+            // 只查看，不刷新访问顺序也不取回暂存的卡
+            if (CardStoreEntry* entry = cardStore().peek(key)) {
+                entry->card.markSaved(generation);
+                cleaned += entry->card.isDirty() ? 0 : 1;
+                continue;
+            }
+
+            auto spilled = spilledCards.find(key);
+            if (spilled != spilledCards.end()) {
+                spilled->second.card.markSaved(generation);
+                if (!spilled->second.card.isDirty()) {
+                    spilledCards.erase(spilled);
+                    cleaned++;
+                }
+            }
+        }
+    } catch (...) {
+    }
+
+    return cleaned;
+}
+
+void setCardStoreLimits(int maxCards, int ttlSeconds) {
+    ChannelStateTable<CardStoreEntry>::Limits limits;
+    limits.maxEntries = static_cast<size_t>(std::max(1, maxCards));
+    limits.ttlSeconds = static_cast<uint32_t>(std::max(0, ttlSeconds));
+    cardStore().setLimits(limits);
+}
+
+val getCardStoreStats() {
+    auto& table = cardStore();
+    int dirtyCount = static_cast<int>(spilledCards.size());
+    table.forEach([&dirtyCount](const std::string&, const CardStoreEntry& entry) {
+        dirtyCount += entry.card.isDirty() ? 1 : 0;
+    });
+
+    const auto& stats = table.stats();
+    val result = val::object();
+    result.set("cards", static_cast<int>(table.size()));
+    result.set("maxCards", static_cast<double>(table.getLimits().maxEntries));
+    result.set("dirty", dirtyCount);
+    result.set("spilled", static_cast<int>(spilledCards.size()));
+    result.set("evicted", static_cast<double>(stats.evictedCapacity + stats.evictedExpired));
+    result.set("internedAttributes", static_cast<int>(internedAttributeCount()));
+    return result;
+}
+
+} // namespace koidice
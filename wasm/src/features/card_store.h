@@ -0,0 +1,160 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include <emscripten/val.h>
+#include "../core/attribute_registry.h"
+
+namespace koidice {
+
+/**
+ * 常驻人物卡
+ * 规范属性存放在以属性ID为下标的稠密数组中，其余属性按名称放入溢出哈希表（不登记到全局属性表）；
+ * 非数值属性原样保留为 JSON 文本，导出时写回
+ */
+class ResidentCard {
+public:
+    ResidentCard();
+
+    // 读取属性，不存在时返回 false
+    bool get(AttributeId id, int& value) const;
+
+    // 写入属性并标记为脏（版本号加一）
+    void set(AttributeId id, int value);
+
+    // 删除属性，存在时标记为脏
+    bool remove(AttributeId id);
+
+    // 按属性名读写：已知属性名（含同义词）转为属性ID，其余按原名存放
+    bool get(const std::string& name, int& value) const;
+    void set(const std::string& name, int value);
+    bool remove(const std::string& name);
+
+    // 数值属性数量
+    size_t size() const;
+
+    // 每次修改版本号加一；写回到的版本不是最新版本时仍为脏
+    bool isDirty() const { return version != savedVersion; }
+    uint32_t getVersion() const { return version; }
+
+    // 宿主已保存到 savedAt 版本；之后又有修改时保持为脏
+    void markSaved(uint32_t savedAt);
+
+    // 从 JSON 对象文本加载（覆盖现有内容，不标记为脏）
+    bool loadJSON(const std::string& json);
+
+    // 导出为 JSON 对象文本
+    std::string toJSON() const;
+
+    // 遍历所有数值属性，fn(属性名, 值)
+    template <typename F>
+    void forEach(F&& fn) const {
+        for (size_t i = 0; i < canonical.size(); i++) {
+            if (present[i]) fn(getAttributeName(static_cast<AttributeId>(i)), canonical[i]);
+        }
+        for (const auto& [name, value] : overflow) {
+            fn(name, value);
+        }
+    }
+
+private:
+    bool getOverflow(const std::string& name, int& value) const;
+    void setOverflow(const std::string& name, int value);
+    bool removeOverflow(const std::string& name);
+
+    std::vector<int32_t> canonical;
+    std::vector<uint8_t> present;
+    std::unordered_map<std::string, int32_t> overflow;
+    std::unordered_map<std::string, std::string> extras;  // 非数值属性（JSON 文本）
+    size_t count;
+    uint32_t version;
+    uint32_t savedVersion;
+};
+
+/**
+ * 查找常驻人物卡（刷新 LRU 访问顺序）
+ * 常驻存储有容量上限，之后的查找或加载可能逐出其他人物卡，返回的指针只在下一次查找/加载前有效
+ * @return 未加载时返回 nullptr
+ */
+ResidentCard* findResidentCard(const std::string& platform, const std::string& userId, const std::string& cardName);
+
+// ============ 常驻人物卡存储（导出给 JS） ============
+
+/**
+ * 加载人物卡到常驻存储（覆盖同名的常驻卡与暂存的未写回修改）
+ * @param attributesJson 数据库中 attributes 列的 JSON 文本
+ */
+bool loadCard(const std::string& platform, const std::string& userId, const std::string& cardName, const std::string& attributesJson);
+
+/**
+ * 卸载人物卡
+ * @return JS对象 { success, dirty, attributes? }，有未写回的修改时附带 attributes JSON
+ */
+emscripten::val unloadCard(const std::string& platform, const std::string& userId, const std::string& cardName);
+
+// 被逐出但有未写回修改的人物卡仍视为已加载，访问时取回
+bool isCardLoaded(const std::string& platform, const std::string& userId, const std::string& cardName);
+
+/**
+ * 读取属性
+ * @param names JS数组，属性名（支持同义词）；为空数组时返回全部数值属性
+ * @return JS对象 { 属性名: 值 }，卡未加载时返回 null
+ */
+emscripten::val getCardAttributes(const std::string& platform, const std::string& userId, const std::string& cardName, const emscripten::val& names);
+
+/**
+ * 写入属性（标记为脏）
+ * @param attributes JS对象 { 属性名: 数值 }
+ */
+bool setCardAttributes(const std::string& platform, const std::string& userId, const std::string& cardName, const emscripten::val& attributes);
+
+/**
+ * 对常驻人物卡执行 .st 命令（支持 力量60、理智-1d6、hp+2 等写法）
+ * 所有操作求值成功后才写入人物卡
+ * @param input .st 参数；其中的 "名称--" 前缀仅原样返回，不用于选卡
+ * @param system 体系名称，用于更新受影响的派生属性；为空时不更新
+ * @return JS对象 { success, cardName?, updates, derived, attributes, errorMsg }，
+ *         attributes 为被修改属性（含派生属性）的新值，可直接写回数据库
+ */
+emscripten::val applyStToCard(const std::string& platform, const std::string& userId, const std::string& cardName,
+                              const std::string& input, const std::string& system);
+
+/**
+ * 使用常驻人物卡执行技能检定（技能名解析规则同 processCheckWithAttributes）
+ * @return 与 processCheck 相同，另含 { skillSource, modifier }；卡未加载时 success 为 false
+ */
+emscripten::val processCheckWithCard(const std::string& rawCommand, int rule, const std::string& platform,
+                                     const std::string& userId, const std::string& cardName);
+
+/**
+ * 导出所有脏卡（含被逐出暂存的人物卡），不清除脏标记
+ * 宿主写入数据库成功后以 key 与 generation 调用 ackDirtyCards 确认
+ * @return JS数组 Array<{ key, generation, platform, userId, cardName, attributes }>
+ */
+emscripten::val exportDirtyCards();
+
+/**
+ * 确认人物卡已写回到导出时的版本
+ * 导出后又被修改的人物卡保持为脏，下次导出时再次给出
+ * @param keys JS数组，exportDirtyCards 返回的 key
+ * @param generations JS数组，对应的 generation
+ * @return 确认后已不再为脏的人物卡数量
+ */
+int ackDirtyCards(const emscripten::val& keys, const emscripten::val& generations);
+
+/**
+ * 设置常驻存储容量与空闲超时
+ * 超出容量时逐出最久未访问的人物卡；有未写回修改的卡暂存到确认写回为止
+ * @param maxCards 至少为 1
+ * @param ttlSeconds 为 0 时不按空闲时间逐出
+ */
+void setCardStoreLimits(int maxCards, int ttlSeconds);
+
+/**
+ * 常驻存储统计
+ * @return JS对象 { cards, maxCards, dirty, spilled, evicted, internedAttributes }
+ */
+emscripten::val getCardStoreStats();
+
+} // namespace koidice
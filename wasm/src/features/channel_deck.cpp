@@ -0,0 +1,429 @@
+#include "channel_deck.h"
+#include "deck.h"
+#include "deck_compiler.h"
+#include "deck_template.h"
+#include "../core/utils.h"
+#include "../core/binary_codec.h"
+#include <map>
+#include <algorithm>
+
+using namespace emscripten;
+
+namespace koidice {
+
+// 频道牌堆：频道ID -> 牌堆名 -> 状态
+static std::map<std::string, std::map<std::string, ChannelDeck>> channelDecks;
+
+// 单个频道牌堆的最大张数（按权重展开后）
+static constexpr uint64_t MAX_CHANNEL_DECK_CARDS = 65536;
+
+// 单次抽取/预览的最大张数
+static constexpr int MAX_CHANNEL_DRAW = 100;
+
+// 快照格式标识与版本
+static constexpr char SNAPSHOT_MAGIC[4] = {'K', 'D', 'C', 'D'};
+static constexpr uint8_t SNAPSHOT_VERSION = 1;
+
+static ChannelDeck* findChannelDeck(const std::string& channelId, const std::string& deckName) {
+    auto it = channelDecks.find(channelId);
+    if (it == channelDecks.end()) {
+        return nullptr;
+    }
+    auto deckIt = it->second.find(deckName);
+    return deckIt == it->second.end() ? nullptr : &deckIt->second;
+}
+
+// 按权重展开牌序（未洗牌，洗牌在抽到时进行）；动态权重在创建/重置时求值一次
+static bool buildChannelDeck(ChannelDeck& state, const CompiledDeck& deck, std::string& message) {
+    if (deck.contents.empty()) {
+        message = "牌堆 " + deck.name + " 为空";
+        return false;
+    }
+
+    DeckWeights rolled;
+    const DeckWeights& table = rollDeckWeights(deck, rolled);
+    if (table.totalWeight > MAX_CHANNEL_DECK_CARDS) {
+        message = "牌堆 " + deck.name + " 张数过多，无法创建频道牌堆";
+        return false;
+    }
+
+    state.deckName = deck.name;
+    state.signature = deck.signature;
+    state.order.clear();
+    state.order.reserve(static_cast<size_t>(table.totalWeight));
+    for (size_t i = 0; i < table.weights.size(); i++) {
+        state.order.insert(state.order.end(), table.weights[i], static_cast<uint32_t>(i));
+    }
+    state.cursor = 0;
+    state.fixed = 0;
+    return true;
+}
+
+// 取得与频道牌堆一致的源牌堆，源牌堆被删除或内容变化时返回 nullptr
+static const CompiledDeck* getSourceDeck(const ChannelDeck& state, std::string& message) {
+    const CompiledDeck* deck = getCompiledDeck(state.deckName);
+    if (!deck) {
+        message = "牌堆 " + state.deckName + " 不存在";
+        return nullptr;
+    }
+    if (deck->signature != state.signature) {
+        message = "牌堆 " + state.deckName + " 内容已更新，请重置频道牌堆";
+        return nullptr;
+    }
+    return deck;
+}
+
+// 洗定游标之后的 count 张（已洗定的不再变动）
+static void settle(ChannelDeck& state, size_t count, SecureRandomBuffer& rng) {
+    size_t total = state.order.size();
+    size_t pos = state.cursor + state.fixed;
+    size_t target = std::min(total, static_cast<size_t>(state.cursor) + count);
+    for (; pos < target; pos++) {
+        size_t j = pos + static_cast<size_t>(rng.nextBelow(total - pos));
+        std::swap(state.order[pos], state.order[j]);
+        state.fixed++;
+    }
+}
+
+static void setCounts(val& result, const ChannelDeck& state) {
+    result.set("remaining", static_cast<int>(state.order.size() - state.cursor));
+    result.set("total", static_cast<int>(state.order.size()));
+}
+
+static val failure(const std::string& message) {
+    val result = val::object();
+    result.set("success", false);
+    result.set("message", message);
+    result.set("cards", val::array());
+    return result;
+}
+
+static int clampCount(int count, const ChannelDeck& state) {
+    int remaining = static_cast<int>(state.order.size() - state.cursor);
+    return std::min(std::min(count, remaining), MAX_CHANNEL_DRAW);
+}
+
+val createChannelDeck(const std::string& channelId, const std::string& deckName) {
+    try {
+        const CompiledDeck* deck = getCompiledDeck(deckName);
+        if (!deck) {
+            return failure(deckNotFoundMessage(deckName));
+        }
+
+        ChannelDeck state;
+        std::string message;
+        if (!buildChannelDeck(state, *deck, message)) {
+            return failure(message);
+        }
+
+        ChannelDeck& stored = channelDecks[channelId][deckName] = std::move(state);
+
+        val result = val::object();
+        result.set("success", true);
+        result.set("message", "");
+        result.set("cards", val::array());
+        setCounts(result, stored);
+        return result;
+    } catch (const std::exception& e) {
+        return failure(std::string("异常: ") + e.what());
+    } catch (...) {
+        return failure("未知异常");
+    }
+}
+
+val drawChannelDeck(const std::string& channelId, const std::string& deckName, int count) {
+    ensureRandomInit();
+
+    try {
+        ChannelDeck* state = findChannelDeck(channelId, deckName);
+        if (!state) {
+            return failure("频道牌堆 " + deckName + " 未创建");
+        }
+
+        std::string message;
+        const CompiledDeck* deck = getSourceDeck(*state, message);
+        if (!deck) {
+            return failure(message);
+        }
+
+        if (count < 1) {
+            return failure("抽取数量必须大于0");
+        }
+        if (count > MAX_CHANNEL_DRAW) {
+            return failure("抽取数量过大，最多100张");
+        }
+        if (state->cursor == state->order.size()) {
+            val result = failure("频道牌堆 " + deckName + " 已抽完");
+            setCounts(result, *state);
+            return result;
+        }
+
+        int drawCount = clampCount(count, *state);
+        SecureRandomBuffer rng;
+        rng.reserve(static_cast<size_t>(drawCount) * 2);
+        settle(*state, static_cast<size_t>(drawCount), rng);
+
+        // 展开嵌套牌堆引用与掷骰表达式
+        TemplateExpander expander(rng);
+        val jsCards = val::array();
+        for (int i = 0; i < drawCount; i++) {
+            uint32_t index = state->order[state->cursor + i];
+            jsCards.set(i, expander.expand(deck->contents[index], deck));
+        }
+        state->cursor += static_cast<uint32_t>(drawCount);
+        state->fixed -= static_cast<uint32_t>(drawCount);
+
+        val result = val::object();
+        result.set("success", true);
+        result.set("message", expander.limited() ? "部分牌面嵌套过深、过长或循环引用，未完全展开" : "");
+        result.set("cards", jsCards);
+        setCounts(result, *state);
+        return result;
+    } catch (const std::exception& e) {
+        return failure(std::string("异常: ") + e.what());
+    } catch (...) {
+        return failure("未知异常");
+    }
+}
+
+val peekChannelDeck(const std::string& channelId, const std::string& deckName, int count) {
+    ensureRandomInit();
+
+    try {
+        ChannelDeck* state = findChannelDeck(channelId, deckName);
+        if (!state) {
+            return failure("频道牌堆 " + deckName + " 未创建");
+        }
+
+        std::string message;
+        const CompiledDeck* deck = getSourceDeck(*state, message);
+        if (!deck) {
+            return failure(message);
+        }
+
+        if (count < 1 || count > MAX_CHANNEL_DRAW) {
+            return failure("预览数量必须在1-100之间");
+        }
+
+        int peekCount = clampCount(count, *state);
+        SecureRandomBuffer rng;
+        rng.reserve(static_cast<size_t>(peekCount) * 2);
+        settle(*state, static_cast<size_t>(peekCount), rng);
+
+        val jsCards = val::array();
+        for (int i = 0; i < peekCount; i++) {
+            uint32_t index = state->order[state->cursor + i];
+            jsCards.set(i, std::string(getDeckContent(deck->contents[index])));
+        }
+
+        val result = val::object();
+        result.set("success", true);
+        result.set("message", "");
+        result.set("cards", jsCards);
+        setCounts(result, *state);
+        return result;
+    } catch (const std::exception& e) {
+        return failure(std::string("异常: ") + e.what());
+    } catch (...) {
+        return failure("未知异常");
+    }
+}
+
+val returnChannelDeckCard(const std::string& channelId, const std::string& deckName,
+                          const std::string& card) {
+    try {
+        ChannelDeck* state = findChannelDeck(channelId, deckName);
+        if (!state) {
+            return failure("频道牌堆 " + deckName + " 未创建");
+        }
+
+        std::string message;
+        const CompiledDeck* deck = getSourceDeck(*state, message);
+        if (!deck) {
+            return failure(message);
+        }
+
+        if (state->cursor == 0) {
+            return failure("没有已抽出的牌");
+        }
+
+        // 从最近抽出的牌往前找
+        size_t found = state->cursor;
+        if (card.empty()) {
+            found = state->cursor - 1;
+        } else {
+            for (size_t i = state->cursor; i-- > 0;) {
+                if (getDeckContent(deck->contents[state->order[i]]) == card) {
+                    found = i;
+                    break;
+                }
+            }
+        }
+        if (found == state->cursor) {
+            return failure("没有已抽出的牌 " + card);
+        }
+
+        uint32_t returned = state->order[found];
+        // 已抽出区域收缩一位，放回的牌移到已洗定区域之后，之后抽到时重新参与洗牌
+        std::swap(state->order[found], state->order[state->cursor - 1]);
+        state->cursor--;
+        auto first = state->order.begin() + state->cursor;
+        std::rotate(first, first + 1, first + state->fixed + 1);
+
+        val cards = val::array();
+        cards.set(0, std::string(getDeckContent(deck->contents[returned])));
+
+        val result = val::object();
+        result.set("success", true);
+        result.set("message", "");
+        result.set("cards", cards);
+        setCounts(result, *state);
+        return result;
+    } catch (const std::exception& e) {
+        return failure(std::string("异常: ") + e.what());
+    } catch (...) {
+        return failure("未知异常");
+    }
+}
+
+val resetChannelDeck(const std::string& channelId, const std::string& deckName) {
+    try {
+        ChannelDeck* state = findChannelDeck(channelId, deckName);
+        if (!state) {
+            return failure("频道牌堆 " + deckName + " 未创建");
+        }
+
+        const CompiledDeck* deck = getCompiledDeck(deckName);
+        if (!deck) {
+            return failure("牌堆 " + deckName + " 不存在");
+        }
+
+        if (deck->signature != state->signature) {
+            std::string message;
+            ChannelDeck rebuilt;
+            if (!buildChannelDeck(rebuilt, *deck, message)) {
+                return failure(message);
+            }
+            *state = std::move(rebuilt);
+        } else {
+            // 牌序在抽到时才洗定，收回全部牌只需清零游标
+            state->cursor = 0;
+            state->fixed = 0;
+        }
+
+        val result = val::object();
+        result.set("success", true);
+        result.set("message", "");
+        result.set("cards", val::array());
+        setCounts(result, *state);
+        return result;
+    } catch (const std::exception& e) {
+        return failure(std::string("异常: ") + e.what());
+    } catch (...) {
+        return failure("未知异常");
+    }
+}
+
+bool removeChannelDeck(const std::string& channelId, const std::string& deckName) {
+    auto it = channelDecks.find(channelId);
+    if (it == channelDecks.end() || it->second.erase(deckName) == 0) {
+        return false;
+    }
+    if (it->second.empty()) {
+        channelDecks.erase(it);
+    }
+    return true;
+}
+
+bool clearChannelDecks(const std::string& channelId) {
+    return channelDecks.erase(channelId) > 0;
+}
+
+// 快照布局：魔数 | 版本 | 牌堆名 | 签名 | 张数 | 游标 | 已洗定数 | 牌序（变长整数）
+std::string serializeChannelDeck(const std::string& channelId, const std::string& deckName) {
+    ChannelDeck* state = findChannelDeck(channelId, deckName);
+    if (!state) {
+        return "";
+    }
+
+    try {
+        ByteWriter writer;
+        writer.raw(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+        writer.u8(SNAPSHOT_VERSION);
+        writer.str(state->deckName);
+        writer.u64(state->signature);
+        writer.varint(state->order.size());
+        writer.varint(state->cursor);
+        writer.varint(state->fixed);
+        for (uint32_t index : state->order) {
+            writer.varint(index);
+        }
+        return base64Encode(writer.data());
+    } catch (...) {
+        return "";
+    }
+}
+
+bool deserializeChannelDeck(const std::string& channelId, const std::string& snapshot) {
+    try {
+        std::vector<uint8_t> bytes;
+        if (!base64Decode(snapshot, bytes)) {
+            return false;
+        }
+
+        ByteReader reader(bytes.data(), bytes.size());
+        uint8_t version = 0;
+        ChannelDeck state;
+        uint64_t size = 0, cursor = 0, fixed = 0;
+        if (!reader.expect(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) || !reader.u8(version) ||
+            version != SNAPSHOT_VERSION || !reader.str(state.deckName, 1024) ||
+            !reader.u64(state.signature) || !reader.varint(size) || !reader.varint(cursor) ||
+            !reader.varint(fixed)) {
+            return false;
+        }
+
+        // 与创建时相同的张数上限，先于按 size 预留空间检查
+        if (size > MAX_CHANNEL_DECK_CARDS || cursor + fixed > size) {
+            return false;
+        }
+
+        // 源牌堆必须与快照一致，否则条目下标没有意义
+        const CompiledDeck* deck = getCompiledDeck(state.deckName);
+        if (!deck || deck->signature != state.signature ||
+            (deck->dynamicWeights.empty() && size != deck->totalWeight)) {
+            return false;
+        }
+
+        // 每个条目出现的次数必须等于其权重；动态权重条目的次数由创建时的求值决定，只要求至少一张
+        std::vector<uint32_t> limits = deck->weights;
+        for (const DynamicWeight& entry : deck->dynamicWeights) {
+            limits[entry.index] = UINT32_MAX;
+        }
+        std::vector<uint32_t> counts(limits.size(), 0);
+        state.order.reserve(static_cast<size_t>(size));
+        for (uint64_t i = 0; i < size; i++) {
+            uint64_t index;
+            if (!reader.varint(index) || index >= counts.size() || ++counts[index] > limits[index]) {
+                return false;
+            }
+            state.order.push_back(static_cast<uint32_t>(index));
+        }
+        if (!reader.atEnd()) {
+            return false;
+        }
+        for (size_t i = 0; i < counts.size(); i++) {
+            if (counts[i] != limits[i] && (limits[i] != UINT32_MAX || counts[i] == 0)) {
+                return false;
+            }
+        }
+
+        state.cursor = static_cast<uint32_t>(cursor);
+        state.fixed = static_cast<uint32_t>(fixed);
+        channelDecks[channelId][state.deckName] = std::move(state);
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+} // namespace koidice
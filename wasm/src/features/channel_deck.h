@@ -0,0 +1,51 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <emscripten/val.h>
+
+namespace koidice {
+
+/**
+ * 频道牌堆：从公共牌堆创建、跨多次指令持续发牌的无放回牌堆
+ * 状态为“牌序 + 游标”，牌序在抽到时才逐位洗定（惰性 Fisher–Yates），
+ * 因此抽牌、重置均为 O(1)，每张牌只占一个条目下标
+ */
+struct ChannelDeck {
+    std::string deckName;
+    uint64_t signature = 0;        // 创建时源牌堆的内容签名
+    std::vector<uint32_t> order;   // 条目下标，权重为 n 的条目出现 n 次
+    uint32_t cursor = 0;           // [0, cursor) 已抽出
+    uint32_t fixed = 0;            // [cursor, cursor + fixed) 已被预览而洗定
+};
+
+// 创建（或重新创建）频道牌堆
+emscripten::val createChannelDeck(const std::string& channelId, const std::string& deckName);
+
+// 从频道牌堆抽牌，剩余不足时只抽出剩余的牌
+emscripten::val drawChannelDeck(const std::string& channelId, const std::string& deckName, int count = 1);
+
+// 预览接下来的牌（返回牌面原文，不展开嵌套牌堆引用），之后的抽取会按预览顺序发出
+emscripten::val peekChannelDeck(const std::string& channelId, const std::string& deckName, int count = 1);
+
+/**
+ * 将已抽出的牌放回牌堆（随机位置）
+ * @param card 牌面原文；为空时放回最近抽出的一张
+ */
+emscripten::val returnChannelDeckCard(const std::string& channelId, const std::string& deckName,
+                                      const std::string& card);
+
+// 收回全部已抽出的牌；源牌堆已变化时按新内容重建
+emscripten::val resetChannelDeck(const std::string& channelId, const std::string& deckName);
+
+bool removeChannelDeck(const std::string& channelId, const std::string& deckName);
+bool clearChannelDecks(const std::string& channelId);
+
+/**
+ * 持久化：紧凑二进制快照（Base64 文本）
+ * 快照记录源牌堆签名，恢复时源牌堆内容不一致则拒绝
+ */
+std::string serializeChannelDeck(const std::string& channelId, const std::string& deckName);
+bool deserializeChannelDeck(const std::string& channelId, const std::string& snapshot);
+
+} // namespace koidice
@@ -1,6 +1,14 @@
 #include "character.h"
+#include "character_parser.h"
+#include "derived_attributes.h"
 #include "../core/utils.h"
 #include "../../../Dice/Dice/RD.h"
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <sstream>
+
+using namespace emscripten;
 
 namespace koidice {
 
@@ -81,4 +89,494 @@ std::string generateDNDCharacter(int count) {
     }
 }
 
+// ============ 结构化角色生成 ============
+
+// 单项基础属性公式：(dice 个 d6 [去掉最低] + add) * mul
+struct StatFormula {
+    int dice;
+    int add;
+    int mul;
+    bool dropLowest;
+};
+
+struct SystemFormula {
+    std::vector<StatFormula> stats;
+    int dicePerCharacter;
+    int totalStats;  // 计入总和的基础属性数量（COC 不含幸运）
+};
+
+static const SystemFormula COC7_FORMULA = {
+    {
+        {3, 0, 5, false},  // 力量
+        {3, 0, 5, false},  // 体质
+        {2, 6, 5, false},  // 体型
+        {3, 0, 5, false},  // 敏捷
+        {3, 0, 5, false},  // 外貌
+        {2, 6, 5, false},  // 智力
+        {3, 0, 5, false},  // 意志
+        {2, 6, 5, false},  // 教育
+        {3, 0, 5, false},  // 幸运
+    },
+    24,
+    8
+};
+
+static const SystemFormula COC6_FORMULA = {
+    {
+        {3, 0, 1, false},  // 力量
+        {3, 0, 1, false},  // 体质
+        {2, 6, 1, false},  // 体型
+        {3, 0, 1, false},  // 敏捷
+        {3, 0, 1, false},  // 外貌
+        {2, 6, 1, false},  // 智力
+        {3, 0, 1, false},  // 意志
+        {3, 3, 1, false},  // 教育
+    },
+    22,
+    8
+};
+
+static const SystemFormula DND_FORMULA = {
+    {
+        {4, 0, 1, true},  // 力量
+        {4, 0, 1, true},  // 敏捷
+        {4, 0, 1, true},  // 体质
+        {4, 0, 1, true},  // 智力
+        {4, 0, 1, true},  // 感知
+        {4, 0, 1, true},  // 魅力
+    },
+    24,
+    6
+};
+
+static const CharacterLayout COC7_LAYOUT = {
+    {"力量", "体质", "体型", "敏捷", "外貌", "智力", "意志", "教育", "幸运",
+     "生命", "魔法", "理智", "体格", "移动力"},
+    14,
+    9
+};
+
+static const CharacterLayout COC6_LAYOUT = {
+    {"力量", "体质", "体型", "敏捷", "外貌", "智力", "意志", "教育",
+     "理智", "灵感", "幸运", "知识", "生命", "魔法"},
+    14,
+    8
+};
+
+static const CharacterLayout DND_LAYOUT = {
+    {"力量", "敏捷", "体质", "智力", "感知", "魅力"},
+    6,
+    6
+};
+
+// 单次生成的角色数量上限
+static constexpr int MAX_GENERATE_COUNT = 100;
+
+static const SystemFormula& getSystemFormula(CharacterSystem system) {
+    switch (system) {
+        case CharacterSystem::COC6: return COC6_FORMULA;
+        case CharacterSystem::DND: return DND_FORMULA;
+        default: return COC7_FORMULA;
+    }
+}
+
+static int rollStat(const StatFormula& stat, SecureRandomBuffer& rng) {
+    int sum = 0;
+    int lowest = 7;
+    for (int d = 0; d < stat.dice; d++) {
+        int value = rng.next(1, 6);
+        sum += value;
+        lowest = std::min(lowest, value);
+    }
+    if (stat.dropLowest) {
+        sum -= lowest;
+    }
+    return (sum + stat.add) * stat.mul;
+}
+
+static int maxStatValue(const StatFormula& stat) {
+    int dice = stat.dropLowest ? stat.dice - 1 : stat.dice;
+    return (dice * 6 + stat.add) * stat.mul;
+}
+
+bool parseCharacterSystem(const std::string& name, CharacterSystem& system) {
+    std::string upper = name;
+    std::transform(upper.begin(), upper.end(), upper.begin(),
+                   [](unsigned char c) { return std::toupper(c); });
+
+    if (upper == "COC7" || upper == "COC") {
+        system = CharacterSystem::COC7;
+    } else if (upper == "COC6") {
+        system = CharacterSystem::COC6;
+    } else if (upper == "DND" || upper == "DND5E") {
+        system = CharacterSystem::DND;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const CharacterLayout& getCharacterLayout(CharacterSystem system) {
+    switch (system) {
+        case CharacterSystem::COC6: return COC6_LAYOUT;
+        case CharacterSystem::DND: return DND_LAYOUT;
+        default: return COC7_LAYOUT;
+    }
+}
+
+void rollCharacterRecords(CharacterSystem system, int count, SecureRandomBuffer& rng,
+                          int32_t* out, int32_t* totals) {
+    const SystemFormula& formula = getSystemFormula(system);
+    const CharacterLayout& layout = getCharacterLayout(system);
+
+    rng.reserve(static_cast<size_t>(count) * formula.dicePerCharacter);
+
+    for (int i = 0; i < count; i++) {
+        int32_t* record = out + static_cast<size_t>(i) * layout.stride;
+        int total = 0;
+
+        for (size_t k = 0; k < formula.stats.size(); k++) {
+            record[k] = rollStat(formula.stats[k], rng);
+            if (static_cast<int>(k) < formula.totalStats) {
+                total += record[k];
+            }
+        }
+
+        computeDerivedAttributes(system, record);
+        if (totals) {
+            totals[i] = total;
+        }
+    }
+}
+
+void computeDerivedAttributes(CharacterSystem system, int32_t* record) {
+    DerivedAttributeGraph::forSystem(system).evaluateRecord(record);
+}
+
+std::string getDamageBonus(CharacterSystem system, const int32_t* record) {
+    if (system == CharacterSystem::COC7) {
+        return getDamageBonusCOC7(record[12]);  // 体格
+    }
+    if (system == CharacterSystem::COC6) {
+        return getDamageBonusCOC6(record[0] + record[2]);  // 力量 + 体型
+    }
+    return "";
+}
+
+std::string formatCharacterRecord(CharacterSystem system, const int32_t* record, int total) {
+    const CharacterLayout& layout = getCharacterLayout(system);
+    std::ostringstream oss;
+
+    for (size_t k = 0; k < layout.stride; k++) {
+        if (k > 0) oss << ' ';
+        oss << layout.columns[k] << ':' << record[k];
+    }
+
+    if (system != CharacterSystem::DND) {
+        oss << " 伤害加值:" << getDamageBonus(system, record);
+    }
+    oss << " 共计:" << total;
+
+    return oss.str();
+}
+
+val generateCharacters(const std::string& system, int count, bool withText) {
+    ensureRandomInit();
+    val result = val::object();
+
+    try {
+        CharacterSystem sys;
+        if (!parseCharacterSystem(system, sys)) {
+            result.set("success", false);
+            result.set("errorMsg", "不支持的体系: " + system);
+            return result;
+        }
+
+        if (count < 1 || count > MAX_GENERATE_COUNT) {
+            result.set("success", false);
+            result.set("errorMsg", "生成数量必须在1-" + std::to_string(MAX_GENERATE_COUNT) + "之间");
+            return result;
+        }
+
+        const CharacterLayout& layout = getCharacterLayout(sys);
+        std::vector<int32_t> table(static_cast<size_t>(count) * layout.stride, 0);
+        std::vector<int32_t> totals(count, 0);
+
+        SecureRandomBuffer rng;
+        rollCharacterRecords(sys, count, rng, table.data(), totals.data());
+
+        val columns = val::array();
+        for (size_t k = 0; k < layout.columns.size(); k++) {
+            columns.set(k, layout.columns[k]);
+        }
+
+        val damageBonus = val::array();
+        std::ostringstream text;
+        for (int i = 0; i < count; i++) {
+            const int32_t* record = table.data() + static_cast<size_t>(i) * layout.stride;
+            damageBonus.set(i, getDamageBonus(sys, record));
+
+            if (withText) {
+                if (i > 0) text << '\n';
+                if (count > 1) text << '#' << (i + 1) << ' ';
+                text << formatCharacterRecord(sys, record, totals[i]);
+            }
+        }
+
+        result.set("success", true);
+        result.set("system", system);
+        result.set("count", count);
+        result.set("columns", columns);
+        result.set("stride", static_cast<int>(layout.stride));
+        result.set("table", toInt32Array(table.data(), table.size()));
+        result.set("totals", toInt32Array(totals.data(), totals.size()));
+        result.set("damageBonus", damageBonus);
+        if (withText) {
+            result.set("text", text.str());
+        }
+
+    } catch (const std::exception& e) {
+        result.set("success", false);
+        result.set("errorMsg", std::string("生成失败: ") + e.what());
+    } catch (...) {
+        result.set("success", false);
+        result.set("errorMsg", "生成失败: 未知错误");
+    }
+
+    return result;
+}
+
+// ============ 条件约束角色生成 ============
+
+// 单列的取值范围
+struct ColumnConstraint {
+    size_t column;
+    int min;
+    int max;
+};
+
+// 编译后的约束
+struct CharacterConstraints {
+    std::vector<ColumnConstraint> base;     // 基础属性：掷出后立即检查
+    std::vector<ColumnConstraint> derived;  // 派生属性：全部掷完后检查
+    int minTotal = INT32_MIN;
+    int maxTotal = INT32_MAX;
+};
+
+// 默认与最大迭代上限
+static constexpr int DEFAULT_CONSTRAINT_ITERATIONS = 100000;
+static constexpr int MAX_CONSTRAINT_ITERATIONS = 1000000;
+
+static int readIntField(const val& obj, const char* key, int fallback) {
+    val field = obj[key];
+    return field.isNumber() ? field.as<int>() : fallback;
+}
+
+/**
+ * 将 JS 约束对象编译为按列的范围检查
+ * 支持：minTotal / maxTotal / minEach / maxEach / attributes: { 属性名: { min?, max? } }
+ * 返回 false 时 errorMsg 给出原因
+ */
+static bool compileConstraints(CharacterSystem system, const val& constraints,
+                               CharacterConstraints& out, std::string& errorMsg) {
+    const CharacterLayout& layout = getCharacterLayout(system);
+
+    out.minTotal = readIntField(constraints, "minTotal", INT32_MIN);
+    out.maxTotal = readIntField(constraints, "maxTotal", INT32_MAX);
+
+    std::vector<int> mins(layout.stride, INT32_MIN);
+    std::vector<int> maxs(layout.stride, INT32_MAX);
+
+    int minEach = readIntField(constraints, "minEach", INT32_MIN);
+    int maxEach = readIntField(constraints, "maxEach", INT32_MAX);
+    for (size_t k = 0; k < layout.baseCount; k++) {
+        mins[k] = minEach;
+        maxs[k] = maxEach;
+    }
+
+    val attributes = constraints["attributes"];
+    if (!attributes.isUndefined() && !attributes.isNull()) {
+        val keys = val::global("Object").call<val>("keys", attributes);
+        int length = keys["length"].as<int>();
+        for (int i = 0; i < length; i++) {
+            std::string key = keys[i].as<std::string>();
+            std::string name = normalizeAttributeName(key);
+
+            auto it = std::find(layout.columns.begin(), layout.columns.end(), name);
+            if (it == layout.columns.end()) {
+                errorMsg = "未知属性: " + key;
+                return false;
+            }
+
+            size_t column = static_cast<size_t>(it - layout.columns.begin());
+            val range = attributes[key];
+            mins[column] = std::max(mins[column], readIntField(range, "min", INT32_MIN));
+            maxs[column] = std::min(maxs[column], readIntField(range, "max", INT32_MAX));
+        }
+    }
+
+    for (size_t k = 0; k < layout.stride; k++) {
+        if (mins[k] == INT32_MIN && maxs[k] == INT32_MAX) {
+            continue;
+        }
+        if (mins[k] > maxs[k]) {
+            errorMsg = "属性 " + layout.columns[k] + " 的范围无效";
+            return false;
+        }
+        ColumnConstraint constraint{k, mins[k], maxs[k]};
+        (k < layout.baseCount ? out.base : out.derived).push_back(constraint);
+    }
+
+    if (out.minTotal > out.maxTotal) {
+        errorMsg = "总和范围无效";
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * 掷一个候选角色，任一条件不满足时立即放弃剩余属性
+ * @return 是否满足全部约束
+ */
+static bool rollConstrainedCandidate(CharacterSystem system, const SystemFormula& formula,
+                                     const CharacterConstraints& constraints,
+                                     const std::vector<int>& remainingMax,
+                                     SecureRandomBuffer& rng, int32_t* record, int& total) {
+    // constraints.base 按列升序排列，与掷骰顺序一致
+    total = 0;
+    size_t next = 0;
+
+    for (size_t k = 0; k < formula.stats.size(); k++) {
+        int value = rollStat(formula.stats[k], rng);
+        record[k] = value;
+
+        if (next < constraints.base.size() && constraints.base[next].column == k) {
+            const ColumnConstraint& c = constraints.base[next++];
+            if (value < c.min || value > c.max) {
+                return false;
+            }
+        }
+
+        if (static_cast<int>(k) < formula.totalStats) {
+            total += value;
+            // 剩余属性全部取最大值也达不到下限时提前放弃
+            if (total + remainingMax[k] < constraints.minTotal || total > constraints.maxTotal) {
+                return false;
+            }
+        }
+    }
+
+    computeDerivedAttributes(system, record);
+
+    for (const ColumnConstraint& c : constraints.derived) {
+        if (record[c.column] < c.min || record[c.column] > c.max) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+val generateCharactersWithConstraints(const std::string& system, int count,
+                                      const val& constraints, int maxIterations) {
+    ensureRandomInit();
+    val result = val::object();
+
+    try {
+        CharacterSystem sys;
+        if (!parseCharacterSystem(system, sys)) {
+            result.set("success", false);
+            result.set("errorMsg", "不支持的体系: " + system);
+            return result;
+        }
+
+        if (count < 1 || count > MAX_GENERATE_COUNT) {
+            result.set("success", false);
+            result.set("errorMsg", "生成数量必须在1-" + std::to_string(MAX_GENERATE_COUNT) + "之间");
+            return result;
+        }
+
+        if (maxIterations <= 0) {
+            maxIterations = DEFAULT_CONSTRAINT_ITERATIONS;
+        }
+        maxIterations = std::min(maxIterations, MAX_CONSTRAINT_ITERATIONS);
+
+        CharacterConstraints compiled;
+        std::string errorMsg;
+        if (!compileConstraints(sys, constraints, compiled, errorMsg)) {
+            result.set("success", false);
+            result.set("errorMsg", errorMsg);
+            return result;
+        }
+
+        const SystemFormula& formula = getSystemFormula(sys);
+        const CharacterLayout& layout = getCharacterLayout(sys);
+
+        // remainingMax[k]：第 k 项之后、计入总和的属性最大可能值之和
+        std::vector<int> remainingMax(formula.stats.size(), 0);
+        for (int k = static_cast<int>(formula.stats.size()) - 2; k >= 0; k--) {
+            int nextMax = k + 1 < formula.totalStats ? maxStatValue(formula.stats[k + 1]) : 0;
+            remainingMax[k] = remainingMax[k + 1] + nextMax;
+        }
+
+        std::vector<int32_t> table(static_cast<size_t>(count) * layout.stride, 0);
+        std::vector<int32_t> totals(count, 0);
+
+        // 按块预取随机数：每个候选最多消耗 dicePerCharacter 个
+        SecureRandomBuffer rng(static_cast<size_t>(formula.dicePerCharacter) * 64);
+
+        int accepted = 0;
+        int iterations = 0;
+        while (accepted < count && iterations < maxIterations) {
+            iterations++;
+            int32_t* record = table.data() + static_cast<size_t>(accepted) * layout.stride;
+            int total = 0;
+            if (rollConstrainedCandidate(sys, formula, compiled, remainingMax, rng, record, total)) {
+                totals[accepted] = total;
+                accepted++;
+            }
+        }
+
+        table.resize(static_cast<size_t>(accepted) * layout.stride);
+        totals.resize(accepted);
+
+        val columns = val::array();
+        for (size_t k = 0; k < layout.columns.size(); k++) {
+            columns.set(k, layout.columns[k]);
+        }
+
+        val damageBonus = val::array();
+        for (int i = 0; i < accepted; i++) {
+            damageBonus.set(i, getDamageBonus(sys, table.data() + static_cast<size_t>(i) * layout.stride));
+        }
+
+        result.set("success", accepted > 0);
+        if (accepted == 0) {
+            result.set("errorMsg", "在 " + std::to_string(maxIterations) + " 次尝试内未生成满足条件的角色");
+        }
+        result.set("complete", accepted == count);
+        result.set("system", system);
+        result.set("count", accepted);
+        result.set("requested", count);
+        result.set("iterations", iterations);
+        result.set("maxIterations", maxIterations);
+        result.set("acceptanceRate", iterations > 0 ? static_cast<double>(accepted) / iterations : 0.0);
+        result.set("columns", columns);
+        result.set("stride", static_cast<int>(layout.stride));
+        result.set("table", toInt32Array(table.data(), table.size()));
+        result.set("totals", toInt32Array(totals.data(), totals.size()));
+        result.set("damageBonus", damageBonus);
+
+    } catch (const std::exception& e) {
+        result.set("success", false);
+        result.set("errorMsg", std::string("生成失败: ") + e.what());
+    } catch (...) {
+        result.set("success", false);
+        result.set("errorMsg", "生成失败: 未知错误");
+    }
+
+    return result;
+}
+
 } // namespace koidice
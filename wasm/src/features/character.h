@@ -1,5 +1,9 @@
 #pragma once
 #include <string>
+#include <vector>
+#include <cstdint>
+#include <emscripten/val.h>
+#include "../core/utils.h"
 
 namespace koidice {
 
@@ -12,4 +16,68 @@ std::string generateCOC7Multiple(int count);
 std::string generateCOC6Multiple(int count);
 std::string generateDNDCharacter(int count = 1);
 
+// ============ 结构化角色生成 ============
+
+// 角色卡体系
+enum class CharacterSystem {
+    COC7,
+    COC6,
+    DND
+};
+
+/**
+ * 角色记录布局
+ * 每个角色为一行 stride 个整数，前 baseCount 列为掷骰得到的基础属性，其后为派生属性
+ */
+struct CharacterLayout {
+    std::vector<std::string> columns;
+    size_t stride;
+    size_t baseCount;
+};
+
+// 解析体系名称（COC7 / COC6 / DND，不区分大小写）
+bool parseCharacterSystem(const std::string& name, CharacterSystem& system);
+
+// 获取体系对应的记录布局
+const CharacterLayout& getCharacterLayout(CharacterSystem system);
+
+/**
+ * 批量掷出角色属性
+ * 所有骰子一次取出，按布局写入 out（需预留 count * stride 个元素）
+ * @param totals 可选，输出每个角色基础属性总和（COC 不含幸运）
+ */
+void rollCharacterRecords(CharacterSystem system, int count, SecureRandomBuffer& rng,
+                          int32_t* out, int32_t* totals = nullptr);
+
+// 计算派生属性（基础属性已写入 record 时调用）
+void computeDerivedAttributes(CharacterSystem system, int32_t* record);
+
+// COC 伤害加值（由派生的体格/力量与体型计算）
+std::string getDamageBonus(CharacterSystem system, const int32_t* record);
+
+// 格式化单个角色记录
+std::string formatCharacterRecord(CharacterSystem system, const int32_t* record, int total);
+
+/**
+ * 结构化批量角色生成
+ * @param system 体系名称（COC7 / COC6 / DND）
+ * @param count 生成数量
+ * @param withText 是否同时返回格式化文本
+ * @return JS对象 { success, system, count, columns, stride, table: Int32Array, totals: Int32Array, damageBonus, text? }
+ */
+emscripten::val generateCharacters(const std::string& system, int count, bool withText);
+
+/**
+ * 按条件生成角色（在 WASM 内拒绝采样）
+ * 每个候选逐项掷骰，任一属性越界或总和已无法达标时立即放弃
+ *
+ * @param system 体系名称（COC7 / COC6 / DND）
+ * @param count 需要的角色数量
+ * @param constraints JS对象 { minTotal?, maxTotal?, minEach?, maxEach?, attributes?: { 属性名: { min?, max? } } }
+ * @param maxIterations 最多尝试的候选数（<=0 使用默认值）
+ * @return 与 generateCharacters 相同的表格，另含 { complete, requested, iterations, maxIterations, acceptanceRate }
+ */
+emscripten::val generateCharactersWithConstraints(const std::string& system, int count,
+                                                  const emscripten::val& constraints, int maxIterations);
+
 } // namespace koidice
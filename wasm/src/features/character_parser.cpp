@@ -1,6 +1,9 @@
 #include "character_parser.h"
 #include "../core/utils.h"
 #include "../core/utf8_utils.h"
+#include "../core/attribute_alias.h"
+#include "../core/dice_program.h"
+#include "derived_attributes.h"
 #include <regex>
 #include <unordered_map>
 #include <algorithm>
@@ -10,116 +13,172 @@
 
 namespace koidice {
 
-// 属性名称同义词映射（全小写）
-static const std::unordered_map<std::string, std::string> ATTRIBUTE_ALIASES = {
-    // COC7 属性
-    {"str", "力量"},
-    {"力量", "力量"},
-    {"strength", "力量"},
-    {"con", "体质"},
-    {"体质", "体质"},
-    {"constitution", "体质"},
-    {"siz", "体型"},
-    {"体型", "体型"},
-    {"size", "体型"},
-    {"dex", "敏捷"},
-    {"敏捷", "敏捷"},
-    {"dexterity", "敏捷"},
-    {"app", "外貌"},
-    {"外貌", "外貌"},
-    {"appearance", "外貌"},
-    {"int", "智力"},
-    {"智力", "智力"},
-    {"intelligence", "智力"},
-    {"pow", "意志"},
-    {"意志", "意志"},
-    {"power", "意志"},
-    {"edu", "教育"},
-    {"教育", "教育"},
-    {"education", "教育"},
-    {"luck", "幸运"},
-    {"幸运", "幸运"},
-    {"luk", "幸运"},
-    {"san", "理智"},
-    {"理智", "理智"},
-    {"sanity", "理智"},
-    {"hp", "生命"},
-    {"生命", "生命"},
-    {"生命值", "生命"},
-    {"mp", "魔法"},
-    {"魔法", "魔法"},
-    {"魔法值", "魔法"},
-    {"db", "伤害加值"},
-    {"伤害加值", "伤害加值"},
-    {"伤害奖励", "伤害加值"},
-    {"mov", "移动力"},
-    {"移动力", "移动力"},
-    {"move", "移动力"}
-};
-
 std::string normalizeAttributeName(const std::string& name) {
-    std::string lower = name;
-    std::transform(lower.begin(), lower.end(), lower.begin(),
-                   [](unsigned char c) { return std::tolower(c); });
+    AttributeId id = lookupAttributeAlias(name);
+    if (id != INVALID_ATTRIBUTE) {
+        return getAttributeName(id);
+    }
+    return name;
+}
 
-    // 去除空格
-    lower.erase(std::remove_if(lower.begin(), lower.end(), ::isspace), lower.end());
+// .st 属性名结束于数字、运算符或空白
+static bool isStNameTerminator(char ch) {
+    return std::isdigit(static_cast<unsigned char>(ch)) || std::isspace(static_cast<unsigned char>(ch)) ||
+           ch == '+' || ch == '-' || ch == '=' || ch == ':';
+}
 
-    auto it = ATTRIBUTE_ALIASES.find(lower);
-    if (it != ATTRIBUTE_ALIASES.end()) {
-        return it->second;
+// 表达式中的运算符之后必须跟随数字或骰子
+static bool isStOperandStart(const std::string& text, size_t pos) {
+    if (pos >= text.size()) return false;
+    char ch = text[pos];
+    if (std::isdigit(static_cast<unsigned char>(ch))) return true;
+    return (ch == 'd' || ch == 'D') && pos + 1 < text.size() &&
+           std::isdigit(static_cast<unsigned char>(text[pos + 1]));
+}
+
+static void skipSpaces(const std::string& text, size_t& pos) {
+    while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) {
+        pos++;
     }
-    return name;
 }
 
-emscripten::val parseStCommand(const std::string& input) {
+std::vector<AttributeOperation> parseStOperations(const std::string& input, std::string& cardName) {
     std::string text = trim(input);
-    std::string cardName;
     std::vector<AttributeOperation> operations;
+    cardName.clear();
 
     // 解析人物卡名称（格式：名称--属性 值）
-    std::regex cardRegex(R"(^(.+?)--(.+)$)");
-    std::smatch match;
-
-    if (std::regex_match(text, match, cardRegex)) {
-        cardName = trim(match[1].str());
-        text = trim(match[2].str());
+    size_t separator = text.find("--");
+    if (separator != std::string::npos && separator > 0 && separator + 2 < text.size()) {
+        cardName = trim(text.substr(0, separator));
+        text = trim(text.substr(separator + 2));
     }
 
-    // 按空格分割
-    std::vector<std::string> parts;
-    std::istringstream iss(text);
-    std::string part;
-    while (iss >> part) {
-        if (!part.empty()) {
-            parts.push_back(part);
+    size_t pos = 0;
+    while (pos < text.size()) {
+        skipSpaces(text, pos);
+        if (pos >= text.size()) break;
+
+        // 属性名；后面紧跟名称字符的 ':' 属于名称（如 "射击:手枪"），否则是赋值符
+        size_t nameStart = pos;
+        while (pos < text.size()) {
+            if (text[pos] == ':' && pos > nameStart && pos + 1 < text.size() &&
+                !isStNameTerminator(text[pos + 1]) && !isStOperandStart(text, pos + 1)) {
+                pos++;
+                continue;
+            }
+            if (isStNameTerminator(text[pos])) break;
+            pos++;
         }
-    }
+        std::string attrName = text.substr(nameStart, pos - nameStart);
+        skipSpaces(text, pos);
 
-    // 简单的"属性名 值"配对解析
-    for (size_t i = 0; i + 1 < parts.size(); i += 2) {
-        const std::string& attrName = parts[i];
-        const std::string& valueStr = parts[i + 1];
+        // 运算符：+ 增加，- 减少，= / : 或省略为设置
+        std::string op = "set";
+        if (pos < text.size() && (text[pos] == '+' || text[pos] == '-' || text[pos] == '=' || text[pos] == ':')) {
+            if (text[pos] == '+') op = "add";
+            if (text[pos] == '-') op = "sub";
+            pos++;
+            skipSpaces(text, pos);
+        }
+
+        // 数值或掷骰表达式（如 60、1d6、2d6+3）
+        size_t exprStart = pos;
+        bool expectOperand = true;
+        while (pos < text.size()) {
+            char ch = text[pos];
+            if (std::isdigit(static_cast<unsigned char>(ch))) {
+                expectOperand = false;
+            } else if ((ch == 'd' || ch == 'D') &&
+                       (pos + 1 >= text.size() || std::isdigit(static_cast<unsigned char>(text[pos + 1])) ||
+                        std::isspace(static_cast<unsigned char>(text[pos + 1])))) {
+                // "1d6"、"d6"、"1d"；"db" 等属性名中的 d 不计入
+                if (pos == exprStart && !isStOperandStart(text, pos)) break;
+                expectOperand = false;
+            } else if ((ch == '+' || ch == '-' || ch == '*') && !expectOperand && isStOperandStart(text, pos + 1)) {
+                expectOperand = true;
+            } else {
+                break;
+            }
+            pos++;
+        }
+        std::string expression = text.substr(exprStart, pos - exprStart);
 
-        // 验证属性名
-        if (!isValidAttributeName(attrName)) {
+        if (expression.empty()) {
+            // 无法识别的片段，跳过一个字符以保证前进
+            if (pos == nameStart) pos++;
             continue;
         }
 
-        // 解析数值
-        try {
-            int value = std::stoi(valueStr);
-            operations.push_back({
-                normalizeAttributeName(attrName),
-                "set",
-                value
-            });
-        } catch (...) {
-            // 忽略无效数值
+        if (attrName.empty()) {
             continue;
         }
+
+        // 先按同义词查找（查找时已折叠全角与大小写），"ＳＴＲ"、"格斗(斗殴)" 等不必符合自定义属性名的字符限制
+        AttributeId id = lookupAttributeAlias(attrName);
+        if (id == INVALID_ATTRIBUTE && !isValidAttributeName(attrName)) {
+            continue;
+        }
+
+        AttributeOperation operation{id != INVALID_ATTRIBUTE ? getAttributeName(id) : attrName, op, 0, ""};
+        bool constant = expression.find_first_not_of("0123456789") == std::string::npos;
+        if (constant && expression.size() <= 9) {
+            operation.value = std::stoi(expression);
+        } else {
+            operation.expression = expression;
+        }
+        operations.push_back(std::move(operation));
+    }
+
+    return operations;
+}
+
+int_errno evaluateAttributeOperation(const AttributeOperation& operation, int oldValue,
+                                     SecureRandomBuffer& rng, AttributeUpdate& update) {
+    update.attr = operation.attr;
+    update.op = operation.op;
+    update.oldValue = oldValue;
+    update.newValue = oldValue;
+    update.delta = operation.value;
+    update.detail.clear();
+
+    if (!operation.expression.empty()) {
+        DiceProgram program = DiceProgram::compile(operation.expression, 100);
+        int_errno err = program.roll(rng, update.delta, update.detail);
+        if (err != 0) {
+            return err;
+        }
     }
 
+    if (operation.op == "add") {
+        update.newValue = std::max(0, oldValue + update.delta);
+    } else if (operation.op == "sub") {
+        update.newValue = std::max(0, oldValue - update.delta);
+    } else {
+        update.newValue = update.delta;
+    }
+    return 0;
+}
+
+emscripten::val attributeUpdatesToJS(const std::vector<AttributeUpdate>& updates) {
+    emscripten::val jsUpdates = emscripten::val::array();
+    for (size_t i = 0; i < updates.size(); ++i) {
+        emscripten::val item = emscripten::val::object();
+        item.set("attr", updates[i].attr);
+        item.set("op", updates[i].op);
+        item.set("oldValue", updates[i].oldValue);
+        item.set("newValue", updates[i].newValue);
+        item.set("delta", updates[i].delta);
+        item.set("detail", updates[i].detail);
+        jsUpdates.set(i, item);
+    }
+    return jsUpdates;
+}
+
+emscripten::val parseStCommand(const std::string& input) {
+    std::string cardName;
+    std::vector<AttributeOperation> operations = parseStOperations(input, cardName);
+
     // 转换为 JS 对象
     emscripten::val result = emscripten::val::object();
 
@@ -132,7 +191,11 @@ emscripten::val parseStCommand(const std::string& input) {
         emscripten::val op = emscripten::val::object();
         op.set("attr", operations[i].attr);
         op.set("op", operations[i].op);
-        op.set("value", operations[i].value);
+        if (operations[i].expression.empty()) {
+            op.set("value", operations[i].value);
+        } else {
+            op.set("value", operations[i].expression);
+        }
         jsOperations.set(i, op);
     }
     result.set("operations", jsOperations);
@@ -140,6 +203,103 @@ emscripten::val parseStCommand(const std::string& input) {
     return result;
 }
 
+emscripten::val applyStCommand(const std::string& input, const emscripten::val& attributes, const std::string& system) {
+    emscripten::val result = emscripten::val::object();
+
+    try {
+        std::string cardName;
+        std::vector<AttributeOperation> operations = parseStOperations(input, cardName);
+
+        if (!cardName.empty()) {
+            result.set("cardName", cardName);
+        }
+
+        if (operations.empty()) {
+            result.set("success", false);
+            result.set("errorMsg", "未识别到有效的属性设置");
+            return result;
+        }
+
+        CharacterSystem sys = CharacterSystem::COC7;
+        bool withDerived = !system.empty();
+        if (withDerived && !parseCharacterSystem(system, sys)) {
+            result.set("success", false);
+            result.set("errorMsg", "不支持的体系: " + system);
+            return result;
+        }
+
+        bool hasTable = !attributes.isUndefined() && !attributes.isNull();
+        // 已知属性名规范化后作为键，其余属性名原样作为键，不登记到属性表
+        std::unordered_map<std::string, int> current;
+        std::vector<AttributeId> changedIds;
+        emscripten::val changed = emscripten::val::object();
+
+        // 先读本次修改过的值，再读传入的属性表
+        auto getByName = [&](const std::string& name, int& value) {
+            auto it = current.find(name);
+            if (it != current.end()) {
+                value = it->second;
+                return true;
+            }
+            if (!hasTable) return false;
+            emscripten::val stored = attributes[name];
+            if (!stored.isNumber()) return false;
+            value = stored.as<int>();
+            return true;
+        };
+        auto setByName = [&](const std::string& name, int value) {
+            current[name] = value;
+            changed.set(name, value);
+        };
+        auto get = [&](AttributeId id, int& value) { return getByName(getAttributeName(id), value); };
+        auto set = [&](AttributeId id, int value) { setByName(getAttributeName(id), value); };
+
+        std::vector<AttributeUpdate> updates(operations.size());
+        SecureRandomBuffer rng;
+
+        for (size_t i = 0; i < operations.size(); ++i) {
+            const AttributeOperation& operation = operations[i];
+            AttributeId id = findResolvedAttributeId(operation.attr);
+            const std::string& key = id != INVALID_ATTRIBUTE ? getAttributeName(id) : operation.attr;
+
+            // 同一属性多次出现时基于上一次的结果
+            int oldValue = 0;
+            getByName(key, oldValue);
+
+            int_errno err = evaluateAttributeOperation(operation, oldValue, rng, updates[i]);
+            if (err != 0) {
+                result.set("success", false);
+                result.set("errorMsg", operation.attr + ": " + getErrorMessage(err));
+                return result;
+            }
+
+            setByName(key, updates[i].newValue);
+            if (id != INVALID_ATTRIBUTE) {
+                changedIds.push_back(id);
+            }
+        }
+
+        std::vector<DerivedChange> derived;
+        if (withDerived) {
+            DerivedAttributeGraph::forSystem(sys).update(changedIds, get, set, derived);
+        }
+
+        result.set("success", true);
+        result.set("updates", attributeUpdatesToJS(updates));
+        result.set("derived", derivedChangesToJS(derived));
+        result.set("attributes", changed);
+        result.set("errorMsg", "");
+    } catch (const std::exception& e) {
+        result.set("success", false);
+        result.set("errorMsg", std::string("异常: ") + e.what());
+    } catch (...) {
+        result.set("success", false);
+        result.set("errorMsg", "未知异常");
+    }
+
+    return result;
+}
+
 emscripten::val parseAttributeList(const std::string& input) {
     std::string text = trim(input);
     std::string cardName;
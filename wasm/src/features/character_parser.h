@@ -2,6 +2,7 @@
 #include <string>
 #include <vector>
 #include <emscripten/val.h>
+#include "../core/utils.h"
 
 namespace koidice {
 
@@ -10,8 +11,21 @@ namespace koidice {
  */
 struct AttributeOperation {
     std::string attr;
-    std::string op;  // "set", "add", "sub"
+    std::string op;          // "set", "add", "sub"
     int value;
+    std::string expression;  // 掷骰表达式（如 "1d6"）；为空表示 value 为常数
+};
+
+/**
+ * .st 操作的求值结果
+ */
+struct AttributeUpdate {
+    std::string attr;
+    std::string op;
+    int oldValue;
+    int newValue;
+    int delta;           // 本次求得的数值（set 时为新值）
+    std::string detail;  // 掷骰过程，常数时为空
 };
 
 /**
@@ -28,17 +42,51 @@ struct ParsedStCommand {
  */
 std::string normalizeAttributeName(const std::string& name);
 
+/**
+ * 解析 .st 命令参数（C++ 接口）
+ * @param input 输入字符串
+ * @param cardName 输出：人物卡名称，未指定时为空
+ */
+std::vector<AttributeOperation> parseStOperations(const std::string& input, std::string& cardName);
+
+/**
+ * 对单个属性执行 .st 操作
+ * add/sub 的结果不低于 0
+ * @param rng 随机数缓冲区
+ * @param oldValue 当前值
+ * @param update 输出：求值结果
+ * @return 错误码（0 表示成功）
+ */
+int_errno evaluateAttributeOperation(const AttributeOperation& operation, int oldValue,
+                                     SecureRandomBuffer& rng, AttributeUpdate& update);
+
+// 转换求值结果为 JS 数组 Array<{attr, op, oldValue, newValue, delta, detail}>
+emscripten::val attributeUpdatesToJS(const std::vector<AttributeUpdate>& updates);
+
 /**
  * 解析 .st 命令参数
  * 支持格式：
  * - 力量 60 敏捷 70
+ * - 力量60敏捷70
  * - Alice--力量 60 敏捷 70
+ * - 力量+10 理智-1d6 hp -1d3
  *
  * @param input 输入字符串
- * @return JS对象 { cardName?: string, operations: Array<{attr, op, value}> }
+ * @return JS对象 { cardName?: string, operations: Array<{attr, op, value}> }，
+ *         value 为常数或掷骰表达式字符串
  */
 emscripten::val parseStCommand(const std::string& input);
 
+/**
+ * 解析并执行 .st 命令
+ * @param input 输入字符串
+ * @param attributes JS对象 { 属性名: 数值 }，当前属性表
+ * @param system 体系名称（COC7 / COC6 / DND），用于更新受影响的派生属性；为空时不更新
+ * @return JS对象 { success, cardName?, updates, derived, attributes, errorMsg }，
+ *         attributes 仅包含被修改的属性（含派生属性）的新值
+ */
+emscripten::val applyStCommand(const std::string& input, const emscripten::val& attributes, const std::string& system);
+
 /**
  * 解析属性名列表（用于 show 和 del 命令）
  * 支持格式：
@@ -0,0 +1,219 @@
+#include "condition_tracker.h"
+#include <algorithm>
+
+namespace koidice {
+
+static constexpr size_t MAX_TEXT_BYTES = 1024;
+static constexpr uint64_t MAX_CONDITIONS = 4096;
+
+static size_t wheelIndex(int round) {
+    int index = round % ConditionTracker::WHEEL_SIZE;
+    return static_cast<size_t>(index < 0 ? index + ConditionTracker::WHEEL_SIZE : index);
+}
+
+uint32_t ConditionTracker::add(const std::string& target, const std::string& label, const std::string& anchor,
+                               int expireRound, int duration) {
+    Condition condition;
+    condition.id = nextId++;
+    condition.target = target;
+    condition.label = label;
+    condition.anchor = anchor;
+    condition.expireRound = std::max(expireRound, round);
+    condition.duration = duration;
+
+    schedule(condition);
+    conditions.emplace(condition.id, std::move(condition));
+    dirty = true;
+    return nextId - 1;
+}
+
+bool ConditionTracker::remove(uint32_t id) {
+    auto it = conditions.find(id);
+    if (it == conditions.end()) {
+        return false;
+    }
+    unschedule(it->second);
+    conditions.erase(it);
+    dirty = true;
+    return true;
+}
+
+const Condition* ConditionTracker::find(uint32_t id) const {
+    auto it = conditions.find(id);
+    return it == conditions.end() ? nullptr : &it->second;
+}
+
+void ConditionTracker::removeTarget(const std::string& target) {
+    for (auto it = conditions.begin(); it != conditions.end();) {
+        if (it->second.target == target) {
+            unschedule(it->second);
+            it = conditions.erase(it);
+            dirty = true;
+        } else {
+            ++it;
+        }
+    }
+}
+
+void ConditionTracker::schedule(const Condition& condition) {
+    if (condition.expireRound - round < WHEEL_SIZE) {
+        wheel[wheelIndex(condition.expireRound)][condition.anchor].push_back(condition.id);
+    } else {
+        overflow.emplace(condition.expireRound, condition.id);
+    }
+}
+
+void ConditionTracker::unschedule(const Condition& condition) {
+    if (condition.expireRound - round < WHEEL_SIZE) {
+        Bucket& bucket = wheel[wheelIndex(condition.expireRound)];
+        auto slot = bucket.find(condition.anchor);
+        if (slot == bucket.end()) {
+            return;
+        }
+        std::vector<uint32_t>& ids = slot->second;
+        ids.erase(std::remove(ids.begin(), ids.end(), condition.id), ids.end());
+        if (ids.empty()) {
+            bucket.erase(slot);
+        }
+        return;
+    }
+
+    auto [first, last] = overflow.equal_range(condition.expireRound);
+    for (auto it = first; it != last; ++it) {
+        if (it->second == condition.id) {
+            overflow.erase(it);
+            return;
+        }
+    }
+}
+
+void ConditionTracker::fire(Bucket& bucket, const std::string& anchor, bool late,
+                            std::vector<ConditionEvent>& expired) {
+    auto slot = bucket.find(anchor);
+    if (slot == bucket.end()) {
+        return;
+    }
+    for (uint32_t id : slot->second) {
+        auto it = conditions.find(id);
+        if (it == conditions.end()) {
+            continue;
+        }
+        expired.push_back(ConditionEvent{std::move(it->second), late});
+        conditions.erase(it);
+    }
+    bucket.erase(slot);
+    dirty = true;
+}
+
+// 轮末：本轮桶里剩下的效果，其参照角色本轮没有行动，补发到期
+void ConditionTracker::drainRound(int drained, std::vector<ConditionEvent>& expired) {
+    Bucket& bucket = wheel[wheelIndex(drained)];
+    while (!bucket.empty()) {
+        std::string anchor = bucket.begin()->first;
+        fire(bucket, anchor, true, expired);
+    }
+}
+
+// 溢出表中进入时间轮范围的效果移入对应的桶
+void ConditionTracker::refill() {
+    while (!overflow.empty() && overflow.begin()->first - round < WHEEL_SIZE) {
+        auto it = conditions.find(overflow.begin()->second);
+        if (it != conditions.end()) {
+            wheel[wheelIndex(it->second.expireRound)][it->second.anchor].push_back(it->first);
+        }
+        overflow.erase(overflow.begin());
+    }
+}
+
+void ConditionTracker::sync(int currentRound, const std::string& currentName,
+                            std::vector<ConditionEvent>& expired) {
+    if (currentRound - round > WHEEL_SIZE) {
+        // 一次跨过很多轮（如载入旧存档）：直接结算所有早于当前轮的效果，不逐轮空转
+        std::vector<uint32_t> passed;
+        for (const auto& [id, condition] : conditions) {
+            if (condition.expireRound < currentRound) {
+                passed.push_back(id);
+            }
+        }
+        for (uint32_t id : passed) {
+            auto it = conditions.find(id);
+            unschedule(it->second);
+            expired.push_back(ConditionEvent{std::move(it->second), true});
+            conditions.erase(it);
+            dirty = true;
+        }
+        round = currentRound;
+        dirty = true;
+        refill();
+        fire(wheel[wheelIndex(round)], std::string(), false, expired);
+    }
+
+    while (round < currentRound) {
+        drainRound(round, expired);
+        round++;
+        dirty = true;
+        refill();
+        fire(wheel[wheelIndex(round)], std::string(), false, expired);
+    }
+
+    if (!currentName.empty() && (turnRound != round || turnName != currentName)) {
+        turnRound = round;
+        turnName = currentName;
+        dirty = true;
+        fire(wheel[wheelIndex(round)], currentName, false, expired);
+    }
+}
+
+void ConditionTracker::encode(ByteWriter& writer) const {
+    writer.svarint(round);
+    writer.svarint(turnRound);
+    writer.str(turnName);
+    writer.varint(nextId);
+    writer.varint(conditions.size());
+    for (const auto& [id, condition] : conditions) {
+        writer.varint(id);
+        writer.str(condition.target);
+        writer.str(condition.label);
+        writer.str(condition.anchor);
+        writer.svarint(condition.expireRound);
+        writer.svarint(condition.duration);
+    }
+}
+
+static bool readInt(ByteReader& reader, int& value) {
+    int64_t wide;
+    if (!reader.svarint(wide) || wide < INT32_MIN || wide > INT32_MAX) {
+        return false;
+    }
+    value = static_cast<int>(wide);
+    return true;
+}
+
+bool ConditionTracker::decode(ByteReader& reader) {
+    ConditionTracker loaded;
+    uint64_t id = 0, count = 0;
+    if (!readInt(reader, loaded.round) || !readInt(reader, loaded.turnRound) ||
+        !reader.str(loaded.turnName, MAX_TEXT_BYTES) || !reader.varint(id) || id > UINT32_MAX ||
+        !reader.varint(count) || count > MAX_CONDITIONS) {
+        return false;
+    }
+    loaded.nextId = static_cast<uint32_t>(id);
+
+    for (uint64_t i = 0; i < count; i++) {
+        Condition condition;
+        if (!reader.varint(id) || id == 0 || id >= loaded.nextId || loaded.conditions.count(static_cast<uint32_t>(id)) ||
+            !reader.str(condition.target, MAX_TEXT_BYTES) || !reader.str(condition.label, MAX_TEXT_BYTES) ||
+            !reader.str(condition.anchor, MAX_TEXT_BYTES) || !readInt(reader, condition.expireRound) ||
+            !readInt(reader, condition.duration) || condition.expireRound < loaded.round) {
+            return false;
+        }
+        condition.id = static_cast<uint32_t>(id);
+        loaded.schedule(condition);
+        loaded.conditions.emplace(condition.id, std::move(condition));
+    }
+
+    *this = std::move(loaded);
+    return true;
+}
+
+} // namespace koidice
@@ -0,0 +1,97 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <cstdint>
+#include "../core/binary_codec.h"
+
+namespace koidice {
+
+/**
+ * 先攻中的状态/持续效果
+ * 在 expireRound 轮轮到 anchor 行动时到期；anchor 为空表示该轮开始时到期
+ */
+struct Condition {
+    uint32_t id = 0;
+    std::string target;     // 受影响的角色
+    std::string label;      // 效果名称（如 中毒、祝福）
+    std::string anchor;     // 计时的参照角色
+    int expireRound = 0;
+    int duration = 0;       // 添加时设定的轮数，仅用于显示
+};
+
+// 到期事件；late 表示参照角色该轮没有行动（被移除或一直延迟），在轮末补发
+struct ConditionEvent {
+    Condition condition;
+    bool late = false;
+};
+
+/**
+ * 按轮次分桶的时间轮
+ * 近期（WHEEL_SIZE 轮以内）的效果放在 round % WHEEL_SIZE 的桶里，桶内按参照角色索引；
+ * 更远的效果放在按轮次排序的溢出表中，轮次推进时再移入时间轮。
+ * 轮到某人行动只查一个桶里的一个键，代价与到期数量成正比，而不是扫描全部效果
+ */
+class ConditionTracker {
+public:
+    static constexpr int WHEEL_SIZE = 64;
+
+    ConditionTracker() : wheel(WHEEL_SIZE) {}
+
+    size_t size() const { return conditions.size(); }
+    bool empty() const { return conditions.empty(); }
+
+    // 添加效果，返回编号
+    uint32_t add(const std::string& target, const std::string& label, const std::string& anchor,
+                 int expireRound, int duration);
+    bool remove(uint32_t id);
+    const Condition* find(uint32_t id) const;
+
+    // 角色离开先攻列表时移除其身上的效果
+    void removeTarget(const std::string& target);
+
+    /**
+     * 同步到当前回合：先补齐跨过的轮次（上一轮未触发的效果作为 late 到期，
+     * 新一轮开始时到期的效果随之触发），再在当前行动者尚未触发过时触发其回合开始
+     * 多次调用是幂等的
+     */
+    void sync(int round, const std::string& currentName, std::vector<ConditionEvent>& expired);
+
+    // 按编号顺序遍历
+    template <typename F>
+    void forEach(F&& fn) const {
+        for (const auto& [id, condition] : conditions) {
+            fn(condition);
+        }
+    }
+
+    // 持久化（写入 / 读取整个计时器状态）
+    void encode(ByteWriter& writer) const;
+    bool decode(ByteReader& reader);
+
+    // 自上次 clearChanged 以来效果集合或推进位置是否有变化
+    bool changed() const { return dirty; }
+    void clearChanged() { dirty = false; }
+
+private:
+    using Bucket = std::unordered_map<std::string, std::vector<uint32_t>>;
+
+    void schedule(const Condition& condition);
+    void unschedule(const Condition& condition);
+    void fire(Bucket& bucket, const std::string& anchor, bool late, std::vector<ConditionEvent>& expired);
+    void drainRound(int round, std::vector<ConditionEvent>& expired);
+    void refill();
+
+    std::map<uint32_t, Condition> conditions;
+    std::vector<Bucket> wheel;
+    std::multimap<int, uint32_t> overflow;   // expireRound -> 编号，距当前轮 WHEEL_SIZE 以上
+
+    int round = 1;                 // 时间轮已推进到的轮次
+    int turnRound = 0;             // 最近一次触发回合开始的轮次与角色
+    std::string turnName;
+    uint32_t nextId = 1;
+    bool dirty = false;
+};
+
+} // namespace koidice
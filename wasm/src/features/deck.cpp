@@ -1,62 +1,16 @@
 #include "deck.h"
+#include "deck_compiler.h"
+#include "deck_registry.h"
+#include "deck_template.h"
 #include "../core/utils.h"
 #include "../core/utf8_utils.h"
-#include "../../../Dice/Dice/CardDeck.h"
 #include "../../../Dice/Dice/RandomGenerator.h"
-#include <sstream>
 #include <algorithm>
-#include <map>
 
 using namespace emscripten;
 
 namespace koidice {
 
-// 解析牌堆项目，提取权重和内容
-struct DeckItem {
-    std::string content;
-    int weight;
-};
-
-std::vector<DeckItem> parseDeckItems(const std::vector<std::string>& deck) {
-    std::vector<DeckItem> items;
-
-    for (const auto& str : deck) {
-        DeckItem item;
-        item.weight = 1; // 默认权重为1
-
-        // 检查是否有权重标记 ::权重::内容
-        size_t l = str.find("::");
-        size_t r = (l != std::string::npos) ? str.find("::", l + 2) : std::string::npos;
-
-        if (l != std::string::npos && r != std::string::npos) {
-            try {
-                std::string weightStr = str.substr(l + 2, r - l - 2);
-                // 尝试解析权重（可能是表达式）
-                std::string resolvedWeight = CardDeck::draw(weightStr);
-                if (resolvedWeight.length() <= 6) {
-                    int w = std::stoi(resolvedWeight);
-                    if (w > 0) {
-                        item.weight = w;
-                        item.content = str.substr(r + 2);
-                    } else {
-                        item.content = str;
-                    }
-                } else {
-                    item.content = str;
-                }
-            } catch (...) {
-                item.content = str;
-            }
-        } else {
-            item.content = str;
-        }
-
-        items.push_back(item);
-    }
-
-    return items;
-}
-
 val drawFromDeck(const std::string& deckName, int count) {
     // 直接使用洗牌算法，确保最大随机性
     return shuffleDeck(deckName, count);
@@ -64,25 +18,8 @@ val drawFromDeck(const std::string& deckName, int count) {
 
 std::string listDecks() {
     try {
-        std::ostringstream oss;
-        oss << "=== 可用牌堆 ===" << std::endl;
-
-        bool hasDecks = false;
-        for (const auto& [name, deck] : CardDeck::mPublicDeck) {
-            oss << "- " << name << " (" << deck.size() << "张)" << std::endl;
-            hasDecks = true;
-        }
-
-        for (const auto& [name, deck] : CardDeck::mExternPublicDeck) {
-            oss << "- " << name << " [扩展] (" << deck.size() << "张)" << std::endl;
-            hasDecks = true;
-        }
-
-        if (!hasDecks) {
-            return "没有可用的牌堆";
-        }
-
-        return oss.str();
+        const std::string& listing = getDeckListing();
+        return listing.empty() ? "没有可用的牌堆" : listing;
     } catch (...) {
         return "获取牌堆列表失败";
     }
@@ -90,83 +27,67 @@ std::string listDecks() {
 
 int getDeckSize(const std::string& deckName) {
     try {
-        if (CardDeck::mPublicDeck.count(deckName)) {
-            return static_cast<int>(CardDeck::mPublicDeck[deckName].size());
-        }
-
-        if (CardDeck::mExternPublicDeck.count(deckName)) {
-            return static_cast<int>(CardDeck::mExternPublicDeck[deckName].size());
-        }
-
-        return -1;
+        const DeckEntry* entry = getDeckEntry(findDeckId(deckName));
+        return entry && entry->source ? static_cast<int>(entry->source.size()) : -1;
     } catch (...) {
         return -1;
     }
 }
 
 bool deckExists(const std::string& deckName) {
-    return CardDeck::findDeck(deckName) >= 0;
+    return findDeckId(deckName) != INVALID_DECK;
+}
+
+std::string deckNotFoundMessage(const std::string& deckName) {
+    std::string message = "牌堆 " + deckName + " 不存在";
+    std::vector<std::string> similar = findSimilarDecks(deckName, 3);
+    if (!similar.empty()) {
+        message += "，你是不是要找：";
+        for (size_t i = 0; i < similar.size(); i++) {
+            message += (i ? "、" : "") + similar[i];
+        }
+    }
+    return message;
 }
 
-// 支持权重的洗牌算法（Fisher-Yates 改进版）
+// 支持权重的无放回抽取
 val shuffleDeck(const std::string& deckName, int count) {
     ensureRandomInit();
     val result = val::object();
 
     try {
-        // 检查牌堆是否存在
-        if (CardDeck::mPublicDeck.count(deckName) == 0 &&
-            CardDeck::mExternPublicDeck.count(deckName) == 0) {
+        // 获取预编译牌堆（权重只在牌堆变化时解析一次）
+        const CompiledDeck* deck = getCompiledDeck(deckName);
+        if (!deck) {
             result.set("success", false);
-            result.set("message", "牌堆 " + deckName + " 不存在");
+            result.set("message", deckNotFoundMessage(deckName));
             result.set("cards", val::array());
             return result;
         }
 
-        // 获取牌堆
-        std::vector<std::string> sourceDeck;
-        if (CardDeck::mPublicDeck.count(deckName)) {
-            sourceDeck = CardDeck::mPublicDeck[deckName];
-        } else {
-            sourceDeck = CardDeck::mExternPublicDeck[deckName];
-        }
-
-        if (sourceDeck.empty()) {
+        if (deck->contents.empty()) {
             result.set("success", false);
             result.set("message", "牌堆 " + deckName + " 为空");
             result.set("cards", val::array());
             return result;
         }
 
-        // 解析牌堆项目（提取权重）
-        std::vector<DeckItem> items = parseDeckItems(sourceDeck);
+        // 动态权重每次抽牌重新求值
+        DeckWeights rolled;
+        const DeckWeights& table = rollDeckWeights(*deck, rolled);
 
-        // 根据权重展开牌堆（每个权重为n的牌变成n张）
-        std::vector<std::string> expandedDeck;
-        for (const auto& item : items) {
-            for (int i = 0; i < item.weight; i++) {
-                expandedDeck.push_back(item.content);
-            }
-        }
-
-        if (expandedDeck.empty()) {
-            result.set("success", false);
-            result.set("message", "牌堆 " + deckName + " 展开后为空");
-            result.set("cards", val::array());
-            return result;
-        }
-
-        // 确定抽取数量
-        int drawCount = count;
+        // 确定抽取数量（权重为n的牌视为n张）
+        int64_t totalCards = static_cast<int64_t>(table.totalWeight);
+        int64_t drawCount = count;
 
         // count <= 0 表示抽取全部
         if (drawCount <= 0) {
-            drawCount = static_cast<int>(expandedDeck.size());
+            drawCount = totalCards;
         }
 
         // 限制最大抽取数量
-        if (drawCount > static_cast<int>(expandedDeck.size())) {
-            drawCount = static_cast<int>(expandedDeck.size());
+        if (drawCount > totalCards) {
+            drawCount = totalCards;
         }
 
         if (drawCount > 100) {
@@ -176,19 +97,30 @@ val shuffleDeck(const std::string& deckName, int count) {
             return result;
         }
 
-        // Fisher-Yates 洗牌算法（使用 JavaScript 加密随机数）
-        // 从后向前遍历，每次随机选择一个位置与当前位置交换
-        for (int i = expandedDeck.size() - 1; i > 0; i--) {
-            int j = getSecureRandomInt(0, i);
-            std::swap(expandedDeck[i], expandedDeck[j]);
+        SecureRandomBuffer rng;
+        rng.reserve(static_cast<size_t>(drawCount) * 2);
+
+        // 抽出的下标：无权重牌堆只洗抽出的位置（部分 Fisher–Yates），
+        // 有权重牌堆用树状数组无放回加权抽取，均不展开权重副本
+        std::vector<size_t> indices;
+        indices.reserve(static_cast<size_t>(drawCount));
+        if (table.uniform) {
+            PartialShuffle shuffle(deck->contents.size(), static_cast<size_t>(drawCount));
+            for (int64_t i = 0; i < drawCount; i++) {
+                indices.push_back(shuffle.drawOne(rng));
+            }
+        } else {
+            FenwickSampler sampler(table.weightTree);
+            for (int64_t i = 0; i < drawCount; i++) {
+                indices.push_back(sampler.drawOne(rng));
+            }
         }
 
-        // 取前 drawCount 张牌
+        // 展开嵌套牌堆引用与掷骰表达式
+        TemplateExpander expander(rng);
         std::vector<std::string> drawnCards;
-        for (int i = 0; i < drawCount; i++) {
-            // 解析嵌套牌堆引用
-            std::string card = CardDeck::draw(expandedDeck[i]);
-            drawnCards.push_back(card);
+        for (size_t index : indices) {
+            drawnCards.push_back(expander.expand(deck->contents[index], deck));
         }
 
         // 转换为 JavaScript 数组
@@ -200,8 +132,65 @@ val shuffleDeck(const std::string& deckName, int count) {
         result.set("success", true);
         result.set("message", "");
         result.set("cards", jsCards);
-        result.set("totalCards", static_cast<int>(expandedDeck.size()));
+        result.set("totalCards", static_cast<double>(totalCards));
+        if (expander.limited()) {
+            result.set("message", "部分牌面嵌套过深、过长或循环引用，未完全展开");
+        }
+
+    } catch (const std::exception& e) {
+        result.set("success", false);
+        result.set("message", std::string("异常: ") + e.what());
+        result.set("cards", val::array());
+    } catch (...) {
+        result.set("success", false);
+        result.set("message", "未知异常");
+        result.set("cards", val::array());
+    }
+
+    return result;
+}
+
+val drawFromDeckWithReplacement(const std::string& deckName, int count) {
+    ensureRandomInit();
+    val result = val::object();
+
+    try {
+        const CompiledDeck* deck = getCompiledDeck(deckName);
+        if (!deck || deck->aliasTable.empty()) {
+            result.set("success", false);
+            result.set("message", deck ? "牌堆 " + deckName + " 为空" : deckNotFoundMessage(deckName));
+            result.set("cards", val::array());
+            return result;
+        }
+
+        if (count < 1 || count > 100) {
+            result.set("success", false);
+            result.set("message", "抽取数量必须在1-100之间");
+            result.set("cards", val::array());
+            return result;
+        }
 
+        // 有放回加权抽取：别名表每张 O(1)
+        SecureRandomBuffer rng;
+        rng.reserve(static_cast<size_t>(count) * 2);
+
+        DeckWeights rolled;
+        const DeckWeights& table = rollDeckWeights(*deck, rolled);
+
+        TemplateExpander expander(rng);
+        val jsCards = val::array();
+        for (int i = 0; i < count; i++) {
+            size_t index = table.aliasTable.sample(rng);
+            jsCards.set(i, expander.expand(deck->contents[index], deck));
+        }
+
+        result.set("success", true);
+        result.set("message", "");
+        result.set("cards", jsCards);
+        result.set("totalCards", static_cast<double>(table.totalWeight));
+        if (expander.limited()) {
+            result.set("message", "部分牌面嵌套过深、过长或循环引用，未完全展开");
+        }
     } catch (const std::exception& e) {
         result.set("success", false);
         result.set("message", std::string("异常: ") + e.what());
@@ -11,7 +11,13 @@ std::string listDecks();
 int getDeckSize(const std::string& deckName);
 bool deckExists(const std::string& deckName);
 
-// 支持权重的洗牌算法
+// 牌堆不存在的提示（附带相似牌堆名）
+std::string deckNotFoundMessage(const std::string& deckName);
+
+// 支持权重的无放回抽取（权重为n的牌视为n张）
 emscripten::val shuffleDeck(const std::string& deckName, int count = -1);
 
+// 支持权重的有放回抽取（每次抽取后放回）
+emscripten::val drawFromDeckWithReplacement(const std::string& deckName, int count = 1);
+
 } // namespace koidice
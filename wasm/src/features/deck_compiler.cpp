@@ -0,0 +1,206 @@
+#include "deck_compiler.h"
+#include "../../../Dice/Dice/CardDeck.h"
+#include <memory>
+#include <unordered_map>
+
+namespace koidice {
+
+// 权重上限（与 Dice 一致，超过 6 位的权重视为普通文本）
+static constexpr int MAX_WEIGHT_DIGITS = 6;
+
+CompiledDeck::~CompiledDeck() {
+    for (DeckContentId id : contents) {
+        releaseString(id);
+    }
+}
+
+// ============ 编译 ============
+
+// 解析权重文本，不是 1-6 位正整数时返回 false
+static bool parseWeight(const std::string& text, uint32_t& weight) {
+    if (text.empty() || text.size() > MAX_WEIGHT_DIGITS ||
+        text.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+    int w = std::stoi(text);
+    if (w <= 0) {
+        return false;
+    }
+    weight = static_cast<uint32_t>(w);
+    return true;
+}
+
+/**
+ * 解析 ::权重::内容，失败时整段作为内容、权重为 1
+ * 含掷骰（[1d6]）或牌堆引用（{牌堆}）的权重每次抽牌结果不同，不在此求值，
+ * 由 expression 返回表达式原文；其余非数字权重交给 Dice 展开一次
+ */
+static void parseWeightedItem(std::string_view item, std::string_view& content, uint32_t& weight,
+                              std::string& expression) {
+    content = item;
+    weight = 1;
+    expression.clear();
+
+    size_t l = item.find("::");
+    if (l == std::string_view::npos) return;
+    size_t r = item.find("::", l + 2);
+    if (r == std::string_view::npos) return;
+
+    std::string weightStr(item.substr(l + 2, r - l - 2));
+
+    if (weightStr.find_first_of("[{") != std::string::npos) {
+        expression = std::move(weightStr);
+        content = item.substr(r + 2);
+        return;
+    }
+
+    if (weightStr.find_first_not_of("0123456789") != std::string::npos) {
+        try {
+            weightStr = CardDeck::draw(weightStr);
+        } catch (...) {
+            return;
+        }
+    }
+
+    if (parseWeight(weightStr, weight)) {
+        content = item.substr(r + 2);
+    }
+}
+
+void DeckWeights::rebuild() {
+    totalWeight = 0;
+    uniform = true;
+    for (uint32_t weight : weights) {
+        totalWeight += weight;
+        uniform = uniform && weight == 1;
+    }
+    weightTree.build(weights);
+    aliasTable.build(weights);
+}
+
+static void compileDeck(CompiledDeck& deck, const DeckSource& source) {
+    // 旧内容的引用在新内容登记之后释放，重编译时不变的文本不会被回收再复制
+    std::vector<DeckContentId> previous;
+    previous.swap(deck.contents);
+    deck.weights.clear();
+    deck.dynamicWeights.clear();
+    deck.contents.reserve(source.size());
+    deck.weights.reserve(source.size());
+
+    // FNV-1a：逐项混入内容文本、分隔符与权重
+    uint64_t hash = 14695981039346656037ULL;
+    auto mix = [&hash](uint8_t byte) {
+        hash = (hash ^ byte) * 1099511628211ULL;
+    };
+
+    std::string expression;
+    for (size_t i = 0; i < source.size(); i++) {
+        std::string_view content;
+        uint32_t weight = 1;
+        parseWeightedItem(source.at(i), content, weight, expression);
+
+        for (char c : content) {
+            mix(static_cast<uint8_t>(c));
+        }
+        mix(0);
+        if (expression.empty()) {
+            for (int k = 0; k < 4; k++) {
+                mix(static_cast<uint8_t>(weight >> (k * 8)));
+            }
+        } else {
+            // 动态权重混入表达式原文，签名不随求值结果变化
+            mix(0xFF);
+            for (char c : expression) {
+                mix(static_cast<uint8_t>(c));
+            }
+            mix(0);
+            deck.dynamicWeights.push_back({static_cast<uint32_t>(i), expression});
+        }
+
+        deck.contents.push_back(acquireString(content));
+        deck.weights.push_back(weight);
+    }
+
+    for (DeckContentId id : previous) {
+        releaseString(id);
+    }
+
+    deck.signature = hash;
+    deck.rebuild();
+
+    deck.sourceData = source.data();
+    deck.sourceSize = source.size();
+    deck.version++;
+}
+
+const DeckWeights& rollDeckWeights(const CompiledDeck& deck, DeckWeights& scratch) {
+    if (deck.dynamicWeights.empty()) {
+        return deck;
+    }
+
+    scratch.weights = deck.weights;
+    for (const DynamicWeight& dynamic : deck.dynamicWeights) {
+        uint32_t weight = 1;  // 求值失败或结果不是正整数时按 1 处理
+        try {
+            parseWeight(CardDeck::draw(dynamic.expression), weight);
+        } catch (...) {
+        }
+        scratch.weights[dynamic.index] = weight;
+    }
+    scratch.rebuild();
+    return scratch;
+}
+
+// 按牌堆ID索引的编译缓存
+static std::vector<std::unique_ptr<CompiledDeck>>& getDeckCache() {
+    static std::vector<std::unique_ptr<CompiledDeck>> cache;
+    return cache;
+}
+
+const CompiledDeck* getCompiledDeck(DeckId id) {
+    const DeckEntry* entry = getDeckEntry(id);
+    auto& cache = getDeckCache();
+
+    if (!entry || !entry->source) {
+        if (id < cache.size()) {
+            cache[id].reset();
+        }
+        return nullptr;
+    }
+
+    if (id >= cache.size()) {
+        cache.resize(static_cast<size_t>(id) + 1);
+    }
+
+    std::unique_ptr<CompiledDeck>& slot = cache[id];
+    const DeckSource& source = entry->source;
+    if (!slot) {
+        slot = std::make_unique<CompiledDeck>();
+        slot->name = entry->name;
+        compileDeck(*slot, source);
+    } else if (slot->sourceData != source.data() || slot->sourceSize != source.size()) {
+        compileDeck(*slot, source);
+    }
+    return slot.get();
+}
+
+const CompiledDeck* getCompiledDeck(const std::string& deckName) {
+    DeckId id = findDeckId(deckName);
+    return id == INVALID_DECK ? nullptr : getCompiledDeck(id);
+}
+
+void invalidateDeckCache(const std::string& deckName) {
+    notifyDeckChanged(deckName);
+    DeckId id = internDeckName(deckName);
+    auto& cache = getDeckCache();
+    if (id < cache.size()) {
+        cache[id].reset();
+    }
+}
+
+void invalidateAllDeckCaches() {
+    getDeckCache().clear();
+    refreshDeckRegistry();
+}
+
+} // namespace koidice
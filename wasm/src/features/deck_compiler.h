@@ -0,0 +1,88 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include "../core/weighted_sampler.h"
+#include "deck_registry.h"
+#include "../core/string_pool.h"
+
+namespace koidice {
+
+// 牌堆内容ID（共享字符串池中的ID，同一文本在所有牌堆中共用）
+using DeckContentId = PooledStringId;
+
+// 内容ID对应的文本
+inline std::string_view getDeckContent(DeckContentId id) {
+    return getPooledString(id);
+}
+
+/**
+ * 牌堆权重表：各条目权重与据此构建的抽样结构
+ */
+struct DeckWeights {
+    std::vector<uint32_t> weights;        // 与牌堆内容一一对应，均大于 0
+    uint64_t totalWeight = 0;
+    bool uniform = true;                  // 所有权重均为 1
+
+    FenwickTree weightTree;               // 无放回抽取
+    AliasTable aliasTable;                // 有放回抽取
+
+    // 由 weights 计算总权重并重建抽样结构
+    void rebuild();
+};
+
+// 权重为掷骰或牌堆表达式的条目（如 ::[1d6]::内容），每次抽牌重新求值
+struct DynamicWeight {
+    uint32_t index;                       // 在 contents 中的位置
+    std::string expression;               // 权重表达式原文
+};
+
+/**
+ * 预编译的牌堆
+ * 权重标记（::权重::内容）只在编译时解析一次，之后抽牌只使用内容ID与权重；
+ * 动态权重条目在编译结果中占位为 1，由 rollDeckWeights 在每次抽牌时求值；
+ * 每个内容ID持有字符串池中的一个引用
+ */
+struct CompiledDeck : DeckWeights {
+    CompiledDeck() = default;
+    CompiledDeck(const CompiledDeck&) = delete;
+    CompiledDeck& operator=(const CompiledDeck&) = delete;
+    ~CompiledDeck();  // 释放内容在字符串池中的引用
+
+    std::string name;
+    std::vector<DeckContentId> contents;  // 去除权重标记后的内容
+    std::vector<DynamicWeight> dynamicWeights;
+    uint32_t version = 0;                 // 每次重新编译递增
+    uint64_t signature = 0;               // 内容与权重（动态权重取表达式原文）的哈希，跨进程稳定，用于校验快照
+
+    // 源牌堆指纹（数据地址与条目数），源牌堆被替换或增删后重新编译
+    const void* sourceData = nullptr;
+    size_t sourceSize = 0;
+};
+
+/**
+ * 获取预编译牌堆
+ * 首次使用或源牌堆变化时编译，其余情况直接返回缓存
+ * @return 牌堆不存在时返回 nullptr
+ */
+const CompiledDeck* getCompiledDeck(const std::string& deckName);
+const CompiledDeck* getCompiledDeck(DeckId id);
+
+/**
+ * 取本次抽牌使用的权重表
+ * 没有动态权重时直接返回编译结果；否则复制编译结果的权重、对动态条目重新求值后写入 scratch 并返回 scratch。
+ * 求值结果不是正整数的条目按权重 1 处理
+ */
+const DeckWeights& rollDeckWeights(const CompiledDeck& deck, DeckWeights& scratch);
+
+/**
+ * 使牌堆缓存失效并更新注册表
+ * 源牌堆被增删、替换或原地修改后由修改方调用
+ */
+void invalidateDeckCache(const std::string& deckName);
+
+// 清空全部牌堆缓存
+void invalidateAllDeckCaches();
+
+} // namespace koidice
@@ -0,0 +1,544 @@
+#include "deck_pack.h"
+#include "deck_compiler.h"
+#include "../../../Dice/Dice/Jsonio.h"
+#include "yaml-cpp/eventhandler.h"
+#include "yaml-cpp/parser.h"
+#include "yaml-cpp/exceptions.h"
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <memory>
+#include <chrono>
+#include <streambuf>
+#include <istream>
+#include <algorithm>
+
+using namespace emscripten;
+
+namespace koidice {
+
+// 单个牌堆包文件的大小上限
+static constexpr size_t MAX_PACK_BYTES = 64 * 1024 * 1024;
+
+struct DeckPack {
+    DeckPack() = default;
+    DeckPack(const DeckPack&) = delete;
+    DeckPack& operator=(const DeckPack&) = delete;
+
+    ~DeckPack() {
+        for (const auto& [name, cards] : decks) {
+            for (PooledStringId id : cards) {
+                releaseString(id);
+            }
+        }
+    }
+
+    std::string id;
+    std::string title;
+    std::string author;
+    std::vector<std::pair<std::string, std::vector<PooledStringId>>> decks;
+    size_t sourceBytes = 0;
+    size_t cardCount = 0;
+    size_t cardBytes = 0;    // 牌面文本字节数（去重前）
+    double loadMs = 0;
+    uint64_t loadOrder = 0;  // 首次加载的次序，重新加载时保持不变
+
+    // 牌堆索引占用的字节数（牌面文本在共享字符串池中单独统计）
+    size_t indexBytes() const {
+        size_t bytes = decks.capacity() * sizeof(decks[0]);
+        for (const auto& [name, cards] : decks) {
+            bytes += name.capacity() + cards.capacity() * sizeof(PooledStringId);
+        }
+        return bytes;
+    }
+};
+
+static std::map<std::string, std::unique_ptr<DeckPack>> packs;
+
+// 牌堆名 -> 提供该牌堆的包与包内下标（按包的首次加载次序排列，后加载的在后，优先生效）
+static std::unordered_map<std::string, std::vector<std::pair<const DeckPack*, size_t>>> providers;
+
+static uint64_t nextLoadOrder = 0;
+
+// ============ 解析 ============
+
+// 牌堆文件的元数据键（其余 _ 开头的键为隐藏牌堆，仍可被引用）
+static bool isMetadataKey(std::string_view key) {
+    static constexpr std::string_view KEYS[] = {
+        "_title", "_author", "_date", "_updateDate", "_version", "_brief",
+        "_updateUrls", "_etag", "_keys", "_exports", "_license",
+    };
+    for (std::string_view k : KEYS) {
+        if (key == k) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * 解析结果写入器
+ * 两种格式的事件都归结为：顶层键、顶层标量值、牌堆数组开始/结束、牌面
+ */
+class PackBuilder {
+public:
+    explicit PackBuilder(DeckPack& pack) : pack(pack) {}
+
+    void key(std::string_view name) {
+        currentKey.assign(name.data(), name.size());
+    }
+
+    void scalarValue(std::string_view value) {
+        if (currentKey == "_title" && pack.title.empty()) {
+            pack.title.assign(value.data(), value.size());
+        } else if (currentKey == "_author" && pack.author.empty()) {
+            pack.author.assign(value.data(), value.size());
+        }
+    }
+
+    void beginDeck() {
+        inMetadata = isMetadataKey(currentKey);
+        if (!inMetadata) {
+            pack.decks.emplace_back(currentKey, std::vector<PooledStringId>());
+        }
+    }
+
+    void card(std::string_view text) {
+        if (inMetadata) {
+            scalarValue(text);
+            return;
+        }
+        pack.decks.back().second.push_back(acquireString(text));
+        pack.cardCount++;
+        pack.cardBytes += text.size();
+    }
+
+    void endDeck() {
+        if (!inMetadata && pack.decks.back().second.empty()) {
+            pack.decks.pop_back();
+        }
+        inMetadata = false;
+    }
+
+private:
+    DeckPack& pack;
+    std::string currentKey;
+    bool inMetadata = false;
+};
+
+/**
+ * JSON SAX 处理器
+ * 只关心“顶层对象 -> 数组 -> 标量”，更深的嵌套整体跳过
+ */
+class JsonPackHandler {
+public:
+    using json = nlohmann::json;
+
+    explicit JsonPackHandler(PackBuilder& builder) : builder(builder) {}
+
+    std::string error;
+
+    bool null() { return true; }
+    bool boolean(bool) { return true; }
+    bool number_integer(json::number_integer_t value) { return scalar(std::to_string(value)); }
+    bool number_unsigned(json::number_unsigned_t value) { return scalar(std::to_string(value)); }
+    bool number_float(json::number_float_t, const json::string_t& raw) { return scalar(raw); }
+    bool string(json::string_t& value) { return scalar(value); }
+    bool binary(json::binary_t&) { return true; }
+
+    bool start_object(std::size_t) {
+        if (depth == 0) {
+            rootIsObject = true;
+        }
+        depth++;
+        return true;
+    }
+
+    bool end_object() {
+        depth--;
+        return true;
+    }
+
+    bool key(json::string_t& name) {
+        if (depth == 1) {
+            builder.key(name);
+        }
+        return true;
+    }
+
+    bool start_array(std::size_t) {
+        depth++;
+        if (depth == 2 && rootIsObject) {
+            builder.beginDeck();
+            inDeck = true;
+        }
+        return true;
+    }
+
+    bool end_array() {
+        if (depth == 2 && inDeck) {
+            builder.endDeck();
+            inDeck = false;
+        }
+        depth--;
+        return true;
+    }
+
+    bool parse_error(std::size_t position, const std::string&, const nlohmann::detail::exception& e) {
+        error = "JSON 解析失败（位置 " + std::to_string(position) + "）: " + e.what();
+        return false;
+    }
+
+    bool rootIsObject = false;
+
+private:
+    bool scalar(std::string_view value) {
+        if (depth == 1) {
+            builder.scalarValue(value);
+        } else if (depth == 2 && inDeck) {
+            builder.card(value);
+        }
+        return true;
+    }
+
+    PackBuilder& builder;
+    int depth = 0;
+    bool inDeck = false;
+};
+
+/**
+ * YAML 事件处理器
+ * 与 JSON 相同只读取“顶层映射 -> 序列 -> 标量”；别名（*ref）不展开
+ */
+class YamlPackHandler : public YAML::EventHandler {
+public:
+    explicit YamlPackHandler(PackBuilder& builder) : builder(builder) {}
+
+    bool rootIsMap = false;
+
+    void OnDocumentStart(const YAML::Mark&) override {}
+    void OnDocumentEnd() override {}
+
+    void OnNull(const YAML::Mark&, YAML::anchor_t) override { beginNode(); }
+    void OnAlias(const YAML::Mark&, YAML::anchor_t) override { beginNode(); }
+
+    void OnScalar(const YAML::Mark&, const std::string&, YAML::anchor_t,
+                  const std::string& value) override {
+        bool isKey = beginNode();
+        if (frames.size() == 1 && frames[0].isMap) {
+            if (isKey) {
+                builder.key(value);
+            } else {
+                builder.scalarValue(value);
+            }
+        } else if (inDeck && frames.size() == 2) {
+            builder.card(value);
+        }
+    }
+
+    void OnSequenceStart(const YAML::Mark&, const std::string&, YAML::anchor_t,
+                         YAML::EmitterStyle::value) override {
+        beginNode();
+        frames.push_back({false, false});
+        if (frames.size() == 2 && frames[0].isMap) {
+            builder.beginDeck();
+            inDeck = true;
+        }
+    }
+
+    void OnSequenceEnd() override {
+        if (frames.size() == 2 && inDeck) {
+            builder.endDeck();
+            inDeck = false;
+        }
+        frames.pop_back();
+    }
+
+    void OnMapStart(const YAML::Mark&, const std::string&, YAML::anchor_t,
+                    YAML::EmitterStyle::value) override {
+        beginNode();
+        if (frames.empty()) {
+            rootIsMap = true;
+        }
+        frames.push_back({true, true});
+    }
+
+    void OnMapEnd() override { frames.pop_back(); }
+
+private:
+    struct Frame {
+        bool isMap;
+        bool expectKey;
+    };
+
+    // 节点开始：映射中键与值交替出现，返回该节点是否为键
+    bool beginNode() {
+        if (frames.empty() || !frames.back().isMap) {
+            return false;
+        }
+        bool isKey = frames.back().expectKey;
+        frames.back().expectKey = !isKey;
+        return isKey;
+    }
+
+    PackBuilder& builder;
+    std::vector<Frame> frames;
+    bool inDeck = false;
+};
+
+// 只读内存流，让 yaml-cpp 直接读取文件内容而不复制到 istringstream
+class MemoryStreamBuf : public std::streambuf {
+public:
+    explicit MemoryStreamBuf(const std::string& data) {
+        char* begin = const_cast<char*>(data.data());
+        setg(begin, begin, begin + data.size());
+    }
+};
+
+static bool parseJsonPack(const std::string& content, DeckPack& pack, std::string& error) {
+    PackBuilder builder(pack);
+    JsonPackHandler handler(builder);
+    bool ok = nlohmann::json::sax_parse(content.begin(), content.end(), &handler);
+    if (!ok) {
+        error = handler.error.empty() ? "JSON 解析失败" : handler.error;
+        return false;
+    }
+    if (!handler.rootIsObject) {
+        error = "牌堆文件顶层必须是对象";
+        return false;
+    }
+    return true;
+}
+
+static bool parseYamlPack(const std::string& content, DeckPack& pack, std::string& error) {
+    PackBuilder builder(pack);
+    YamlPackHandler handler(builder);
+    MemoryStreamBuf buffer(content);
+    std::istream stream(&buffer);
+
+    try {
+        YAML::Parser parser(stream);
+        parser.HandleNextDocument(handler);
+    } catch (const YAML::Exception& e) {
+        error = std::string("YAML 解析失败: ") + e.what();
+        return false;
+    }
+    if (!handler.rootIsMap) {
+        error = "牌堆文件顶层必须是映射";
+        return false;
+    }
+    return true;
+}
+
+static bool isJsonFormat(const std::string& packId, const std::string& content, const std::string& format) {
+    if (!format.empty()) {
+        return format == "json" || format == "JSON";
+    }
+    auto endsWith = [&packId](std::string_view ext) {
+        return packId.size() >= ext.size() && packId.compare(packId.size() - ext.size(), ext.size(), ext) == 0;
+    };
+    if (endsWith(".json")) {
+        return true;
+    }
+    if (endsWith(".yaml") || endsWith(".yml")) {
+        return false;
+    }
+    size_t first = content.find_first_not_of(" \t\r\n");
+    return first != std::string::npos && content[first] == '{';
+}
+
+// ============ 注册 ============
+
+static void collectNames(const DeckPack& pack, std::vector<std::string>& names) {
+    for (const auto& [name, cards] : pack.decks) {
+        names.push_back(name);
+    }
+}
+
+static void unregisterPack(const DeckPack& pack) {
+    for (const auto& [name, cards] : pack.decks) {
+        auto it = providers.find(name);
+        if (it == providers.end()) {
+            continue;
+        }
+        auto& list = it->second;
+        list.erase(std::remove_if(list.begin(), list.end(),
+                                  [&pack](const auto& p) { return p.first == &pack; }),
+                   list.end());
+        if (list.empty()) {
+            providers.erase(it);
+        }
+    }
+}
+
+// 按加载次序插入，重新加载的包回到原来的位置，不会覆盖之后加载的包
+static void registerPack(const DeckPack& pack) {
+    for (size_t i = 0; i < pack.decks.size(); i++) {
+        auto& list = providers[pack.decks[i].first];
+        auto pos = std::upper_bound(list.begin(), list.end(), pack.loadOrder,
+                                    [](uint64_t order, const auto& p) { return order < p.first->loadOrder; });
+        list.emplace(pos, &pack, i);
+    }
+}
+
+// 只通知受影响的牌堆，其余牌堆的编译缓存与注册表条目不变
+static void notifyChanged(std::vector<std::string>& names) {
+    std::sort(names.begin(), names.end());
+    names.erase(std::unique(names.begin(), names.end()), names.end());
+    for (const std::string& name : names) {
+        invalidateDeckCache(name);
+    }
+}
+
+static val packToJS(const DeckPack& pack) {
+    val info = val::object();
+    info.set("packId", pack.id);
+    info.set("title", pack.title);
+    info.set("author", pack.author);
+    info.set("decks", static_cast<int>(pack.decks.size()));
+    info.set("cards", static_cast<double>(pack.cardCount));
+    info.set("sourceBytes", static_cast<double>(pack.sourceBytes));
+    info.set("cardBytes", static_cast<double>(pack.cardBytes));
+    info.set("indexBytes", static_cast<double>(pack.indexBytes()));
+    info.set("loadMs", pack.loadMs);
+    return info;
+}
+
+val loadDeckPack(const std::string& packId, const std::string& content, const std::string& format) {
+    val result = val::object();
+
+    try {
+        if (content.size() > MAX_PACK_BYTES) {
+            result.set("success", false);
+            result.set("message", "牌堆文件过大");
+            return result;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+
+        // 先完整解析到新包，失败时旧包保持不变
+        auto pack = std::make_unique<DeckPack>();
+        pack->id = packId;
+        pack->sourceBytes = content.size();
+
+        std::string error;
+        bool ok = isJsonFormat(packId, content, format) ? parseJsonPack(content, *pack, error)
+                                                       : parseYamlPack(content, *pack, error);
+        if (!ok) {
+            result.set("success", false);
+            result.set("message", error);
+            return result;
+        }
+
+        pack->loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        std::vector<std::string> changed;
+        auto it = packs.find(packId);
+        bool reloaded = it != packs.end();
+        if (reloaded) {
+            collectNames(*it->second, changed);
+            unregisterPack(*it->second);
+            pack->loadOrder = it->second->loadOrder;
+        } else {
+            pack->loadOrder = nextLoadOrder++;
+        }
+        collectNames(*pack, changed);
+        registerPack(*pack);
+
+        // 替换后旧包（及其竞技场）释放，之后再通知注册表
+        std::unique_ptr<DeckPack>& slot = packs[packId];
+        slot = std::move(pack);
+        notifyChanged(changed);
+
+        result = packToJS(*slot);
+        result.set("success", true);
+        result.set("message", "");
+        result.set("reloaded", reloaded);
+    } catch (const std::exception& e) {
+        result.set("success", false);
+        result.set("message", std::string("异常: ") + e.what());
+    } catch (...) {
+        result.set("success", false);
+        result.set("message", "未知异常");
+    }
+
+    return result;
+}
+
+bool unloadDeckPack(const std::string& packId) {
+    auto it = packs.find(packId);
+    if (it == packs.end()) {
+        return false;
+    }
+
+    std::vector<std::string> changed;
+    collectNames(*it->second, changed);
+    unregisterPack(*it->second);
+    packs.erase(it);
+    notifyChanged(changed);
+    return true;
+}
+
+val getDeckPackStats() {
+    val list = val::array();
+    size_t i = 0;
+    for (const auto& [id, pack] : packs) {
+        list.set(i++, packToJS(*pack));
+    }
+    return list;
+}
+
+// 牌堆包自身因去重少存的字节数：各包牌面字节数之和减去其中不同文本的字节数。
+// 编译缓存等其他持有者对同一文本的引用不计入
+static size_t packSavedBytes() {
+    std::unordered_set<PooledStringId> distinct;
+    size_t referenced = 0;
+    size_t stored = 0;
+    for (const auto& [packId, pack] : packs) {
+        referenced += pack->cardBytes;
+        for (const auto& [name, cards] : pack->decks) {
+            for (PooledStringId id : cards) {
+                if (distinct.insert(id).second) {
+                    stored += getPooledString(id).size();
+                }
+            }
+        }
+    }
+    return referenced - stored;
+}
+
+val getDeckMemoryStats() {
+    StringPoolStats stats = getStringPoolStats();
+    val result = val::object();
+    result.set("strings", static_cast<double>(stats.strings));
+    result.set("references", static_cast<double>(stats.references));
+    result.set("storedBytes", static_cast<double>(stats.storedBytes));
+    result.set("referencedBytes", static_cast<double>(stats.referencedBytes));
+    result.set("savedBytes", static_cast<double>(packSavedBytes()));
+    result.set("blockBytes", static_cast<double>(stats.blockBytes));
+    result.set("blocks", static_cast<double>(stats.blocks));
+    result.set("reclaimedBlocks", static_cast<double>(stats.reclaimedBlocks));
+    result.set("packs", static_cast<int>(packs.size()));
+    return result;
+}
+
+const std::vector<PooledStringId>* findPackDeck(const std::string& name) {
+    auto it = providers.find(name);
+    if (it == providers.end()) {
+        return nullptr;
+    }
+    const auto& [pack, index] = it->second.back();
+    return &pack->decks[index].second;
+}
+
+size_t getPackDeckCount() {
+    return providers.size();
+}
+
+void forEachPackDeckName(const std::function<void(const std::string&)>& fn) {
+    for (const auto& [name, list] : providers) {
+        fn(name);
+    }
+}
+
+} // namespace koidice
@@ -0,0 +1,44 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <functional>
+#include <emscripten/val.h>
+#include "../core/string_pool.h"
+
+namespace koidice {
+
+/**
+ * 牌堆包（社区 JSON / YAML 牌堆文件）
+ * 文件内容流式解析（JSON 用 SAX，YAML 用事件接口），牌面直接登记到共享字符串池（跨包去重），
+ * 不经过 DOM 与 CardDeck 表；同一包重新加载时只更新该包涉及的牌堆，卸载时释放其引用
+ */
+
+/**
+ * 加载或热重载牌堆包
+ * @param packId 包标识（通常为文件名），同一标识再次加载即为热重载
+ * @param content 文件内容
+ * @param format "json" / "yaml"，为空时按标识的扩展名或内容判断
+ */
+emscripten::val loadDeckPack(const std::string& packId, const std::string& content,
+                             const std::string& format = "");
+
+bool unloadDeckPack(const std::string& packId);
+
+// 各包的加载耗时与内存统计
+emscripten::val getDeckPackStats();
+
+// 牌堆内容字符串池的内存统计（含牌堆包因去重节省的字节数）
+emscripten::val getDeckMemoryStats();
+
+// ============ 供牌堆注册表使用 ============
+
+// 牌堆包中的牌堆（多个包同名时取最后加载的），不存在时返回 nullptr
+const std::vector<PooledStringId>* findPackDeck(const std::string& name);
+
+// 牌堆包提供的牌堆名数
+size_t getPackDeckCount();
+
+void forEachPackDeckName(const std::function<void(const std::string&)>& fn);
+
+} // namespace koidice
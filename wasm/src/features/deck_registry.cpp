@@ -0,0 +1,366 @@
+#include "deck_registry.h"
+#include "deck_pack.h"
+#include "../../../Dice/Dice/CardDeck.h"
+#include <unordered_map>
+#include <algorithm>
+
+using namespace emscripten;
+
+namespace koidice {
+
+// 相似度低于该值的牌堆不作为建议
+static constexpr double MIN_SIMILARITY = 0.3;
+
+struct DeckRegistry {
+    std::vector<DeckEntry> entries;
+    std::unordered_map<std::string, DeckId> ids;
+    std::unordered_map<uint64_t, std::vector<DeckId>> grams;  // n-gram -> 含该 n-gram 的牌堆
+    std::vector<DeckId> sorted;                               // 存在的牌堆：普通在前、扩展在后，各按名称排序
+    std::string listing;
+    size_t seenDecks = SIZE_MAX;                              // 上次同步时各来源的牌堆名总数
+    bool sortedDirty = true;
+    bool listingDirty = true;
+};
+
+static DeckRegistry& getRegistry() {
+    static DeckRegistry registry;
+    return registry;
+}
+
+// ============ n-gram ============
+
+static void decodeCodepoints(std::string_view text, std::vector<uint32_t>& out) {
+    out.clear();
+    size_t i = 0;
+    while (i < text.size()) {
+        uint8_t c = static_cast<uint8_t>(text[i]);
+        uint32_t cp;
+        size_t len;
+        if (c < 0x80) {
+            cp = (c >= 'A' && c <= 'Z') ? c + 32 : c;
+            len = 1;
+        } else if ((c & 0xE0) == 0xC0) {
+            cp = c & 0x1F;
+            len = 2;
+        } else if ((c & 0xF0) == 0xE0) {
+            cp = c & 0x0F;
+            len = 3;
+        } else {
+            cp = c & 0x07;
+            len = 4;
+        }
+        for (size_t k = 1; k < len && i + k < text.size(); k++) {
+            cp = (cp << 6) | (static_cast<uint8_t>(text[i + k]) & 0x3F);
+        }
+        out.push_back(cp);
+        i += len;
+    }
+}
+
+static bool isWideCodepoint(uint32_t cp) {
+    return cp >= 0x2E80;
+}
+
+// 码点各占 21 位，直接拼成键，不会冲突；0 作为首尾边界
+static uint64_t gramKey(uint32_t a, uint32_t b, uint32_t c) {
+    return (static_cast<uint64_t>(a) << 42) | (static_cast<uint64_t>(b) << 21) | c;
+}
+
+/**
+ * 名称的 n-gram 集合（已去重）
+ * 以 CJK 字符开头的位置取二元组，其余位置取三元组，首尾补边界
+ */
+static void collectGrams(std::string_view name, std::vector<uint64_t>& out) {
+    std::vector<uint32_t> cps;
+    decodeCodepoints(name, cps);
+    out.clear();
+    if (cps.empty()) {
+        return;
+    }
+
+    // 头部边界：^x
+    out.push_back(gramKey(0, 0, cps[0]));
+    for (size_t i = 0; i < cps.size(); i++) {
+        uint32_t next = i + 1 < cps.size() ? cps[i + 1] : 0;
+        if (isWideCodepoint(cps[i])) {
+            out.push_back(gramKey(0, cps[i], next));
+        } else {
+            uint32_t after = i + 2 < cps.size() ? cps[i + 2] : 0;
+            out.push_back(gramKey(cps[i], next, after));
+        }
+    }
+
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+}
+
+// ============ 同步 ============
+
+// 各来源的牌堆名总数（同名牌堆重复计数，只用于察觉增删）
+static size_t countSourceDecks() {
+    return CardDeck::mPublicDeck.size() + CardDeck::mExternPublicDeck.size() + getPackDeckCount();
+}
+
+static DeckId internInRegistry(DeckRegistry& registry, const std::string& name) {
+    auto [it, inserted] = registry.ids.try_emplace(name, static_cast<DeckId>(registry.entries.size()));
+    if (inserted) {
+        DeckEntry entry;
+        entry.name = name;
+        registry.entries.push_back(std::move(entry));
+    }
+    return it->second;
+}
+
+static void formatLine(DeckEntry& entry) {
+    entry.line = "- " + entry.name + (entry.isExtern ? " [扩展] (" : " (") +
+                 std::to_string(entry.source.size()) + "张)\n";
+}
+
+// 根据源表更新单个条目；牌堆出现或消失时标记排序失效
+static void updateEntry(DeckRegistry& registry, DeckEntry& entry, DeckId id) {
+    DeckSource source;
+    bool isExtern = false;
+
+    auto it = CardDeck::mPublicDeck.find(entry.name);
+    if (it != CardDeck::mPublicDeck.end()) {
+        source.strings = &it->second;
+    } else if ((source.pooled = findPackDeck(entry.name))) {
+        isExtern = true;
+    } else {
+        it = CardDeck::mExternPublicDeck.find(entry.name);
+        if (it != CardDeck::mExternPublicDeck.end()) {
+            source.strings = &it->second;
+            isExtern = true;
+        }
+    }
+
+    if (static_cast<bool>(source) != static_cast<bool>(entry.source) || isExtern != entry.isExtern) {
+        registry.sortedDirty = true;
+    }
+    entry.source = source;
+    entry.isExtern = isExtern;
+    registry.listingDirty = true;
+
+    if (!source) {
+        entry.line.clear();
+        return;
+    }
+    formatLine(entry);
+
+    if (!entry.indexed) {
+        std::vector<uint64_t> keys;
+        collectGrams(entry.name, keys);
+        for (uint64_t key : keys) {
+            registry.grams[key].push_back(id);
+        }
+        entry.indexed = true;
+    }
+}
+
+static void resync(DeckRegistry& registry) {
+    for (const auto& [name, deck] : CardDeck::mPublicDeck) {
+        internInRegistry(registry, name);
+    }
+    for (const auto& [name, deck] : CardDeck::mExternPublicDeck) {
+        internInRegistry(registry, name);
+    }
+    forEachPackDeckName([&registry](const std::string& name) {
+        internInRegistry(registry, name);
+    });
+    for (size_t id = 0; id < registry.entries.size(); id++) {
+        updateEntry(registry, registry.entries[id], static_cast<DeckId>(id));
+    }
+    registry.seenDecks = countSourceDecks();
+    registry.sortedDirty = true;
+}
+
+// 牌堆数量变化时重新同步（O(1) 检查）
+static DeckRegistry& syncedRegistry() {
+    DeckRegistry& registry = getRegistry();
+    if (registry.seenDecks != countSourceDecks()) {
+        resync(registry);
+    }
+    return registry;
+}
+
+static const std::vector<DeckId>& sortedDecks(DeckRegistry& registry) {
+    if (registry.sortedDirty) {
+        registry.sorted.clear();
+        for (size_t id = 0; id < registry.entries.size(); id++) {
+            if (registry.entries[id].source) {
+                registry.sorted.push_back(static_cast<DeckId>(id));
+            }
+        }
+        std::sort(registry.sorted.begin(), registry.sorted.end(), [&registry](DeckId a, DeckId b) {
+            const DeckEntry& x = registry.entries[a];
+            const DeckEntry& y = registry.entries[b];
+            if (x.isExtern != y.isExtern) {
+                return !x.isExtern;
+            }
+            return x.name < y.name;
+        });
+        registry.sortedDirty = false;
+    }
+    return registry.sorted;
+}
+
+// ============ 查询 ============
+
+DeckId internDeckName(const std::string& name) {
+    return internInRegistry(syncedRegistry(), name);
+}
+
+DeckId findDeckId(const std::string& name) {
+    DeckRegistry& registry = syncedRegistry();
+    auto it = registry.ids.find(name);
+    if (it == registry.ids.end() || !registry.entries[it->second].source) {
+        return INVALID_DECK;
+    }
+    return it->second;
+}
+
+const DeckEntry* getDeckEntry(DeckId id) {
+    DeckRegistry& registry = syncedRegistry();
+    return id < registry.entries.size() ? &registry.entries[id] : nullptr;
+}
+
+void notifyDeckChanged(const std::string& name) {
+    DeckRegistry& registry = getRegistry();
+    if (registry.seenDecks == SIZE_MAX) {
+        resync(registry);
+        return;
+    }
+
+    // 只更新该条目，不因牌堆数量变化触发全量同步
+    DeckId id = internInRegistry(registry, name);
+    updateEntry(registry, registry.entries[id], id);
+    registry.seenDecks = countSourceDecks();
+}
+
+void refreshDeckRegistry() {
+    resync(getRegistry());
+}
+
+std::vector<std::string> findSimilarDecks(const std::string& query, size_t limit) {
+    DeckRegistry& registry = syncedRegistry();
+    std::vector<std::string> result;
+
+    std::vector<uint64_t> keys;
+    collectGrams(query, keys);
+    if (keys.empty() || limit == 0) {
+        return result;
+    }
+
+    // 统计每个牌堆与查询共有的 n-gram 数
+    std::unordered_map<DeckId, uint32_t> shared;
+    for (uint64_t key : keys) {
+        auto it = registry.grams.find(key);
+        if (it == registry.grams.end()) {
+            continue;
+        }
+        for (DeckId id : it->second) {
+            shared[id]++;
+        }
+    }
+
+    std::vector<std::pair<double, DeckId>> scored;
+    std::vector<uint64_t> deckKeys;
+    for (const auto& [id, count] : shared) {
+        const DeckEntry& entry = registry.entries[id];
+        if (!entry.source) {
+            continue;
+        }
+        // Dice 系数：2|A∩B| / (|A| + |B|)
+        collectGrams(entry.name, deckKeys);
+        double score = 2.0 * count / static_cast<double>(keys.size() + deckKeys.size());
+        // 查询是牌堆名的一部分时至少视为相似
+        if (entry.name.find(query) != std::string::npos) {
+            score = std::max(score, 0.5);
+        }
+        if (score >= MIN_SIMILARITY) {
+            scored.emplace_back(score, id);
+        }
+    }
+
+    std::sort(scored.begin(), scored.end(), [&registry](const auto& a, const auto& b) {
+        if (a.first != b.first) {
+            return a.first > b.first;
+        }
+        return registry.entries[a.second].name < registry.entries[b.second].name;
+    });
+
+    for (size_t i = 0; i < scored.size() && i < limit; i++) {
+        result.push_back(registry.entries[scored[i].second].name);
+    }
+    return result;
+}
+
+std::vector<std::string> findDecksByPrefix(const std::string& prefix, size_t limit) {
+    DeckRegistry& registry = syncedRegistry();
+    const std::vector<DeckId>& sorted = sortedDecks(registry);
+    std::vector<std::string> result;
+
+    // 普通牌堆与扩展牌堆分别有序，各做一次二分
+    auto partition = std::partition_point(sorted.begin(), sorted.end(), [&registry](DeckId id) {
+        return !registry.entries[id].isExtern;
+    });
+    auto byName = [&registry](DeckId id, const std::string& key) {
+        return registry.entries[id].name < key;
+    };
+
+    for (auto [first, last] : {std::make_pair(sorted.begin(), partition),
+                               std::make_pair(partition, sorted.end())}) {
+        for (auto it = std::lower_bound(first, last, prefix, byName); it != last; ++it) {
+            const std::string& name = registry.entries[*it].name;
+            if (result.size() >= limit || name.compare(0, prefix.size(), prefix) != 0) {
+                break;
+            }
+            result.push_back(name);
+        }
+    }
+
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+const std::string& getDeckListing() {
+    DeckRegistry& registry = syncedRegistry();
+    if (registry.listingDirty) {
+        const std::vector<DeckId>& sorted = sortedDecks(registry);
+        registry.listing.clear();
+        if (!sorted.empty()) {
+            registry.listing = "=== 可用牌堆 ===\n";
+            for (DeckId id : sorted) {
+                registry.listing += registry.entries[id].line;
+            }
+        }
+        registry.listingDirty = false;
+    }
+    return registry.listing;
+}
+
+static val toStringArray(const std::vector<std::string>& items) {
+    val array = val::array();
+    for (size_t i = 0; i < items.size(); i++) {
+        array.set(i, items[i]);
+    }
+    return array;
+}
+
+val suggestDecks(const std::string& query, int limit) {
+    try {
+        return toStringArray(findSimilarDecks(query, limit > 0 ? static_cast<size_t>(limit) : 0));
+    } catch (...) {
+        return val::array();
+    }
+}
+
+val listDecksByPrefix(const std::string& prefix, int limit) {
+    try {
+        return toStringArray(findDecksByPrefix(prefix, limit > 0 ? static_cast<size_t>(limit) : 0));
+    } catch (...) {
+        return val::array();
+    }
+}
+
+} // namespace koidice
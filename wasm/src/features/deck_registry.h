@@ -0,0 +1,82 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <emscripten/val.h>
+#include "../core/string_pool.h"
+
+namespace koidice {
+
+// 牌堆ID（牌堆名登记后固定，牌堆删除后重新加载仍使用同一ID）
+using DeckId = uint32_t;
+constexpr DeckId INVALID_DECK = UINT32_MAX;
+
+/**
+ * 源牌堆
+ * 来自 Dice 的牌堆表（std::string）或牌堆包存储（共享字符串池中的ID）
+ */
+struct DeckSource {
+    const std::vector<std::string>* strings = nullptr;
+    const std::vector<PooledStringId>* pooled = nullptr;
+
+    explicit operator bool() const { return strings || pooled; }
+    size_t size() const { return strings ? strings->size() : pooled ? pooled->size() : 0; }
+    std::string_view at(size_t i) const {
+        return strings ? std::string_view((*strings)[i]) : getPooledString((*pooled)[i]);
+    }
+
+    // 数据地址（用于判断源牌堆是否被替换）
+    const void* data() const {
+        return strings ? static_cast<const void*>(strings->data())
+                       : pooled ? static_cast<const void*>(pooled->data()) : nullptr;
+    }
+};
+
+// 登记的牌堆
+struct DeckEntry {
+    std::string name;
+    DeckSource source;                                 // 当前源牌堆，不存在时为空
+    bool isExtern = false;                             // 来自扩展牌堆或牌堆包
+    bool indexed = false;                              // 名称已加入 n-gram 索引
+    std::string line;                                  // 牌堆列表中的一行
+};
+
+/**
+ * 牌堆注册表
+ * 统一 mPublicDeck、牌堆包与 mExternPublicDeck（按此优先级），一次哈希查找得到牌堆ID与源牌堆；
+ * 牌堆数量变化时自动重新同步，原地替换或修改牌堆的一方需调用 notifyDeckChanged
+ */
+
+// 登记牌堆名（牌堆不存在也会分配ID，供模板引用等提前解析）
+DeckId internDeckName(const std::string& name);
+
+// 查找存在的牌堆，不存在时返回 INVALID_DECK
+DeckId findDeckId(const std::string& name);
+
+// 牌堆条目（ID 无效时返回 nullptr；条目的 source 为空表示牌堆当前不存在）
+const DeckEntry* getDeckEntry(DeckId id);
+
+// 单个牌堆被增加、删除或修改后更新注册表
+void notifyDeckChanged(const std::string& name);
+
+// 全量重新同步（批量加载牌堆后调用）
+void refreshDeckRegistry();
+
+/**
+ * 相似牌堆名（“你是不是要找”）
+ * 按名称的 n-gram 重合度排序：ASCII 用三元组，CJK 用二元组
+ */
+std::vector<std::string> findSimilarDecks(const std::string& query, size_t limit);
+
+// 前缀匹配的牌堆名（按名称排序）
+std::vector<std::string> findDecksByPrefix(const std::string& prefix, size_t limit);
+
+// 牌堆列表文本（缓存，牌堆变化后才重新拼接）
+const std::string& getDeckListing();
+
+// 导出给 JS
+emscripten::val suggestDecks(const std::string& query, int limit = 5);
+emscripten::val listDecksByPrefix(const std::string& prefix, int limit = 20);
+
+} // namespace koidice
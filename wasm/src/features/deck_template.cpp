@@ -0,0 +1,240 @@
+#include "deck_template.h"
+
+namespace koidice {
+
+// ============ 解析 ============
+
+static void pushLiteral(CompiledTemplate& tpl, std::string_view text) {
+    if (text.empty()) {
+        return;
+    }
+    TemplateSegment segment;
+    segment.text = text;
+    tpl.segments.push_back(std::move(segment));
+}
+
+static std::unique_ptr<CompiledTemplate> compileTemplate(std::string_view content) {
+    auto tpl = std::make_unique<CompiledTemplate>();
+
+    size_t literalStart = 0;
+    size_t i = 0;
+    while (i < content.size()) {
+        char c = content[i];
+
+        // 转义：\{ 与 \[ 作为普通字符输出；去掉反斜杠后已不是原文，不能走字面快速路径
+        if (c == '\\' && i + 1 < content.size() && (content[i + 1] == '{' || content[i + 1] == '[')) {
+            pushLiteral(*tpl, content.substr(literalStart, i - literalStart));
+            tpl->literal = false;
+            literalStart = i + 1;
+            i += 2;
+            continue;
+        }
+
+        if (c != '{' && c != '[') {
+            i++;
+            continue;
+        }
+
+        size_t close = content.find(c == '{' ? '}' : ']', i + 1);
+        if (close == std::string_view::npos) {
+            break;
+        }
+
+        std::string_view inner = content.substr(i + 1, close - i - 1);
+        bool putBack = c == '{' && !inner.empty() && inner[0] == '%';
+        if (putBack) {
+            inner.remove_prefix(1);
+        }
+        if (inner.empty()) {
+            i = close + 1;
+            continue;  // {}、{%} 与 [] 按字面文本处理
+        }
+
+        TemplateSegment segment;
+        segment.text = content.substr(i, close - i + 1);
+        segment.putBack = putBack;
+        if (c == '{') {
+            segment.kind = TemplateSegment::Kind::Deck;
+            segment.deckId = internDeckName(std::string(inner));
+        } else {
+            segment.kind = TemplateSegment::Kind::Expression;
+            segment.program = DiceProgram::compile(std::string(inner));
+        }
+
+        pushLiteral(*tpl, content.substr(literalStart, i - literalStart));
+        tpl->segments.push_back(std::move(segment));
+        tpl->literal = false;
+        i = close + 1;
+        literalStart = i;
+    }
+
+    pushLiteral(*tpl, content.substr(literalStart));
+    return tpl;
+}
+
+static std::vector<std::unique_ptr<CompiledTemplate>>& getTemplateCache() {
+    static std::vector<std::unique_ptr<CompiledTemplate>> cache;
+    return cache;
+}
+
+const CompiledTemplate& getCompiledTemplate(DeckContentId id) {
+    auto& cache = getTemplateCache();
+    if (id >= cache.size()) {
+        cache.resize(static_cast<size_t>(id) + 1);
+    }
+    uint32_t generation = getPooledStringGeneration(id);
+    if (!cache[id] || cache[id]->generation != generation) {
+        // 字符串池中的文本在释放前地址固定，片段可以直接引用
+        cache[id] = compileTemplate(getDeckContent(id));
+        cache[id]->generation = generation;
+    }
+    return *cache[id];
+}
+
+// ============ 预算 ============
+
+static TemplateLimits currentLimits;
+
+void setTemplateLimits(const TemplateLimits& limits) {
+    currentLimits = limits;
+}
+
+const TemplateLimits& getTemplateLimits() {
+    return currentLimits;
+}
+
+void setDeckTemplateLimits(int maxDepth, int maxOutputBytes, int maxExpansions) {
+    if (maxDepth > 0) {
+        currentLimits.maxDepth = static_cast<uint32_t>(maxDepth);
+    }
+    if (maxOutputBytes > 0) {
+        currentLimits.maxOutputBytes = static_cast<uint32_t>(maxOutputBytes);
+    }
+    if (maxExpansions > 0) {
+        currentLimits.maxExpansions = static_cast<uint32_t>(maxExpansions);
+    }
+}
+
+// ============ 展开 ============
+
+TemplateExpander::TemplateExpander(SecureRandomBuffer& rng) : rng(rng) {}
+
+// 追加文本，超出字节预算时在 UTF-8 字符边界截断
+bool TemplateExpander::append(std::string& out, std::string_view text) {
+    size_t budget = currentLimits.maxOutputBytes;
+    if (out.size() + text.size() <= budget) {
+        out.append(text);
+        return true;
+    }
+
+    size_t room = budget > out.size() ? budget - out.size() : 0;
+    while (room > 0 && (static_cast<uint8_t>(text[room]) & 0xC0) == 0x80) {
+        room--;
+    }
+    out.append(text.substr(0, room));
+    hitLimit = true;
+    return false;
+}
+
+const DeckWeights& TemplateExpander::weightsOf(const CompiledDeck* deck) {
+    if (deck->dynamicWeights.empty()) {
+        return *deck;
+    }
+
+    auto& table = rolled[deck];
+    if (!table) {
+        table = std::make_unique<DeckWeights>();
+        rollDeckWeights(*deck, *table);
+    }
+    return *table;
+}
+
+size_t TemplateExpander::pick(const CompiledDeck* deck, bool putBack) {
+    const DeckWeights& table = weightsOf(deck);
+    if (putBack) {
+        return table.aliasTable.sample(rng);
+    }
+
+    auto& pool = pools[deck];
+    if (!pool || pool->remaining() == 0) {
+        pool = std::make_unique<FenwickSampler>(table.weightTree);
+    }
+    return pool->drawOne(rng);
+}
+
+std::string TemplateExpander::expand(DeckContentId card, const CompiledDeck* owner) {
+    const CompiledTemplate& root = getCompiledTemplate(card);
+    if (root.literal) {
+        std::string out;
+        append(out, getDeckContent(card));
+        return out;
+    }
+
+    const TemplateLimits& limits = currentLimits;
+    std::string out;
+    uint32_t expansions = 0;
+
+    stack.clear();
+    stack.push_back({&root, 0, owner});
+
+    while (!stack.empty()) {
+        Frame& frame = stack.back();
+        if (frame.next == frame.tpl->segments.size()) {
+            stack.pop_back();
+            continue;
+        }
+        const TemplateSegment& segment = frame.tpl->segments[frame.next++];
+
+        if (segment.kind == TemplateSegment::Kind::Literal) {
+            if (!append(out, segment.text)) {
+                break;
+            }
+            continue;
+        }
+
+        if (segment.kind == TemplateSegment::Kind::Expression) {
+            int total = 0;
+            std::string detail;
+            bool ok = segment.program.roll(rng, total, detail) == 0;
+            if (!append(out, ok ? std::string_view(std::to_string(total)) : segment.text)) {
+                break;
+            }
+            continue;
+        }
+
+        // 牌堆引用：不存在的牌堆原样保留（与 Dice 一致）
+        const CompiledDeck* deck = getCompiledDeck(segment.deckId);
+        if (!deck || deck->contents.empty()) {
+            if (!append(out, segment.text)) {
+                break;
+            }
+            continue;
+        }
+
+        bool cyclic = false;
+        for (const Frame& active : stack) {
+            if (active.deck == deck) {
+                cyclic = true;
+                break;
+            }
+        }
+
+        if (cyclic || stack.size() > limits.maxDepth || ++expansions > limits.maxExpansions) {
+            hitLimit = true;
+            if (!append(out, segment.text)) {
+                break;
+            }
+            continue;
+        }
+
+        size_t index = pick(deck, segment.putBack);
+        const CompiledTemplate& child = getCompiledTemplate(deck->contents[index]);
+        // frame 在 push_back 后可能失效，之后不再使用
+        stack.push_back({&child, 0, deck});
+    }
+
+    stack.clear();
+    return out;
+}
+
+} // namespace koidice
@@ -0,0 +1,89 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <cstdint>
+#include "deck_compiler.h"
+#include "../core/dice_program.h"
+#include "../core/utils.h"
+
+namespace koidice {
+
+/**
+ * 牌面模板片段
+ * 牌面文本预先切分为字面文本、牌堆引用（{牌堆} / {%牌堆}）与掷骰表达式（[1d6]）
+ */
+struct TemplateSegment {
+    enum class Kind : uint8_t { Literal, Deck, Expression };
+
+    Kind kind = Kind::Literal;
+    bool putBack = false;      // {%牌堆}：有放回抽取
+    std::string_view text;     // 字面文本；引用与表达式为原文，无法展开时原样输出
+    DeckId deckId = INVALID_DECK;  // 引用的牌堆（解析时登记，展开时不再按名称查找）
+    DiceProgram program;       // 掷骰表达式
+};
+
+// 预解析的牌面（按内容ID缓存，同一文本只解析一次）
+struct CompiledTemplate {
+    std::vector<TemplateSegment> segments;
+    bool literal = true;       // 不含任何引用与表达式
+    uint32_t generation = 0;   // 解析时内容ID的代数，ID 被回收复用后重新解析
+};
+
+const CompiledTemplate& getCompiledTemplate(DeckContentId id);
+
+// 展开预算
+struct TemplateLimits {
+    uint32_t maxDepth = 16;            // 嵌套引用层数
+    uint32_t maxOutputBytes = 8192;    // 单张牌展开后的字节数
+    uint32_t maxExpansions = 1024;     // 单张牌内展开的引用总数
+};
+
+void setTemplateLimits(const TemplateLimits& limits);
+const TemplateLimits& getTemplateLimits();
+
+/**
+ * 牌面展开器
+ * 用显式栈代替递归展开嵌套牌堆引用，受层数、字节数与引用次数预算约束；
+ * 引用当前展开链上已有的牌堆视为循环，原样保留引用文本。
+ * 同一展开器内 {牌堆} 的无放回抽取共享牌池（抽完后重置），与 Dice 一次抽牌的行为一致
+ */
+class TemplateExpander {
+public:
+    explicit TemplateExpander(SecureRandomBuffer& rng);
+
+    /**
+     * 展开一张牌
+     * @param card 牌面内容ID
+     * @param owner 牌所在的牌堆（参与循环检测，可为 nullptr）
+     * @return 展开后的文本
+     */
+    std::string expand(DeckContentId card, const CompiledDeck* owner);
+
+    // 是否有牌面因预算或循环引用未完整展开
+    bool limited() const { return hitLimit; }
+
+private:
+    struct Frame {
+        const CompiledTemplate* tpl;
+        size_t next;
+        const CompiledDeck* deck;
+    };
+
+    bool append(std::string& out, std::string_view text);
+    size_t pick(const CompiledDeck* deck, bool putBack);
+    const DeckWeights& weightsOf(const CompiledDeck* deck);
+
+    SecureRandomBuffer& rng;
+    std::vector<Frame> stack;
+    std::unordered_map<const CompiledDeck*, std::unique_ptr<FenwickSampler>> pools;
+    std::unordered_map<const CompiledDeck*, std::unique_ptr<DeckWeights>> rolled;  // 动态权重，每个展开器求值一次
+    bool hitLimit = false;
+};
+
+// 设置展开预算（导出给 JS，非正数表示保持原值）
+void setDeckTemplateLimits(int maxDepth, int maxOutputBytes, int maxExpansions);
+
+} // namespace koidice
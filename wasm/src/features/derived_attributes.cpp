@@ -0,0 +1,266 @@
+#include "derived_attributes.h"
+#include "../core/attribute_alias.h"
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+using namespace emscripten;
+
+namespace koidice {
+
+namespace {
+
+// 公式声明；输入名以 '?' 开头表示可选输入
+struct FormulaSpec {
+    const char* target;
+    std::array<const char*, 4> inputs;
+    int (*compute)(const int* in);
+    std::string (*format)(const int* in);
+    bool initialOnly;
+};
+
+int coc7Build(int strSiz) {
+    if (strSiz <= 64) return -2;
+    if (strSiz <= 84) return -1;
+    if (strSiz <= 124) return 0;
+    if (strSiz <= 164) return 1;
+    if (strSiz <= 204) return 2;
+    return 3 + (strSiz - 205) / 80;
+}
+
+// 移动力：力量、敏捷均小于体型为 7，均大于体型为 9，否则为 8；40 岁起每 10 年 -1
+int coc7Move(const int* in) {
+    int str = in[0], dex = in[1], siz = in[2], age = in[3];
+    int mov = 8;
+    if (dex < siz && str < siz) mov = 7;
+    else if (dex > siz && str > siz) mov = 9;
+
+    if (age >= 40) {
+        mov -= std::min(5, (age - 30) / 10);
+    }
+    return mov;
+}
+
+// 百分制数值上限为 99（COC6 属性可达 21，×5 后会超过 100）
+int percentile(int value) {
+    return std::min(99, value);
+}
+
+int dndModifier(int score) {
+    // 向下取整的 (score - 10) / 2
+    int diff = score - 10;
+    return diff >= 0 ? diff / 2 : -((1 - diff) / 2);
+}
+
+const FormulaSpec COC7_FORMULAS[] = {
+    {"生命", {"体质", "体型"}, [](const int* in) { return (in[0] + in[1]) / 10; }, nullptr, false},
+    {"魔法", {"意志"}, [](const int* in) { return in[0] / 5; }, nullptr, false},
+    {"理智", {"意志"}, [](const int* in) { return in[0]; }, nullptr, true},
+    {"体格", {"力量", "体型"}, [](const int* in) { return coc7Build(in[0] + in[1]); }, nullptr, false},
+    {"移动力", {"力量", "敏捷", "体型", "?年龄"}, coc7Move, nullptr, false},
+    {"伤害加值", {"体格"}, [](const int* in) { return in[0]; },
+     [](const int* in) { return getDamageBonusCOC7(in[0]); }, false},
+};
+
+const FormulaSpec COC6_FORMULAS[] = {
+    {"理智", {"意志"}, [](const int* in) { return percentile(in[0] * 5); }, nullptr, true},
+    {"灵感", {"智力"}, [](const int* in) { return percentile(in[0] * 5); }, nullptr, false},
+    {"幸运", {"意志"}, [](const int* in) { return percentile(in[0] * 5); }, nullptr, true},
+    {"知识", {"教育"}, [](const int* in) { return percentile(in[0] * 5); }, nullptr, false},
+    {"生命", {"体质", "体型"}, [](const int* in) { return (in[0] + in[1] + 1) / 2; }, nullptr, false},
+    {"魔法", {"意志"}, [](const int* in) { return in[0]; }, nullptr, false},
+    {"伤害加值", {"力量", "体型"}, [](const int* in) { return in[0] + in[1]; },
+     [](const int* in) { return getDamageBonusCOC6(in[0] + in[1]); }, false},
+};
+
+const FormulaSpec DND_FORMULAS[] = {
+    {"力量调整", {"力量"}, [](const int* in) { return dndModifier(in[0]); }, nullptr, false},
+    {"敏捷调整", {"敏捷"}, [](const int* in) { return dndModifier(in[0]); }, nullptr, false},
+    {"体质调整", {"体质"}, [](const int* in) { return dndModifier(in[0]); }, nullptr, false},
+    {"智力调整", {"智力"}, [](const int* in) { return dndModifier(in[0]); }, nullptr, false},
+    {"感知调整", {"感知"}, [](const int* in) { return dndModifier(in[0]); }, nullptr, false},
+    {"魅力调整", {"魅力"}, [](const int* in) { return dndModifier(in[0]); }, nullptr, false},
+};
+
+template <size_t N>
+std::vector<FormulaSpec> toVector(const FormulaSpec (&specs)[N]) {
+    return std::vector<FormulaSpec>(specs, specs + N);
+}
+
+int findColumn(const CharacterLayout& layout, const std::string& name) {
+    for (size_t k = 0; k < layout.columns.size(); k++) {
+        if (layout.columns[k] == name) return static_cast<int>(k);
+    }
+    return -1;
+}
+
+} // namespace
+
+std::string getDamageBonusCOC7(int build) {
+    if (build <= 0) return std::to_string(build);
+    if (build == 1) return "+1D4";
+    return "+" + std::to_string(build - 1) + "D6";
+}
+
+std::string getDamageBonusCOC6(int strSiz) {
+    if (strSiz <= 12) return "-1D6";
+    if (strSiz <= 16) return "-1D4";
+    if (strSiz <= 24) return "0";
+    if (strSiz <= 32) return "+1D4";
+    if (strSiz <= 40) return "+1D6";
+    // 41 起每 16 点加 1D6：41-56 +2D6，57-72 +3D6 ...
+    return "+" + std::to_string(1 + (strSiz - 41) / 16 + 1) + "D6";
+}
+
+DerivedAttributeGraph::DerivedAttributeGraph(CharacterSystem system) {
+    std::vector<FormulaSpec> specs;
+    switch (system) {
+        case CharacterSystem::COC6: specs = toVector(COC6_FORMULAS); break;
+        case CharacterSystem::DND: specs = toVector(DND_FORMULAS); break;
+        default: specs = toVector(COC7_FORMULAS); break;
+    }
+
+    if (specs.size() > 32) {
+        throw std::logic_error("派生属性公式过多");
+    }
+
+    const CharacterLayout& layout = getCharacterLayout(system);
+
+    for (size_t i = 0; i < specs.size(); i++) {
+        const FormulaSpec& spec = specs[i];
+        Node node;
+        node.target = internAttribute(spec.target);
+        node.compute = spec.compute;
+        node.format = spec.format;
+        node.initialOnly = spec.initialOnly;
+        node.targetColumn = spec.format ? -1 : findColumn(layout, spec.target);
+
+        for (const char* input : spec.inputs) {
+            if (!input) break;
+            bool optional = input[0] == '?';
+            std::string name = optional ? input + 1 : input;
+            AttributeId id = internAttribute(name);
+
+            // 声明顺序即拓扑序：输入不能是后声明公式的目标
+            for (size_t j = i; j < specs.size(); j++) {
+                if (!specs[j].initialOnly && name == specs[j].target) {
+                    throw std::logic_error("派生属性公式顺序错误: " + name);
+                }
+            }
+
+            node.inputs.push_back(id);
+            node.optional.push_back(optional ? 1 : 0);
+            node.inputColumns.push_back(findColumn(layout, name));
+            dependents[id] |= 1u << i;
+        }
+
+        nodes.push_back(std::move(node));
+    }
+}
+
+const DerivedAttributeGraph& DerivedAttributeGraph::forSystem(CharacterSystem system) {
+    static const DerivedAttributeGraph coc7(CharacterSystem::COC7);
+    static const DerivedAttributeGraph coc6(CharacterSystem::COC6);
+    static const DerivedAttributeGraph dnd(CharacterSystem::DND);
+
+    switch (system) {
+        case CharacterSystem::COC6: return coc6;
+        case CharacterSystem::DND: return dnd;
+        default: return coc7;
+    }
+}
+
+void DerivedAttributeGraph::evaluateRecord(int32_t* record) const {
+    int in[8];
+    for (const Node& node : nodes) {
+        if (node.targetColumn < 0) {
+            continue;
+        }
+
+        bool complete = true;
+        for (size_t k = 0; k < node.inputColumns.size() && complete; k++) {
+            int column = node.inputColumns[k];
+            in[k] = column >= 0 ? record[column] : 0;
+            complete = column >= 0 || node.optional[k] != 0;
+        }
+        if (complete) {
+            record[node.targetColumn] = node.compute(in);
+        }
+    }
+}
+
+val derivedChangesToJS(const std::vector<DerivedChange>& changes) {
+    val result = val::array();
+    for (size_t i = 0; i < changes.size(); i++) {
+        const DerivedChange& change = changes[i];
+        val item = val::object();
+        item.set("attr", getAttributeName(change.id));
+        if (change.hadOldValue) {
+            item.set("oldValue", change.oldValue);
+        }
+        item.set("newValue", change.newValue);
+        if (!change.text.empty()) {
+            item.set("text", change.text);
+        }
+        result.set(i, item);
+    }
+    return result;
+}
+
+val updateDerivedAttributes(const std::string& system, const val& attributes, const val& changedNames) {
+    val result = val::object();
+
+    try {
+        CharacterSystem sys;
+        if (!parseCharacterSystem(system, sys)) {
+            result.set("success", false);
+            result.set("errorMsg", "不支持的体系: " + system);
+            return result;
+        }
+
+        std::vector<AttributeId> changed;
+        int length = changedNames["length"].as<int>();
+        for (int i = 0; i < length; i++) {
+            AttributeId id = findResolvedAttributeId(changedNames[i].as<std::string>());
+            if (id != INVALID_ATTRIBUTE) {
+                changed.push_back(id);
+            }
+        }
+
+        std::unordered_map<AttributeId, int> updated;
+        val changedValues = val::object();
+        auto get = [&](AttributeId id, int& value) {
+            auto it = updated.find(id);
+            if (it != updated.end()) {
+                value = it->second;
+                return true;
+            }
+            val current = attributes[getAttributeName(id)];
+            if (!current.isNumber()) return false;
+            value = current.as<int>();
+            return true;
+        };
+        auto set = [&](AttributeId id, int value) {
+            updated[id] = value;
+            changedValues.set(getAttributeName(id), value);
+        };
+
+        std::vector<DerivedChange> changes;
+        DerivedAttributeGraph::forSystem(sys).update(changed, get, set, changes);
+
+        result.set("success", true);
+        result.set("derived", derivedChangesToJS(changes));
+        result.set("attributes", changedValues);
+        result.set("errorMsg", "");
+    } catch (const std::exception& e) {
+        result.set("success", false);
+        result.set("errorMsg", std::string("异常: ") + e.what());
+    } catch (...) {
+        result.set("success", false);
+        result.set("errorMsg", "未知异常");
+    }
+
+    return result;
+}
+
+} // namespace koidice
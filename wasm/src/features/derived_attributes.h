@@ -0,0 +1,142 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+#include <algorithm>
+#include <emscripten/val.h>
+#include "character.h"
+#include "../core/attribute_registry.h"
+
+namespace koidice {
+
+/**
+ * 派生属性的一次变化
+ */
+struct DerivedChange {
+    AttributeId id;
+    bool hadOldValue;
+    int oldValue;
+    int newValue;
+    std::string text;  // 文本形式的值（如伤害加值 "+1D4"），数值属性为空
+};
+
+/**
+ * 派生属性依赖图
+ * 每个体系声明一组公式（目标属性、输入属性、计算函数），按声明顺序即为拓扑序；
+ * 更新时只重新计算输入发生变化的公式，结果变化后再沿依赖传播；
+ * 本次被显式修改的派生属性保持用户给出的值
+ */
+class DerivedAttributeGraph {
+public:
+    // 获取体系对应的依赖图（首次调用时构建）
+    static const DerivedAttributeGraph& forSystem(CharacterSystem system);
+
+    /**
+     * 计算生成结果中的派生属性（含仅在建卡时计算的项，如初始理智）
+     * @param record 按 getCharacterLayout(system) 布局的角色记录
+     */
+    void evaluateRecord(int32_t* record) const;
+
+    /**
+     * 增量更新
+     * @param changed 本次被修改的属性ID
+     * @param get bool(AttributeId, int&)，读取当前值，不存在时返回 false
+     * @param set void(AttributeId, int)，写入新值
+     * @param out 输出：发生变化的派生属性
+     */
+    template <typename Get, typename Set>
+    void update(const std::vector<AttributeId>& changed, Get&& get, Set&& set,
+                std::vector<DerivedChange>& out) const;
+
+private:
+    struct Node {
+        AttributeId target;
+        std::vector<AttributeId> inputs;
+        std::vector<uint8_t> optional;  // 可选输入缺失时按 0 计算
+        int (*compute)(const int* in);
+        std::string (*format)(const int* in);  // 非空时为文本属性，不写回数值
+        bool initialOnly;                       // 仅建卡时计算（如理智的初始值）
+        int targetColumn;                       // 在生成布局中的列，-1 表示不在布局中
+        std::vector<int> inputColumns;
+    };
+
+    explicit DerivedAttributeGraph(CharacterSystem system);
+
+    uint32_t dependentsOf(AttributeId id) const {
+        auto it = dependents.find(id);
+        return it == dependents.end() ? 0 : it->second;
+    }
+
+    std::vector<Node> nodes;
+    std::unordered_map<AttributeId, uint32_t> dependents;  // 属性 -> 读取它的公式位掩码
+};
+
+template <typename Get, typename Set>
+void DerivedAttributeGraph::update(const std::vector<AttributeId>& changed, Get&& get, Set&& set,
+                                   std::vector<DerivedChange>& out) const {
+    uint32_t dirty = 0;
+    for (AttributeId id : changed) {
+        dirty |= dependentsOf(id);
+    }
+
+    int in[8];
+    for (size_t i = 0; i < nodes.size() && dirty != 0; i++) {
+        const Node& node = nodes[i];
+        if (node.initialOnly || !(dirty & (1u << i))) {
+            continue;
+        }
+
+        // 本次被显式修改的属性不再覆盖（如同时设定体质与生命）
+        if (std::find(changed.begin(), changed.end(), node.target) != changed.end()) {
+            continue;
+        }
+
+        bool complete = true;
+        for (size_t k = 0; k < node.inputs.size() && complete; k++) {
+            if (!get(node.inputs[k], in[k])) {
+                in[k] = 0;
+                complete = node.optional[k] != 0;
+            }
+        }
+        if (!complete) {
+            continue;
+        }
+
+        DerivedChange change{node.target, false, 0, node.compute(in), ""};
+        if (node.format) {
+            change.text = node.format(in);
+            out.push_back(std::move(change));
+            continue;
+        }
+
+        change.hadOldValue = get(node.target, change.oldValue);
+        if (change.hadOldValue && change.oldValue == change.newValue) {
+            continue;
+        }
+        set(node.target, change.newValue);
+        dirty |= dependentsOf(node.target);
+        out.push_back(std::move(change));
+    }
+}
+
+// COC7 伤害加值（由体格计算）
+std::string getDamageBonusCOC7(int build);
+
+// COC6 伤害加值（由力量+体型计算）
+std::string getDamageBonusCOC6(int strSiz);
+
+// 转换派生属性变化为 JS 数组 Array<{ attr, oldValue?, newValue, text? }>
+emscripten::val derivedChangesToJS(const std::vector<DerivedChange>& changes);
+
+/**
+ * 按修改过的属性增量更新派生属性
+ * @param system 体系名称（COC7 / COC6 / DND）
+ * @param attributes JS对象 { 属性名: 数值 }，当前属性表（应已包含本次修改）
+ * @param changedNames JS数组，本次修改的属性名
+ * @return JS对象 { success, derived, attributes, errorMsg }，attributes 为变化的派生数值属性
+ */
+emscripten::val updateDerivedAttributes(const std::string& system, const emscripten::val& attributes,
+                                        const emscripten::val& changedNames);
+
+} // namespace koidice
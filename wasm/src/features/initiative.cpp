@@ -1,55 +1,635 @@
 #include "initiative.h"
 #include "../core/utils.h"
+#include "../core/binary_codec.h"
+#include "../core/channel_state_table.h"
 #include "../../../Dice/Dice/RD.h"
 #include "../../../Dice/Dice/Jsonio.h"
 #include <algorithm>
+#include <iterator>
 #include <sstream>
 
 using namespace emscripten;
 
 namespace koidice {
 
-// 全局先攻列表存储（按频道ID）
-static std::map<std::string, InitiativeList> initiativeLists;
+// 插队时相邻 sub 之间的间隔，用尽后对同组条目重新编号
+static constexpr int64_t SUB_GAP = int64_t(1) << 32;
 
-InitiativeList* getInitiativeListInternal(const std::string& channelId) {
-    auto it = initiativeLists.find(channelId);
-    if (it != initiativeLists.end()) {
-        return &it->second;
+// ============ InitiativeList ============
+
+InitiativeList::Key InitiativeList::keyOf(uint32_t slot) const {
+    const InitiativeEntry& e = slots[slot];
+    return Key{e.initiative, e.tiebreak, e.seq, e.sub, &byName.find(e.name)->first, slot};
+}
+
+uint32_t InitiativeList::currentSlot() const {
+    if (order.empty()) {
+        return NONE;
     }
-    return nullptr;
+    return turn == NONE ? order.begin()->slot : turn;
 }
 
-InitiativeList* createInitiativeList(const std::string& channelId) {
-    InitiativeList list;
-    list.currentRound = 1;
-    list.currentIndex = 0;
-    initiativeLists[channelId] = list;
-    return &initiativeLists[channelId];
+uint32_t InitiativeList::slotOf(const std::string& name) const {
+    auto it = byName.find(name);
+    return it == byName.end() ? NONE : it->second;
 }
 
-val addInitiative(const std::string& channelId, const std::string& name, int initiative) {
-    val result = val::object();
+uint32_t InitiativeList::allocSlot(const std::string& name) {
+    uint32_t slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        slot = static_cast<uint32_t>(slots.size());
+        slots.emplace_back();
+        positions.emplace_back();
+    }
+    slots[slot].name = name;
+    byName.emplace(name, slot);
+    return slot;
+}
 
-    try {
-        InitiativeList* list = getInitiativeListInternal(channelId);
-        if (!list) {
-            list = createInitiativeList(channelId);
+void InitiativeList::link(uint32_t slot) {
+    positions[slot] = order.insert(keyOf(slot)).first;
+    dirty.insert(slot);
+}
+
+void InitiativeList::unlink(uint32_t slot) {
+    order.erase(positions[slot]);
+}
+
+// 条目即将离开行动顺序：如果轮到它，回合交给后继（越过末尾即进入下一轮）
+void InitiativeList::passTurn(uint32_t slot) {
+    if (turn != slot) {
+        return;
+    }
+    auto next = std::next(positions[slot]);
+    if (next == order.end()) {
+        next = order.begin();
+        if (next->slot == slot) {
+            turn = NONE;
+            return;
+        }
+        ++currentRound;
+    }
+    turn = next->slot;
+}
+
+// 取一个排在 slot 之前、又不越过其前驱的 sub 值
+int64_t InitiativeList::subBefore(uint32_t slot) {
+    auto pos = positions[slot];
+    const Key key = *pos;
+    auto sameGroup = [&key](const Key& k) {
+        return k.initiative == key.initiative && k.tiebreak == key.tiebreak && k.seq == key.seq;
+    };
+
+    if (pos == order.begin() || !sameGroup(*std::prev(pos))) {
+        return key.sub - SUB_GAP;
+    }
+
+    int64_t prevSub = std::prev(pos)->sub;
+    if (key.sub - prevSub > 1) {
+        return prevSub + (key.sub - prevSub) / 2;
+    }
+
+    // 间隔用尽：整组重新编号后再取
+    auto first = pos;
+    while (first != order.begin() && sameGroup(*std::prev(first))) {
+        --first;
+    }
+    auto last = pos;
+    while (last != order.end() && sameGroup(*last)) {
+        ++last;
+    }
+    std::vector<uint32_t> group;
+    for (auto it = first; it != last; ++it) {
+        group.push_back(it->slot);
+    }
+    order.erase(first, last);
+    for (size_t i = 0; i < group.size(); i++) {
+        slots[group[i]].sub = static_cast<int64_t>(i) * SUB_GAP;
+        link(group[i]);
+    }
+    return subBefore(slot);
+}
+
+const InitiativeEntry* InitiativeList::find(const std::string& name) const {
+    uint32_t slot = slotOf(name);
+    return slot == NONE ? nullptr : &slots[slot];
+}
+
+void InitiativeList::upsert(const std::string& name, int initiative, int tiebreak) {
+    uint32_t slot = slotOf(name);
+    if (slot != NONE) {
+        InitiativeEntry& e = slots[slot];
+        if (!e.delayed) {
+            unlink(slot);
+        }
+        e.initiative = initiative;
+        e.tiebreak = tiebreak;
+        e.sub = 0;
+        if (e.delayed) {
+            dirty.insert(slot);
+        } else {
+            link(slot);
         }
+        return;
+    }
+
+    slot = allocSlot(name);
+    InitiativeEntry& e = slots[slot];
+    e.initiative = initiative;
+    e.tiebreak = tiebreak;
+    e.seq = nextSeq++;
+    e.sub = 0;
+    e.delayed = false;
+    link(slot);
+}
+
+bool InitiativeList::update(const std::string& name, int initiative) {
+    uint32_t slot = slotOf(name);
+    if (slot == NONE) {
+        return false;
+    }
+    upsert(name, initiative, slots[slot].tiebreak);
+    return true;
+}
 
+void InitiativeList::insertBatch(const std::vector<InitiativeEntry>& entries) {
+    const uint64_t firstSeq = nextSeq;
+    std::vector<uint32_t> fresh;
+    fresh.reserve(entries.size());
+
+    for (const InitiativeEntry& entry : entries) {
+        uint32_t slot = slotOf(entry.name);
+        if (slot == NONE) {
+            slot = allocSlot(entry.name);
+            InitiativeEntry& e = slots[slot];
+            e.initiative = entry.initiative;
+            e.tiebreak = entry.tiebreak;
+            e.seq = nextSeq++;
+            e.sub = 0;
+            e.delayed = false;
+            fresh.push_back(slot);
+        } else if (slots[slot].seq >= firstSeq && !slots[slot].delayed) {
+            // 本批内重名：尚未插入排序集合，直接覆盖
+            slots[slot].initiative = entry.initiative;
+            slots[slot].tiebreak = entry.tiebreak;
+        } else {
+            upsert(entry.name, entry.initiative, entry.tiebreak);
+        }
+    }
+
+    std::vector<Key> keys;
+    keys.reserve(fresh.size());
+    for (uint32_t slot : fresh) {
+        keys.push_back(keyOf(slot));
+    }
+    std::sort(keys.begin(), keys.end());
+
+    auto hint = order.begin();
+    for (const Key& key : keys) {
+        hint = std::next(positions[key.slot] = order.insert(hint, key));
+        dirty.insert(key.slot);
+    }
+}
+
+bool InitiativeList::remove(const std::string& name) {
+    uint32_t slot = slotOf(name);
+    if (slot == NONE) {
+        return false;
+    }
+    if (!slots[slot].delayed) {
+        passTurn(slot);
+        unlink(slot);
+    }
+    removed.insert(name);
+    dirty.erase(slot);
+    timers.removeTarget(name);
+    byName.erase(name);
+    slots[slot] = InitiativeEntry();
+    freeSlots.push_back(slot);
+    return true;
+}
+
+bool InitiativeList::delay(const std::string& name) {
+    uint32_t slot = slotOf(name);
+    if (slot == NONE || slots[slot].delayed) {
+        return false;
+    }
+    passTurn(slot);
+    unlink(slot);
+    slots[slot].delayed = true;
+    dirty.insert(slot);
+    return true;
+}
+
+bool InitiativeList::ready(const std::string& name) {
+    uint32_t slot = slotOf(name);
+    if (slot == NONE || !slots[slot].delayed) {
+        return false;
+    }
+
+    InitiativeEntry& e = slots[slot];
+    uint32_t cur = currentSlot();
+    if (cur != NONE) {
+        // 接过当前行动者的先攻位置，排在它之前
+        const InitiativeEntry& target = slots[cur];
+        e.initiative = target.initiative;
+        e.tiebreak = target.tiebreak;
+        e.seq = target.seq;
+        e.sub = subBefore(cur);
+    }
+    e.delayed = false;
+    link(slot);
+    turn = slot;
+    return true;
+}
+
+const InitiativeEntry* InitiativeList::advance() {
+    if (order.empty()) {
+        return nullptr;
+    }
+    auto it = turn == NONE ? order.begin() : positions[turn];
+    ++it;
+    if (it == order.end()) {
+        it = order.begin();
+        ++currentRound;
+    }
+    turn = it->slot;
+    return &slots[turn];
+}
+
+const InitiativeEntry* InitiativeList::current() const {
+    uint32_t cur = currentSlot();
+    return cur == NONE ? nullptr : &slots[cur];
+}
+
+int InitiativeList::currentIndex() const {
+    if (turn == NONE) {
+        return 0;
+    }
+    return static_cast<int>(std::distance(order.begin(), OrderSet::const_iterator(positions[turn])));
+}
+
+void InitiativeList::setCurrentIndex(int index) {
+    if (index <= 0 || index >= static_cast<int>(order.size())) {
+        turn = NONE;
+        return;
+    }
+    turn = std::next(order.begin(), index)->slot;
+}
+
+size_t InitiativeList::memoryBytes() const {
+    // 容器节点按 libc++/libstdc++ 的典型布局估算：红黑树节点三指针加颜色，哈希节点一指针加缓存的哈希值
+    auto heapString = [](const std::string& text) {
+        return text.capacity() > 15 ? text.capacity() + 1 : 0;
+    };
+    size_t bytes = sizeof(InitiativeList);
+    bytes += slots.capacity() * sizeof(InitiativeEntry);
+    bytes += positions.capacity() * sizeof(OrderSet::iterator);
+    bytes += freeSlots.capacity() * sizeof(uint32_t);
+    bytes += order.size() * (sizeof(Key) + 4 * sizeof(void*));
+    bytes += byName.bucket_count() * sizeof(void*);
+    bytes += byName.size() * (sizeof(std::string) + sizeof(uint32_t) + 2 * sizeof(void*));
+    for (const auto& [name, slot] : byName) {
+        bytes += heapString(name) + heapString(slots[slot].name);
+    }
+    bytes += dirty.bucket_count() * sizeof(void*) + dirty.size() * (sizeof(uint32_t) + 2 * sizeof(void*));
+    bytes += removed.bucket_count() * sizeof(void*);
+    for (const std::string& name : removed) {
+        bytes += sizeof(std::string) + 2 * sizeof(void*) + heapString(name);
+    }
+    bytes += ConditionTracker::WHEEL_SIZE * sizeof(std::unordered_map<std::string, std::vector<uint32_t>>);
+    timers.forEach([&](const Condition& condition) {
+        bytes += sizeof(Condition) + 4 * sizeof(void*) + sizeof(uint32_t) * 2 + heapString(condition.target) +
+                 heapString(condition.label) + heapString(condition.anchor);
+    });
+    return bytes;
+}
+
+void InitiativeList::restore(const InitiativeEntry& entry) {
+    uint32_t slot = slotOf(entry.name);
+    if (slot == NONE) {
+        slot = allocSlot(entry.name);
+    } else if (!slots[slot].delayed) {
+        passTurn(slot);
+        unlink(slot);
+    }
+
+    InitiativeEntry& e = slots[slot];
+    e.initiative = entry.initiative;
+    e.tiebreak = entry.tiebreak;
+    e.seq = entry.seq;
+    e.sub = entry.sub;
+    e.delayed = entry.delayed;
+    if (e.delayed) {
+        dirty.insert(slot);
+    } else {
+        link(slot);
+    }
+    nextSeq = std::max(nextSeq, entry.seq + 1);
+}
+
+const std::string& InitiativeList::currentName() const {
+    static const std::string none;
+    return turn == NONE ? none : slots[turn].name;
+}
+
+void InitiativeList::setCurrentName(const std::string& name) {
+    uint32_t slot = slotOf(name);
+    turn = (slot == NONE || slots[slot].delayed) ? NONE : slot;
+}
+
+void InitiativeList::clearChanges() {
+    dirty.clear();
+    removed.clear();
+    timers.clearChanged();
+}
+
+bool InitiativeList::actsLaterThisRound(const std::string& name) const {
+    uint32_t slot = slotOf(name);
+    if (slot == NONE) {
+        return false;
+    }
+    if (slots[slot].delayed) {
+        return true;
+    }
+    uint32_t cur = currentSlot();
+    return cur != slot && keyOf(cur) < keyOf(slot);
+}
+
+void InitiativeList::collectExpired(std::vector<ConditionEvent>& expired) {
+    const InitiativeEntry* cur = current();
+    timers.sync(currentRound, cur ? cur->name : std::string(), expired);
+}
+
+// ============ 二进制编码 ============
+
+static const char SNAPSHOT_MAGIC[4] = {'K', 'D', 'I', 'N'};
+static const char DELTA_MAGIC[4] = {'K', 'D', 'I', 'D'};
+static constexpr uint8_t SNAPSHOT_VERSION = 2;   // 2: 追加状态效果计时器
+static constexpr size_t MAX_NAME_BYTES = 1024;
+static constexpr uint64_t MAX_ENTRIES = 65536;
+
+static constexpr uint8_t ENTRY_DELAYED = 0x01;
+
+static void writeEntry(ByteWriter& writer, const InitiativeEntry& entry) {
+    writer.str(entry.name);
+    writer.svarint(entry.initiative);
+    writer.svarint(entry.tiebreak);
+    writer.varint(entry.seq);
+    writer.svarint(entry.sub);
+    writer.u8(entry.delayed ? ENTRY_DELAYED : 0);
+}
+
+static bool readInt(ByteReader& reader, int& value) {
+    int64_t wide;
+    if (!reader.svarint(wide) || wide < INT32_MIN || wide > INT32_MAX) {
+        return false;
+    }
+    value = static_cast<int>(wide);
+    return true;
+}
+
+static bool readEntry(ByteReader& reader, InitiativeEntry& entry) {
+    uint8_t flags = 0;
+    if (!reader.str(entry.name, MAX_NAME_BYTES) || entry.name.empty() ||
+        !readInt(reader, entry.initiative) || !readInt(reader, entry.tiebreak) ||
+        !reader.varint(entry.seq) || !reader.svarint(entry.sub) || !reader.u8(flags)) {
+        return false;
+    }
+    entry.delayed = (flags & ENTRY_DELAYED) != 0;
+    return true;
+}
+
+// 快照与增量共用的头部：轮数、当前行动者、下一个加入序号
+static void writeHeader(ByteWriter& writer, const char (&magic)[4], const InitiativeList& list) {
+    writer.raw(magic, sizeof(magic));
+    writer.u8(SNAPSHOT_VERSION);
+    writer.svarint(list.currentRound);
+    writer.str(list.currentName());
+    writer.varint(list.sequence());
+}
+
+struct InitiativeHeader {
+    uint8_t version = 0;
+    int round = 1;
+    std::string current;
+    uint64_t sequence = 0;
+};
+
+static bool readHeader(ByteReader& reader, const char (&magic)[4], InitiativeHeader& header) {
+    return reader.expect(magic, sizeof(magic)) && reader.u8(header.version) &&
+           header.version >= 1 && header.version <= SNAPSHOT_VERSION && readInt(reader, header.round) &&
+           reader.str(header.current, MAX_NAME_BYTES) && reader.varint(header.sequence);
+}
+
+static std::vector<uint8_t> encodeSnapshot(const InitiativeList& list) {
+    ByteWriter writer;
+    writeHeader(writer, SNAPSHOT_MAGIC, list);
+    writer.varint(list.size());
+    list.forEachInOrder([&](const InitiativeEntry& entry, bool) { writeEntry(writer, entry); });
+    list.forEachDelayed([&](const InitiativeEntry& entry) { writeEntry(writer, entry); });
+    list.conditions().encode(writer);
+    return writer.data();
+}
+
+static std::vector<uint8_t> encodeDelta(const InitiativeList& list) {
+    ByteWriter writer;
+    writeHeader(writer, DELTA_MAGIC, list);
+    writer.varint(list.removedNames().size());
+    for (const std::string& name : list.removedNames()) {
+        writer.str(name);
+    }
+    size_t changed = 0;
+    list.forEachChanged([&](const InitiativeEntry&) { changed++; });
+    writer.varint(changed);
+    list.forEachChanged([&](const InitiativeEntry& entry) { writeEntry(writer, entry); });
+    // 效果通常很少，有变化时整体写出
+    writer.u8(list.conditions().changed() ? 1 : 0);
+    if (list.conditions().changed()) {
+        list.conditions().encode(writer);
+    }
+    return writer.data();
+}
+
+static bool decodeSnapshot(const std::vector<uint8_t>& bytes, InitiativeList& list) {
+    ByteReader reader(bytes.data(), bytes.size());
+    InitiativeHeader header;
+    uint64_t count = 0;
+    if (!readHeader(reader, SNAPSHOT_MAGIC, header) || !reader.varint(count) || count > MAX_ENTRIES) {
+        return false;
+    }
+    for (uint64_t i = 0; i < count; i++) {
         InitiativeEntry entry;
-        entry.name = name;
-        entry.initiative = initiative;
+        if (!readEntry(reader, entry)) {
+            return false;
+        }
+        list.restore(entry);
+    }
+    if (header.version >= 2 && !list.conditions().decode(reader)) {
+        return false;
+    }
+    if (!reader.atEnd()) {
+        return false;
+    }
+    list.currentRound = header.round;
+    list.setSequence(header.sequence);
+    list.setCurrentName(header.current);
+    list.clearChanges();
+    return true;
+}
+
+// 增量先解码到临时结构，整体校验通过后才修改列表
+static bool decodeDelta(const std::vector<uint8_t>& bytes, InitiativeList& list) {
+    ByteReader reader(bytes.data(), bytes.size());
+    InitiativeHeader header;
+    uint64_t removedCount = 0, changedCount = 0;
+    if (!readHeader(reader, DELTA_MAGIC, header) || !reader.varint(removedCount) ||
+        removedCount > MAX_ENTRIES) {
+        return false;
+    }
+    std::vector<std::string> removedNames(static_cast<size_t>(removedCount));
+    for (std::string& name : removedNames) {
+        if (!reader.str(name, MAX_NAME_BYTES)) {
+            return false;
+        }
+    }
+    if (!reader.varint(changedCount) || changedCount > MAX_ENTRIES) {
+        return false;
+    }
+    std::vector<InitiativeEntry> changed(static_cast<size_t>(changedCount));
+    for (InitiativeEntry& entry : changed) {
+        if (!readEntry(reader, entry)) {
+            return false;
+        }
+    }
+    uint8_t hasConditions = 0;
+    ConditionTracker timers;
+    if (header.version >= 2 && (!reader.u8(hasConditions) || (hasConditions && !timers.decode(reader)))) {
+        return false;
+    }
+    if (!reader.atEnd()) {
+        return false;
+    }
+
+    for (const std::string& name : removedNames) {
+        list.remove(name);
+    }
+    for (const InitiativeEntry& entry : changed) {
+        list.restore(entry);
+    }
+    if (hasConditions) {
+        list.conditions() = std::move(timers);
+    }
+    list.currentRound = header.round;
+    list.setSequence(header.sequence);
+    list.setCurrentName(header.current);
+    list.clearChanges();
+    return true;
+}
+
+// ============ 频道先攻列表 ============
+
+// 自上次导出以来有变更（或被清空）的频道
+static std::set<std::string> dirtyChannels;
+
+// 有未导出变更却被逐出、且宿主没有接收的频道快照；下次导出或访问时取回
+static std::unordered_map<std::string, std::string> spilledSnapshots;
+
+// 变更日志已不完整（经快照重新载入），下次导出必须给完整快照
+static std::unordered_set<std::string> snapshotPending;
+
+// 宿主是否通过 flushInitiativeChanges 消费变更；没有消费者时清空的频道无需记录 "removed"
+static bool changeConsumer = false;
+
+// 宿主提供的逐出 / 载入回调
+static val evictionHandler = val::undefined();
+static val loadHandler = val::undefined();
+
+static bool isHandler(const val& handler) {
+    return !handler.isUndefined() && !handler.isNull();
+}
 
-        list->entries.push_back(entry);
+static void spillInitiative(const std::string& channelId, InitiativeList& list, EvictReason reason) {
+    std::string snapshot = base64Encode(encodeSnapshot(list));
+    if (isHandler(evictionHandler)) {
+        try {
+            evictionHandler(channelId, snapshot,
+                            std::string(reason == EvictReason::Capacity ? "capacity" : "expired"));
+            // 宿主拿到了完整状态，之前未导出的变更一并交付
+            dirtyChannels.erase(channelId);
+            snapshotPending.erase(channelId);
+            return;
+        } catch (...) {
+        }
+    }
+    if (dirtyChannels.count(channelId)) {
+        spilledSnapshots[channelId] = std::move(snapshot);
+    }
+}
+
+static bool reloadInitiative(const std::string& channelId, InitiativeList& list) {
+    std::string snapshot;
+    auto spilled = spilledSnapshots.find(channelId);
+    if (spilled != spilledSnapshots.end()) {
+        snapshot = std::move(spilled->second);
+        spilledSnapshots.erase(spilled);
+        snapshotPending.insert(channelId);
+    } else if (isHandler(loadHandler)) {
+        try {
+            val stored = loadHandler(channelId);
+            if (!stored.isString()) {
+                return false;
+            }
+            snapshot = stored.as<std::string>();
+        } catch (...) {
+            return false;
+        }
+    } else {
+        return false;
+    }
 
-        std::sort(list->entries.begin(), list->entries.end(),
-                 [](const InitiativeEntry& a, const InitiativeEntry& b) {
-                     return a.initiative > b.initiative;
-                 });
+    std::vector<uint8_t> bytes;
+    return base64Decode(snapshot, bytes) && decodeSnapshot(bytes, list);
+}
+
+// 全局先攻列表存储（按频道ID，LRU/空闲超时逐出）
+static ChannelStateTable<InitiativeList>& initiativeTable() {
+    static ChannelStateTable<InitiativeList> table = [] {
+        ChannelStateTable<InitiativeList> t;
+        t.setEvictHandler(spillInitiative);
+        t.setLoadHandler(reloadInitiative);
+        return t;
+    }();
+    return table;
+}
+
+InitiativeList* getInitiativeListInternal(const std::string& channelId) {
+    return initiativeTable().find(channelId);
+}
+
+InitiativeList* createInitiativeList(const std::string& channelId) {
+    return &initiativeTable().obtain(channelId);
+}
+
+static void markChannelDirty(const std::string& channelId) {
+    dirtyChannels.insert(channelId);
+}
+
+val addInitiative(const std::string& channelId, const std::string& name, int initiative) {
+    val result = val::object();
+
+    try {
+        InitiativeList* list = createInitiativeList(channelId);
+
+        bool existed = list->find(name) != nullptr;
+        list->upsert(name, initiative);
+        markChannelDirty(channelId);
 
         result.set("success", true);
-        result.set("message", "添加成功");
+        result.set("message", existed ? "更新成功" : "添加成功");
 
     } catch (const std::exception& e) {
         result.set("success", false);
@@ -102,77 +682,246 @@ val rollInitiative(const std::string& channelId, const std::string& name, int mo
     return result;
 }
 
-bool removeInitiative(const std::string& channelId, const std::string& name) {
-    InitiativeList* list = getInitiativeListInternal(channelId);
-    if (!list) {
-        return false;
-    }
+// 单次批量检定的条目上限
+static constexpr int MAX_INITIATIVE_BATCH = 200;
+
+static const char* const INITIATIVE_BATCH_COLUMNS[] = {"roll", "modifier", "initiative", "tiebreak"};
+static constexpr size_t INITIATIVE_BATCH_STRIDE =
+    sizeof(INITIATIVE_BATCH_COLUMNS) / sizeof(INITIATIVE_BATCH_COLUMNS[0]);
+
+val rollInitiativeBatch(const std::string& channelId, const val& groups) {
+    ensureRandomInit();
+    val result = val::object();
+
+    try {
+        struct Group {
+            std::string name;
+            int count;
+            int modifier;
+            int tiebreak;
+        };
+
+        // 先校验并统计总数，任何一组不合法都不改动列表
+        int groupCount = groups["length"].as<int>();
+        std::vector<Group> parsed;
+        parsed.reserve(groupCount);
+        int total = 0;
+        for (int i = 0; i < groupCount; i++) {
+            val group = groups[i];
+            val nameValue = group["name"];
+            val countValue = group["count"];
+            val modifierValue = group["modifier"];
+            val tiebreakValue = group["tiebreak"];
+
+            Group g;
+            g.name = nameValue.isString() ? nameValue.as<std::string>() : "";
+            g.count = countValue.isNumber() ? countValue.as<int>() : 1;
+            g.modifier = modifierValue.isNumber() ? modifierValue.as<int>() : 0;
+            g.tiebreak = tiebreakValue.isNumber() ? tiebreakValue.as<int>() : g.modifier;
+            if (g.name.empty()) {
+                result.set("success", false);
+                result.set("message", "第" + std::to_string(i + 1) + "组缺少名称");
+                return result;
+            }
+            if (g.count < 1 || g.count > MAX_INITIATIVE_BATCH) {
+                result.set("success", false);
+                result.set("message", g.name + " 的数量必须在1-" + std::to_string(MAX_INITIATIVE_BATCH) + "之间");
+                return result;
+            }
+            total += g.count;
+            if (total > MAX_INITIATIVE_BATCH) {
+                result.set("success", false);
+                result.set("message", "条目数量过多，最多" + std::to_string(MAX_INITIATIVE_BATCH) + "个");
+                return result;
+            }
+            parsed.push_back(std::move(g));
+        }
+
+        InitiativeList* list = createInitiativeList(channelId);
 
-    size_t beforeSize = list->entries.size();
+        SecureRandomBuffer rng(static_cast<size_t>(total));
+        rng.reserve(static_cast<size_t>(total));
+
+        std::vector<InitiativeEntry> entries;
+        entries.reserve(total);
+        std::unordered_set<std::string> batchNames;
+        std::vector<int32_t> table(static_cast<size_t>(total) * INITIATIVE_BATCH_STRIDE, 0);
+        val names = val::array();
+
+        for (const Group& g : parsed) {
+            int number = 1;
+            for (int k = 0; k < g.count; k++) {
+                InitiativeEntry entry;
+                if (g.count == 1) {
+                    entry.name = g.name;
+                } else {
+                    // 编号跳过列表中和本批已用的名称
+                    do {
+                        entry.name = g.name + std::to_string(number++);
+                    } while (list->find(entry.name) || batchNames.count(entry.name));
+                }
+                batchNames.insert(entry.name);
 
-    list->entries.erase(
-        std::remove_if(list->entries.begin(), list->entries.end(),
-                      [&name](const InitiativeEntry& e) { return e.name == name; }),
-        list->entries.end()
-    );
+                int roll = rng.next(1, 20);
+                entry.initiative = roll + g.modifier;
+                entry.tiebreak = g.tiebreak;
 
-    if (list->currentIndex >= static_cast<int>(list->entries.size())) {
-        list->currentIndex = 0;
+                size_t row = entries.size();
+                int32_t* cells = table.data() + row * INITIATIVE_BATCH_STRIDE;
+                cells[0] = roll;
+                cells[1] = g.modifier;
+                cells[2] = entry.initiative;
+                cells[3] = entry.tiebreak;
+                names.set(row, entry.name);
+
+                entries.push_back(std::move(entry));
+            }
+        }
+
+        list->insertBatch(entries);
+        markChannelDirty(channelId);
+
+        val columns = val::array();
+        for (size_t c = 0; c < INITIATIVE_BATCH_STRIDE; c++) {
+            columns.set(c, std::string(INITIATIVE_BATCH_COLUMNS[c]));
+        }
+
+        result.set("success", true);
+        result.set("count", total);
+        result.set("names", names);
+        result.set("columns", columns);
+        result.set("stride", static_cast<int>(INITIATIVE_BATCH_STRIDE));
+        result.set("table", toInt32Array(table.data(), table.size()));
+
+    } catch (const std::exception& e) {
+        result.set("success", false);
+        result.set("message", std::string("异常: ") + e.what());
+    } catch (...) {
+        result.set("success", false);
+        result.set("message", "未知异常");
     }
 
-    return list->entries.size() < beforeSize;
+    return result;
+}
+
+bool removeInitiative(const std::string& channelId, const std::string& name) {
+    InitiativeList* list = getInitiativeListInternal(channelId);
+    if (!list || !list->remove(name)) {
+        return false;
+    }
+    markChannelDirty(channelId);
+    return true;
 }
 
 bool clearInitiative(const std::string& channelId) {
-    auto it = initiativeLists.find(channelId);
-    if (it != initiativeLists.end()) {
-        initiativeLists.erase(it);
+    if (getInitiativeListInternal(channelId)) {
+        initiativeTable().erase(channelId);
+        spilledSnapshots.erase(channelId);
+        snapshotPending.erase(channelId);
+        if (changeConsumer) {
+            markChannelDirty(channelId);
+        } else {
+            dirtyChannels.erase(channelId);
+        }
         return true;
     }
     return false;
 }
 
+static val conditionToJS(const Condition& condition) {
+    val item = val::object();
+    item.set("id", static_cast<double>(condition.id));
+    item.set("target", condition.target);
+    item.set("label", condition.label);
+    item.set("anchor", condition.anchor);
+    item.set("expireRound", condition.expireRound);
+    item.set("duration", condition.duration);
+    return item;
+}
+
+// 填充当前行动者，并附上同步回合后到期的状态效果
+static void setCurrentTurn(val& result, InitiativeList& list, std::vector<ConditionEvent> expired = {}) {
+    list.collectExpired(expired);
+
+    const InitiativeEntry* current = list.current();
+    if (current) {
+        result.set("currentName", current->name);
+        result.set("currentInitiative", current->initiative);
+    }
+    result.set("currentRound", list.currentRound);
+
+    val events = val::array();
+    for (size_t i = 0; i < expired.size(); i++) {
+        val item = conditionToJS(expired[i].condition);
+        item.set("late", expired[i].late);
+        events.set(i, item);
+    }
+    result.set("expired", events);
+}
+
 val nextInitiativeTurn(const std::string& channelId) {
     val result = val::object();
 
     InitiativeList* list = getInitiativeListInternal(channelId);
-    if (!list || list->entries.empty()) {
+    if (!list || list->empty()) {
         result.set("success", false);
         result.set("message", "先攻列表为空");
         return result;
     }
 
-    list->currentIndex++;
+    // 先补上此前未结算的回合开始（如移除当前行动者后交出的回合）
+    std::vector<ConditionEvent> expired;
+    list->collectExpired(expired);
 
-    if (list->currentIndex >= static_cast<int>(list->entries.size())) {
-        list->currentIndex = 0;
-        list->currentRound++;
+    if (!list->advance()) {
+        result.set("success", false);
+        result.set("message", "所有角色都在延迟行动中");
+        return result;
     }
 
-    const InitiativeEntry& current = list->entries[list->currentIndex];
-
+    markChannelDirty(channelId);
     result.set("success", true);
-    result.set("currentName", current.name);
-    result.set("currentInitiative", current.initiative);
-    result.set("currentRound", list->currentRound);
+    setCurrentTurn(result, *list, std::move(expired));
 
     return result;
 }
 
 std::string getInitiativeList(const std::string& channelId) {
     InitiativeList* list = getInitiativeListInternal(channelId);
-    if (!list || list->entries.empty()) {
+    if (!list || list->empty()) {
         return "先攻列表为空";
     }
 
     std::ostringstream oss;
     oss << "=== 先攻列表 (第" << list->currentRound << "轮) ===" << std::endl;
 
-    for (size_t i = 0; i < list->entries.size(); i++) {
-        const InitiativeEntry& entry = list->entries[i];
-        std::string marker = (static_cast<int>(i) == list->currentIndex) ? "→" : " ";
-        oss << marker << " " << (i + 1) << ". " << entry.name << ": " << entry.initiative << std::endl;
-    }
+    // 角色 -> 身上的效果说明
+    std::unordered_map<std::string, std::string> effects;
+    list->conditions().forEach([&](const Condition& condition) {
+        int remaining = condition.expireRound - list->currentRound;
+        std::string& text = effects[condition.target];
+        text += " [" + condition.label + (remaining > 0 ? " 剩余" + std::to_string(remaining) + "轮]" : " 本轮]");
+    });
+    auto effectsOf = [&effects](const std::string& name) -> std::string {
+        auto it = effects.find(name);
+        return it == effects.end() ? std::string() : it->second;
+    };
+
+    size_t index = 0;
+    list->forEachInOrder([&](const InitiativeEntry& entry, bool isCurrent) {
+        std::string marker = isCurrent ? "→" : " ";
+        oss << marker << " " << (++index) << ". " << entry.name << ": " << entry.initiative
+            << effectsOf(entry.name) << std::endl;
+    });
+
+    bool hasDelayed = false;
+    list->forEachDelayed([&](const InitiativeEntry& entry) {
+        if (!hasDelayed) {
+            oss << "--- 延迟行动 ---" << std::endl;
+            hasDelayed = true;
+        }
+        oss << "  " << entry.name << ": " << entry.initiative << effectsOf(entry.name) << std::endl;
+    });
 
     return oss.str();
 }
@@ -182,7 +931,198 @@ int getInitiativeCount(const std::string& channelId) {
     if (!list) {
         return 0;
     }
-    return static_cast<int>(list->entries.size());
+    return static_cast<int>(list->size());
+}
+
+// update/delay/ready 共用：找不到列表或条目时填充失败信息
+static InitiativeList* requireEntry(val& result, const std::string& channelId, const std::string& name) {
+    InitiativeList* list = getInitiativeListInternal(channelId);
+    if (!list || !list->find(name)) {
+        result.set("success", false);
+        result.set("message", "先攻列表中没有 " + name);
+        return nullptr;
+    }
+    return list;
+}
+
+val updateInitiative(const std::string& channelId, const std::string& name, int initiative) {
+    val result = val::object();
+
+    try {
+        InitiativeList* list = requireEntry(result, channelId, name);
+        if (!list) {
+            return result;
+        }
+        list->update(name, initiative);
+        markChannelDirty(channelId);
+        result.set("success", true);
+        result.set("message", "更新成功");
+        setCurrentTurn(result, *list);
+
+    } catch (const std::exception& e) {
+        result.set("success", false);
+        result.set("message", std::string("异常: ") + e.what());
+    } catch (...) {
+        result.set("success", false);
+        result.set("message", "未知异常");
+    }
+
+    return result;
+}
+
+val delayInitiative(const std::string& channelId, const std::string& name) {
+    val result = val::object();
+
+    try {
+        InitiativeList* list = requireEntry(result, channelId, name);
+        if (!list) {
+            return result;
+        }
+        if (!list->delay(name)) {
+            result.set("success", false);
+            result.set("message", name + " 已在延迟行动中");
+            return result;
+        }
+        markChannelDirty(channelId);
+        result.set("success", true);
+        result.set("message", name + " 延迟行动");
+        setCurrentTurn(result, *list);
+
+    } catch (const std::exception& e) {
+        result.set("success", false);
+        result.set("message", std::string("异常: ") + e.what());
+    } catch (...) {
+        result.set("success", false);
+        result.set("message", "未知异常");
+    }
+
+    return result;
+}
+
+val readyInitiative(const std::string& channelId, const std::string& name) {
+    val result = val::object();
+
+    try {
+        InitiativeList* list = requireEntry(result, channelId, name);
+        if (!list) {
+            return result;
+        }
+        if (!list->ready(name)) {
+            result.set("success", false);
+            result.set("message", name + " 没有在延迟行动");
+            return result;
+        }
+        markChannelDirty(channelId);
+        result.set("success", true);
+        result.set("message", name + " 结束延迟，立即行动");
+        setCurrentTurn(result, *list);
+
+    } catch (const std::exception& e) {
+        result.set("success", false);
+        result.set("message", std::string("异常: ") + e.what());
+    } catch (...) {
+        result.set("success", false);
+        result.set("message", "未知异常");
+    }
+
+    return result;
+}
+
+// ============ 状态效果 ============
+
+static constexpr size_t MAX_CONDITION_LABEL_BYTES = 256;
+static constexpr size_t MAX_CONDITIONS_PER_LIST = 1024;
+static constexpr int MAX_CONDITION_ROUNDS = 10000;
+
+val addInitiativeCondition(const std::string& channelId, const std::string& target, const std::string& label,
+                           int rounds, const std::string& anchor) {
+    val result = val::object();
+
+    try {
+        InitiativeList* list = requireEntry(result, channelId, target);
+        if (!list) {
+            return result;
+        }
+        if (label.empty() || label.size() > MAX_CONDITION_LABEL_BYTES) {
+            result.set("success", false);
+            result.set("message", "效果名称不能为空且不超过" + std::to_string(MAX_CONDITION_LABEL_BYTES) + "字节");
+            return result;
+        }
+        if (rounds < 1 || rounds > MAX_CONDITION_ROUNDS) {
+            result.set("success", false);
+            result.set("message", "持续轮数必须在1-" + std::to_string(MAX_CONDITION_ROUNDS) + "之间");
+            return result;
+        }
+        if (list->conditions().size() >= MAX_CONDITIONS_PER_LIST) {
+            result.set("success", false);
+            result.set("message", "状态效果过多，最多" + std::to_string(MAX_CONDITIONS_PER_LIST) + "个");
+            return result;
+        }
+        if (!anchor.empty() && !list->find(anchor)) {
+            result.set("success", false);
+            result.set("message", "先攻列表中没有 " + anchor);
+            return result;
+        }
+
+        // 先结算到当前回合，避免新效果落在已经过去的时间点上
+        std::vector<ConditionEvent> expired;
+        list->collectExpired(expired);
+
+        // 缺省以当前行动者计时：持续 N 轮即在第 N 次轮到参照角色时到期
+        std::string timedBy = anchor;
+        if (timedBy.empty() && list->current()) {
+            timedBy = list->current()->name;
+        }
+        int expireRound = list->currentRound + rounds;
+        if (!timedBy.empty() && list->actsLaterThisRound(timedBy)) {
+            expireRound--;
+        }
+
+        uint32_t id = list->conditions().add(target, label, timedBy, expireRound, rounds);
+        markChannelDirty(channelId);
+
+        result.set("success", true);
+        result.set("message", target + " 获得效果 " + label + "，持续" + std::to_string(rounds) + "轮");
+        result.set("id", static_cast<double>(id));
+        result.set("anchor", timedBy);
+        result.set("expireRound", expireRound);
+        setCurrentTurn(result, *list, std::move(expired));
+
+    } catch (const std::exception& e) {
+        result.set("success", false);
+        result.set("message", std::string("异常: ") + e.what());
+    } catch (...) {
+        result.set("success", false);
+        result.set("message", "未知异常");
+    }
+
+    return result;
+}
+
+bool removeInitiativeCondition(const std::string& channelId, int id) {
+    InitiativeList* list = getInitiativeListInternal(channelId);
+    if (!list || id <= 0 || !list->conditions().remove(static_cast<uint32_t>(id))) {
+        return false;
+    }
+    markChannelDirty(channelId);
+    return true;
+}
+
+val getInitiativeConditions(const std::string& channelId) {
+    val result = val::array();
+
+    InitiativeList* list = getInitiativeListInternal(channelId);
+    if (!list) {
+        return result;
+    }
+
+    int index = 0;
+    list->conditions().forEach([&](const Condition& condition) {
+        val item = conditionToJS(condition);
+        item.set("remainingRounds", condition.expireRound - list->currentRound);
+        result.set(index++, item);
+    });
+    return result;
 }
 
 std::string serializeInitiative(const std::string& channelId) {
@@ -194,14 +1134,34 @@ std::string serializeInitiative(const std::string& channelId) {
     try {
         nlohmann::json j;
         j["currentRound"] = list->currentRound;
-        j["currentIndex"] = list->currentIndex;
+        j["currentIndex"] = list->currentIndex();
         j["entries"] = nlohmann::json::array();
 
-        for (const auto& entry : list->entries) {
+        auto writeEntry = [&j](const InitiativeEntry& entry) {
             nlohmann::json entryJson;
             entryJson["name"] = entry.name;
             entryJson["initiative"] = entry.initiative;
+            if (entry.tiebreak != 0) {
+                entryJson["tiebreak"] = entry.tiebreak;
+            }
+            if (entry.delayed) {
+                entryJson["delayed"] = true;
+            }
             j["entries"].push_back(entryJson);
+        };
+        // 按行动顺序写出，读回时加入顺序即为原顺序（包括插队的位置）
+        list->forEachInOrder([&](const InitiativeEntry& entry, bool) { writeEntry(entry); });
+        list->forEachDelayed(writeEntry);
+
+        if (!list->conditions().empty()) {
+            j["conditions"] = nlohmann::json::array();
+            list->conditions().forEach([&j](const Condition& condition) {
+                j["conditions"].push_back({{"target", condition.target},
+                                           {"label", condition.label},
+                                           {"anchor", condition.anchor},
+                                           {"expireRound", condition.expireRound},
+                                           {"duration", condition.duration}});
+            });
         }
 
         return j.dump();
@@ -212,26 +1172,194 @@ std::string serializeInitiative(const std::string& channelId) {
 
 bool deserializeInitiative(const std::string& channelId, const std::string& jsonStr) {
     try {
-        nlohmann::json j = nlohmann::json::parse(jsonStr);
-
         InitiativeList list;
-        list.currentRound = j.value("currentRound", 1);
-        list.currentIndex = j.value("currentIndex", 0);
 
-        if (j.contains("entries") && j["entries"].is_array()) {
-            for (const auto& entryJson : j["entries"]) {
-                InitiativeEntry entry;
-                entry.name = entryJson.value("name", "");
-                entry.initiative = entryJson.value("initiative", 0);
-                list.entries.push_back(entry);
+        // 二进制快照为 Base64 文本，JSON 总以 '{' 开头
+        size_t start = jsonStr.find_first_not_of(" \t\r\n");
+        if (start != std::string::npos && jsonStr[start] != '{') {
+            std::vector<uint8_t> bytes;
+            if (!base64Decode(jsonStr, bytes) || !decodeSnapshot(bytes, list)) {
+                return false;
+            }
+        } else {
+            nlohmann::json j = nlohmann::json::parse(jsonStr);
+            list.currentRound = j.value("currentRound", 1);
+
+            std::vector<std::string> delayed;
+            if (j.contains("entries") && j["entries"].is_array()) {
+                for (const auto& entryJson : j["entries"]) {
+                    std::string name = entryJson.value("name", "");
+                    list.upsert(name, entryJson.value("initiative", 0), entryJson.value("tiebreak", 0));
+                    if (entryJson.value("delayed", false)) {
+                        delayed.push_back(name);
+                    }
+                }
+            }
+            for (const auto& name : delayed) {
+                list.delay(name);
+            }
+            list.setCurrentIndex(j.value("currentIndex", 0));
+
+            if (j.contains("conditions") && j["conditions"].is_array()) {
+                for (const auto& conditionJson : j["conditions"]) {
+                    std::string target = conditionJson.value("target", "");
+                    if (list.find(target)) {
+                        list.conditions().add(target, conditionJson.value("label", ""),
+                                              conditionJson.value("anchor", ""),
+                                              conditionJson.value("expireRound", list.currentRound),
+                                              conditionJson.value("duration", 1));
+                    }
+                }
             }
+            list.clearChanges();
         }
 
-        initiativeLists[channelId] = list;
+        // 载入的就是宿主已保存的状态，无需再导出
+        initiativeTable().assign(channelId, std::move(list));
+        dirtyChannels.erase(channelId);
+        spilledSnapshots.erase(channelId);
+        snapshotPending.erase(channelId);
         return true;
     } catch (...) {
         return false;
     }
 }
 
+std::string serializeInitiativeBinary(const std::string& channelId) {
+    InitiativeList* list = getInitiativeListInternal(channelId);
+    if (!list) {
+        return "";
+    }
+
+    try {
+        std::string snapshot = base64Encode(encodeSnapshot(*list));
+        list->clearChanges();
+        dirtyChannels.erase(channelId);
+        snapshotPending.erase(channelId);
+        return snapshot;
+    } catch (...) {
+        return "";
+    }
+}
+
+val flushInitiativeChanges() {
+    val result = val::array();
+    changeConsumer = true;
+
+    try {
+        int index = 0;
+        std::vector<InitiativeList*> flushed;
+        for (const std::string& channelId : dirtyChannels) {
+            val item = val::object();
+            item.set("channelId", channelId);
+
+            // 只查看驻留状态，导出不应触发载入或刷新访问时间
+            InitiativeList* list = initiativeTable().peek(channelId);
+            auto spilled = spilledSnapshots.find(channelId);
+            if (spilled != spilledSnapshots.end()) {
+                item.set("kind", std::string("snapshot"));
+                item.set("data", spilled->second);
+            } else if (!list) {
+                item.set("kind", std::string("removed"));
+                item.set("data", std::string());
+            } else if (snapshotPending.count(channelId) || list->changeCount() * 2 >= list->size()) {
+                // 大半条目都变了，增量不比快照省，直接给快照便于宿主压缩存储
+                item.set("kind", std::string("snapshot"));
+                item.set("data", base64Encode(encodeSnapshot(*list)));
+            } else {
+                item.set("kind", std::string("delta"));
+                item.set("data", base64Encode(encodeDelta(*list)));
+            }
+            if (list) {
+                flushed.push_back(list);
+            }
+            result.set(index++, item);
+        }
+
+        // 全部编码成功后才清空日志，中途失败时下次仍能完整导出
+        for (InitiativeList* list : flushed) {
+            list->clearChanges();
+        }
+        dirtyChannels.clear();
+        spilledSnapshots.clear();
+        snapshotPending.clear();
+    } catch (...) {
+        return val::array();
+    }
+
+    return result;
+}
+
+bool applyInitiativeDelta(const std::string& channelId, const std::string& delta) {
+    try {
+        std::vector<uint8_t> bytes;
+        if (!base64Decode(delta, bytes)) {
+            return false;
+        }
+        bool created = false;
+        InitiativeList* list = &initiativeTable().obtain(channelId, &created);
+        if (!decodeDelta(bytes, *list)) {
+            if (created) {
+                initiativeTable().erase(channelId);
+            }
+            return false;
+        }
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+bool isInitiativeLoaded(const std::string& channelId) {
+    initiativeTable().sweep();
+    return initiativeTable().peek(channelId) != nullptr;
+}
+
+void setInitiativeTableLimits(int maxChannels, int ttlSeconds) {
+    ChannelStateTable<InitiativeList>::Limits limits;
+    limits.maxEntries = static_cast<size_t>(std::max(1, maxChannels));
+    limits.ttlSeconds = static_cast<uint32_t>(std::max(0, ttlSeconds));
+    initiativeTable().setLimits(limits);
+}
+
+void setInitiativeEvictionHandler(val handler) {
+    evictionHandler = handler;
+}
+
+void setInitiativeLoadHandler(val handler) {
+    loadHandler = handler;
+}
+
+val getInitiativeTableStats() {
+    val result = val::object();
+
+    auto& table = initiativeTable();
+    const auto& stats = table.stats();
+    size_t entries = 0, memoryBytes = 0;
+    table.forEach([&](const std::string& channelId, const InitiativeList& list) {
+        entries += list.size();
+        memoryBytes += channelId.capacity() + list.memoryBytes();
+    });
+    size_t spilledBytes = 0;
+    for (const auto& [channelId, snapshot] : spilledSnapshots) {
+        spilledBytes += channelId.size() + snapshot.size();
+    }
+
+    result.set("channels", static_cast<double>(table.size()));
+    result.set("maxChannels", static_cast<double>(table.getLimits().maxEntries));
+    result.set("ttlSeconds", static_cast<double>(table.getLimits().ttlSeconds));
+    result.set("entries", static_cast<double>(entries));
+    result.set("memoryBytes", static_cast<double>(memoryBytes));
+    result.set("hits", static_cast<double>(stats.hits));
+    result.set("misses", static_cast<double>(stats.misses));
+    result.set("reloads", static_cast<double>(stats.reloads));
+    result.set("evictedCapacity", static_cast<double>(stats.evictedCapacity));
+    result.set("evictedExpired", static_cast<double>(stats.evictedExpired));
+    result.set("dirtyChannels", static_cast<double>(dirtyChannels.size()));
+    result.set("spilledChannels", static_cast<double>(spilledSnapshots.size()));
+    result.set("spilledBytes", static_cast<double>(spilledBytes));
+
+    return result;
+}
+
 } // namespace koidice
@@ -2,21 +2,180 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <cstdint>
+#include <algorithm>
 #include <emscripten/val.h>
+#include "condition_tracker.h"
 
 namespace koidice {
 
 // 先攻条目
 struct InitiativeEntry {
     std::string name;
-    int initiative;
+    int initiative = 0;
+    int tiebreak = 0;      // 先攻相同时较大者优先（如敏捷）
+    uint64_t seq = 0;      // 加入顺序，保证同分同优先级时顺序稳定
+    int64_t sub = 0;       // 插队（ready）时取小于目标的值，排在其之前
+    bool delayed = false;  // 延迟行动中，暂不在行动顺序内
 };
 
-// 先攻列表
-struct InitiativeList {
-    std::vector<InitiativeEntry> entries;
-    int currentRound;
-    int currentIndex;
+/**
+ * 先攻列表
+ * 行动顺序为按（先攻降序, tiebreak 降序, 加入顺序, 插队序）排序的集合，
+ * 名称索引指向条目槽，当前行动者记录为槽位而非下标，
+ * 因此在其前后插入、删除条目不会让回合指针错位；增删改均为 O(log n)
+ */
+class InitiativeList {
+public:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    int currentRound = 1;
+
+    // positions 保存的是 order 内的迭代器，只允许移动（节点容器移动后迭代器仍有效）
+    InitiativeList() = default;
+    InitiativeList(InitiativeList&&) = default;
+    InitiativeList& operator=(InitiativeList&&) = default;
+    InitiativeList(const InitiativeList&) = delete;
+    InitiativeList& operator=(const InitiativeList&) = delete;
+
+    size_t size() const { return byName.size(); }
+    bool empty() const { return byName.empty(); }
+
+    // 查找条目（不存在时返回 nullptr）
+    const InitiativeEntry* find(const std::string& name) const;
+
+    // 加入或更新（同名条目更新先攻值，保留加入顺序）
+    void upsert(const std::string& name, int initiative, int tiebreak = 0);
+    bool update(const std::string& name, int initiative);
+
+    // 批量加入：新条目按排序键排好后带位置提示插入，相邻的新条目插入为均摊 O(1)；
+    // 已有的同名条目按 upsert 更新，本批内重名以后者为准
+    void insertBatch(const std::vector<InitiativeEntry>& entries);
+    bool remove(const std::string& name);
+
+    // 延迟行动：移出行动顺序；轮到其本人时延迟则回合交给下一位
+    bool delay(const std::string& name);
+
+    // 结束延迟：插入到当前行动者之前并立即行动
+    bool ready(const std::string& name);
+
+    // 进入下一位行动者（到末尾时回到开头并进入下一轮），列表为空时返回 nullptr
+    const InitiativeEntry* advance();
+
+    // 当前行动者（尚未开始时为第一位）
+    const InitiativeEntry* current() const;
+
+    // 当前行动者在行动顺序中的下标（O(n)，用于显示与持久化）
+    int currentIndex() const;
+    void setCurrentIndex(int index);
+
+    // ---- 状态效果 ----
+
+    ConditionTracker& conditions() { return timers; }
+    const ConditionTracker& conditions() const { return timers; }
+
+    // 该角色本轮是否还会行动（排在当前行动者之后，或正在延迟）
+    bool actsLaterThisRound(const std::string& name) const;
+
+    // 把回合推进同步到效果计时器，收集到期的效果（幂等）
+    void collectExpired(std::vector<ConditionEvent>& expired);
+
+    // 估算占用的堆内存（字节）
+    size_t memoryBytes() const;
+
+    // 按行动顺序遍历；延迟中的条目单独遍历
+    template <typename F>
+    void forEachInOrder(F&& fn) const {
+        uint32_t cur = currentSlot();
+        for (const Key& key : order) {
+            fn(slots[key.slot], key.slot == cur);
+        }
+    }
+
+    template <typename F>
+    void forEachDelayed(F&& fn) const {
+        std::vector<const InitiativeEntry*> delayed;
+        for (const InitiativeEntry& entry : slots) {
+            if (entry.delayed) {
+                delayed.push_back(&entry);
+            }
+        }
+        std::sort(delayed.begin(), delayed.end(), [](const InitiativeEntry* a, const InitiativeEntry* b) {
+            return a->seq != b->seq ? a->seq < b->seq : a->name < b->name;
+        });
+        for (const InitiativeEntry* entry : delayed) {
+            fn(*entry);
+        }
+    }
+
+    // ---- 持久化 ----
+
+    // 按条目自带的排序键（seq/sub）原样恢复，用于回放快照与增量
+    void restore(const InitiativeEntry& entry);
+
+    // 当前行动者名称，尚未开始时为空
+    const std::string& currentName() const;
+    void setCurrentName(const std::string& name);
+
+    uint64_t sequence() const { return nextSeq; }
+    void setSequence(uint64_t seq) { nextSeq = seq; }
+
+    // 变更日志：自上次 clearChanges 以来被修改或移除的条目
+    bool hasChanges() const { return !dirty.empty() || !removed.empty() || timers.changed(); }
+    size_t changeCount() const { return dirty.size() + removed.size(); }
+    const std::unordered_set<std::string>& removedNames() const { return removed; }
+    void clearChanges();
+
+    template <typename F>
+    void forEachChanged(F&& fn) const {
+        for (uint32_t slot : dirty) {
+            fn(slots[slot]);
+        }
+    }
+
+private:
+    struct Key {
+        int initiative;
+        int tiebreak;
+        uint64_t seq;
+        int64_t sub;
+        const std::string* name;  // 指向 byName 中的键，rehash 后仍有效
+        uint32_t slot;
+
+        bool operator<(const Key& other) const {
+            if (initiative != other.initiative) return initiative > other.initiative;
+            if (tiebreak != other.tiebreak) return tiebreak > other.tiebreak;
+            if (seq != other.seq) return seq < other.seq;
+            if (sub != other.sub) return sub < other.sub;
+            return *name < *other.name;  // 以名称收尾，保证回放快照后顺序一致
+        }
+    };
+    using OrderSet = std::set<Key>;
+
+    Key keyOf(uint32_t slot) const;
+    uint32_t currentSlot() const;
+    uint32_t slotOf(const std::string& name) const;
+    uint32_t allocSlot(const std::string& name);
+    void link(uint32_t slot);
+    void unlink(uint32_t slot);
+    void passTurn(uint32_t slot);
+    int64_t subBefore(uint32_t slot);
+
+    std::vector<InitiativeEntry> slots;
+    std::vector<OrderSet::iterator> positions;  // 与 slots 对应，延迟或空闲时无意义
+    std::vector<uint32_t> freeSlots;
+    OrderSet order;
+    std::unordered_map<std::string, uint32_t> byName;
+    uint32_t turn = NONE;   // 当前行动者所在槽；NONE 表示尚未开始（视为第一位）
+    uint64_t nextSeq = 0;
+
+    std::unordered_set<uint32_t> dirty;       // 变更过的在用槽
+    std::unordered_set<std::string> removed;  // 已移除的名称
+
+    ConditionTracker timers;
 };
 
 // 先攻列表管理
@@ -28,8 +187,68 @@ emscripten::val nextInitiativeTurn(const std::string& channelId);
 std::string getInitiativeList(const std::string& channelId);
 int getInitiativeCount(const std::string& channelId);
 
+/**
+ * 批量先攻检定
+ * groups: [{name, count?, modifier?, tiebreak?}]，count > 1 时生成编号名称（名称1、名称2……，跳过已占用的编号），
+ * tiebreak 缺省为 modifier；全部 d20 一次预取随机数，掷完后一次并入先攻列表
+ * 返回 {success, count, names, columns, stride, table}，table 每行为 [d20, 加值, 先攻, tiebreak]
+ */
+emscripten::val rollInitiativeBatch(const std::string& channelId, const emscripten::val& groups);
+
+// 修改先攻值（保留加入顺序与当前回合）
+emscripten::val updateInitiative(const std::string& channelId, const std::string& name, int initiative);
+
+// 延迟行动 / 结束延迟并立即行动
+emscripten::val delayInitiative(const std::string& channelId, const std::string& name);
+emscripten::val readyInitiative(const std::string& channelId, const std::string& name);
+
+/**
+ * 状态效果（持续 rounds 轮）
+ * 以 anchor（缺省为当前行动者）计时，在第 rounds 次轮到 anchor 行动时到期；
+ * 到期的效果由 nextInitiativeTurn / delayInitiative / readyInitiative 等结果中的 expired 报告
+ */
+emscripten::val addInitiativeCondition(const std::string& channelId, const std::string& target,
+                                       const std::string& label, int rounds, const std::string& anchor = "");
+bool removeInitiativeCondition(const std::string& channelId, int id);
+emscripten::val getInitiativeConditions(const std::string& channelId);
+
 // 持久化
+// serializeInitiative 输出 JSON；deserializeInitiative 同时接受 JSON 与二进制快照
 std::string serializeInitiative(const std::string& channelId);
 bool deserializeInitiative(const std::string& channelId, const std::string& jsonStr);
 
+// 紧凑二进制快照（Base64），同时清空该频道的变更日志
+std::string serializeInitiativeBinary(const std::string& channelId);
+
+/**
+ * 批量导出所有有变更的频道，返回 [{channelId, kind, data}]
+ * kind 为 "delta"（自上次导出以来的增量，按顺序追加回放即可）、
+ * "snapshot"（变更较多时直接给出完整快照，可替换之前的快照与增量）
+ * 或 "removed"（列表已被清空，data 为空）
+ * 首次调用前清空的频道不记录 "removed"，宿主自行删除存储即可
+ */
+emscripten::val flushInitiativeChanges();
+
+// 在当前状态上回放一条增量（频道不存在时从空列表开始）
+bool applyInitiativeDelta(const std::string& channelId, const std::string& delta);
+
+// ============ 频道状态表 ============
+// 先攻列表按频道驻留在有界的状态表中，超出容量或空闲超时的频道会被逐出。
+// 逐出时调用宿主的 evictionHandler(channelId, snapshot, reason) 交出二进制快照；
+// 未设置或回调失败时，有未导出变更的快照暂存在模块内，由 flushInitiativeChanges 导出。
+// 再次访问被逐出的频道时，先取回暂存快照，否则调用 loadHandler(channelId) 同步载入（返回快照字符串或 undefined）
+
+// 频道当前是否驻留（不触发载入）
+bool isInitiativeLoaded(const std::string& channelId);
+
+// maxChannels 至少为 1；ttlSeconds 为 0 时不按空闲时间逐出
+void setInitiativeTableLimits(int maxChannels, int ttlSeconds);
+
+// 传入 undefined/null 取消回调
+void setInitiativeEvictionHandler(emscripten::val handler);
+void setInitiativeLoadHandler(emscripten::val handler);
+
+// 占用与命中统计
+emscripten::val getInitiativeTableStats();
+
 } // namespace koidice
@@ -1,8 +1,12 @@
 #include "insanity.h"
 #include "../core/utils.h"
+#include "../core/dice_program.h"
+#include "../core/success_table.h"
 #include "../../../Dice/Dice/RDConstant.h"
 #include "../../../Dice/Dice/RD.h"
 #include <algorithm>
+#include <unordered_map>
+#include <vector>
 
 using namespace emscripten;
 
@@ -67,115 +71,364 @@ std::string getMania(int index) {
     return strPanic[index];
 }
 
+// ============ 理智检定流水线 ============
+
+// 理智损失程序：成功/失败两侧的损失表达式各只编译一次
+struct SanityLossProgram {
+    DiceProgram success;
+    DiceProgram failure;
+    int failureMax;  // 大失败时的损失（失败损失的最大值）
+};
+
+// 单次理智检定的结果
+struct SanityOutcome {
+    int rollValue = 0;
+    int successLevel = 0;
+    int sanLoss = 0;
+    std::string lossDetail;
+    int newSan = 0;
+    int_errno errorCode = 0;
+    std::string errorMsg;
+};
+
+// 疯狂判定结果
+struct InsanityOutcome {
+    std::string type = "none";     // none / temporary / indefinite / permanent
+    bool intCheckRequired = false; // 损失达到 5 点但未提供智力
+    int intRoll = 0;
+    int symptomIndex = 0;
+    int duration = 0;
+    int detailIndex = 0;
+    std::string symptom;
+    std::string detail;
+};
+
+// 缓存上限，超过后整体清空
+static constexpr size_t MAX_CACHED_LOSS_PROGRAMS = 256;
+
+// 一次理智损失达到该值时需要进行智力检定（临时疯狂）
+static constexpr int TEMP_INSANITY_LOSS = 5;
+
+// 使用内置 COC7 判定而非房规成功等级表
+static constexpr int DEFAULT_SAN_RULE = -1;
+
+static std::unordered_map<std::string, SanityLossProgram> lossProgramCache;
+
+static const SanityLossProgram& getSanityLossProgram(const std::string& successLoss,
+                                                     const std::string& failureLoss) {
+    std::string key = successLoss + "/" + failureLoss;
+
+    auto it = lossProgramCache.find(key);
+    if (it != lossProgramCache.end()) {
+        return it->second;
+    }
+
+    if (lossProgramCache.size() >= MAX_CACHED_LOSS_PROGRAMS) {
+        lossProgramCache.clear();
+    }
+
+    SanityLossProgram program;
+    program.success = DiceProgram::compile(successLoss, 100);
+    program.failure = DiceProgram::compile(failureLoss, 100);
+    program.failureMax = program.failure.max();
+
+    return lossProgramCache.emplace(key, std::move(program)).first->second;
+}
+
+// 拆分 "成功损失/失败损失"，格式错误时返回 false
+static bool splitLossSpec(const std::string& lossSpec, std::string& successLoss, std::string& failureLoss) {
+    size_t slashPos = lossSpec.find('/');
+    if (slashPos == std::string::npos || lossSpec.find('/', slashPos + 1) != std::string::npos) {
+        return false;
+    }
+
+    successLoss = trim(lossSpec.substr(0, slashPos));
+    failureLoss = trim(lossSpec.substr(slashPos + 1));
+    return !successLoss.empty() && !failureLoss.empty();
+}
+
+// 一次完成 d100、损失掷骰与大失败最大值的计算
+static void evaluateSanity(int currentSan, const SanityLossProgram& program, int rule,
+                           SecureRandomBuffer& rng, SanityOutcome& out) {
+    out.newSan = currentSan;
+
+    if (currentSan <= 0) {
+        out.errorCode = -1;
+        out.errorMsg = "SAN值无效，必须大于0";
+        return;
+    }
+
+    out.rollValue = rng.next(1, 100);
+    out.successLevel = rule == DEFAULT_SAN_RULE
+        ? calculateSuccessLevel(out.rollValue, currentSan)
+        : getSuccessTable(rule, currentSan)[out.rollValue];
+
+    if (out.successLevel == 0) {
+        // 大失败 - 取失败损失的最大值
+        out.sanLoss = program.failureMax;
+        out.lossDetail = "Max{" + program.failure.source() + "}=" + std::to_string(out.sanLoss);
+    } else {
+        // 失败掷失败损失骰，成功（含困难、极难、大成功）掷成功损失骰
+        const DiceProgram& loss = out.successLevel == 1 ? program.failure : program.success;
+        int_errno err = loss.roll(rng, out.sanLoss, out.lossDetail);
+        if (err != 0) {
+            out.sanLoss = 0;
+            out.lossDetail.clear();
+            out.errorCode = err;
+            out.errorMsg = "损失表达式错误: " + getErrorMessage(err);
+            return;
+        }
+    }
+
+    out.sanLoss = std::max(0, out.sanLoss);
+    out.newSan = std::max(0, currentSan - out.sanLoss);
+}
+
+static void replaceAll(std::string& text, const std::string& from, const std::string& to) {
+    for (size_t pos = text.find(from); pos != std::string::npos; pos = text.find(from, pos + to.size())) {
+        text.replace(pos, from.size(), to);
+    }
+}
+
+// 抽取疯狂症状，填充 {dur}/{detail_roll}/{detail}，保留 {pc}/{nick} 由调用方替换
+static void drawInsanitySymptom(const std::string* table, SecureRandomBuffer& rng, InsanityOutcome& out) {
+    out.symptomIndex = rng.next(1, 10);
+    out.duration = rng.next(1, 10);
+    out.symptom = table[out.symptomIndex];
+    replaceAll(out.symptom, "{dur}", std::to_string(out.duration));
+
+    if (out.symptomIndex == 9 || out.symptomIndex == 10) {
+        bool phobia = out.symptomIndex == 9;
+        int sides = phobia ? 93 : 96;
+        out.detailIndex = rng.next(1, sides);
+        out.detail = phobia ? strFear[out.detailIndex] : strPanic[out.detailIndex];
+        replaceAll(out.symptom, "{detail_roll}", "1D" + std::to_string(sides) + "=" + std::to_string(out.detailIndex));
+        replaceAll(out.symptom, "{detail}", out.detail);
+    }
+}
+
+// 根据损失判定疯狂：归零为永久疯狂，单次损失达当前值 1/5 为不定性疯狂，
+// 达到 5 点时智力检定成功则陷入临时疯狂
+static void evaluateInsanity(int currentSan, const SanityOutcome& sanity, int intelligence,
+                             SecureRandomBuffer& rng, InsanityOutcome& out) {
+    if (sanity.errorCode != 0 || sanity.sanLoss <= 0) {
+        return;
+    }
+
+    if (sanity.newSan == 0) {
+        out.type = "permanent";
+        return;
+    }
+
+    if (sanity.sanLoss * 5 >= currentSan) {
+        out.type = "indefinite";
+        drawInsanitySymptom(LongInsanity, rng, out);
+        return;
+    }
+
+    if (sanity.sanLoss < TEMP_INSANITY_LOSS) {
+        return;
+    }
+
+    if (intelligence <= 0) {
+        out.intCheckRequired = true;
+        return;
+    }
+
+    out.intRoll = rng.next(1, 100);
+    if (out.intRoll <= intelligence) {
+        out.type = "temporary";
+        drawInsanitySymptom(TempInsanity, rng, out);
+    }
+}
+
+// 疯狂类型在批量结果表中的编码
+static int insanityTypeCode(const std::string& type) {
+    if (type == "temporary") return 1;
+    if (type == "indefinite") return 2;
+    if (type == "permanent") return 3;
+    return 0;
+}
+
+static void setSanityFields(val& result, const SanityOutcome& outcome) {
+    result.set("rollValue", outcome.rollValue);
+    result.set("successLevel", outcome.successLevel);
+    result.set("sanLoss", outcome.sanLoss);
+    result.set("lossDetail", outcome.lossDetail);
+    result.set("newSan", outcome.newSan);
+    result.set("errorCode", outcome.errorCode);
+    result.set("errorMsg", outcome.errorMsg);
+}
+
+static val insanityToJS(const InsanityOutcome& outcome) {
+    val insanity = val::object();
+    insanity.set("type", outcome.type);
+    insanity.set("intCheckRequired", outcome.intCheckRequired);
+    insanity.set("intRoll", outcome.intRoll);
+    insanity.set("symptomIndex", outcome.symptomIndex);
+    insanity.set("duration", outcome.duration);
+    insanity.set("symptom", outcome.symptom);
+    insanity.set("detailIndex", outcome.detailIndex);
+    insanity.set("detail", outcome.detail);
+    return insanity;
+}
+
+static void setSanityError(val& result, int currentSan, int errorCode, const std::string& errorMsg) {
+    SanityOutcome outcome;
+    outcome.newSan = currentSan;
+    outcome.errorCode = errorCode;
+    outcome.errorMsg = errorMsg;
+    setSanityFields(result, outcome);
+}
+
 val sanityCheck(int currentSan, const std::string& successLoss, const std::string& failureLoss) {
     ensureRandomInit();
     val result = val::object();
 
     try {
-        if (currentSan <= 0) {
-            result.set("rollValue", 0);
-            result.set("successLevel", 0);
-            result.set("sanLoss", 0);
-            result.set("lossDetail", "");
-            result.set("newSan", currentSan);
-            result.set("errorCode", -1);
-            result.set("errorMsg", "SAN值无效，必须大于0");
+        const SanityLossProgram& program = getSanityLossProgram(successLoss, failureLoss);
+
+        SecureRandomBuffer rng(16);
+        SanityOutcome outcome;
+        evaluateSanity(currentSan, program, DEFAULT_SAN_RULE, rng, outcome);
+        setSanityFields(result, outcome);
+
+    } catch (const std::exception& e) {
+        setSanityError(result, currentSan, -1, std::string("异常: ") + e.what());
+    } catch (...) {
+        setSanityError(result, currentSan, -1, "未知异常");
+    }
+
+    return result;
+}
+
+val sanityCheckWithInsanity(int currentSan, const std::string& lossSpec, int intelligence, int rule) {
+    ensureRandomInit();
+    val result = val::object();
+
+    try {
+        std::string successLoss, failureLoss;
+        if (!splitLossSpec(lossSpec, successLoss, failureLoss)) {
+            setSanityError(result, currentSan, -1, "损失表达式格式错误，应为 成功损失/失败损失");
+            result.set("insanity", insanityToJS(InsanityOutcome()));
             return result;
         }
 
-        // 进行1d100检定
-        RD rd("1d100", 100);
-        int_errno err = rd.Roll();
+        const SanityLossProgram& program = getSanityLossProgram(successLoss, failureLoss);
 
-        if (err != 0) {
-            result.set("rollValue", 0);
-            result.set("successLevel", 0);
-            result.set("sanLoss", 0);
-            result.set("lossDetail", "");
-            result.set("newSan", currentSan);
-            result.set("errorCode", err);
-            result.set("errorMsg", getErrorMessage(err));
+        SecureRandomBuffer rng(32);
+        SanityOutcome outcome;
+        evaluateSanity(currentSan, program, rule, rng, outcome);
+
+        InsanityOutcome insanity;
+        evaluateInsanity(currentSan, outcome, intelligence, rng, insanity);
+
+        setSanityFields(result, outcome);
+        result.set("insanity", insanityToJS(insanity));
+
+    } catch (const std::exception& e) {
+        setSanityError(result, currentSan, -1, std::string("异常: ") + e.what());
+        result.set("insanity", insanityToJS(InsanityOutcome()));
+    } catch (...) {
+        setSanityError(result, currentSan, -1, "未知异常");
+        result.set("insanity", insanityToJS(InsanityOutcome()));
+    }
+
+    return result;
+}
+
+// 批量结果表的列（每名调查员一行）
+static const char* const SANITY_BATCH_COLUMNS[] = {
+    "rollValue", "successLevel", "sanLoss", "newSan", "insanityType",
+    "intCheckRequired", "intRoll", "symptomIndex", "duration", "detailIndex", "errorCode"
+};
+static constexpr size_t SANITY_BATCH_STRIDE = sizeof(SANITY_BATCH_COLUMNS) / sizeof(SANITY_BATCH_COLUMNS[0]);
+
+// 单次批量检定的人数上限
+static constexpr int MAX_SANITY_BATCH = 100;
+
+val sanityCheckBatch(const val& investigators, const std::string& lossSpec, int defaultRule) {
+    ensureRandomInit();
+    val result = val::object();
+
+    try {
+        std::string successLoss, failureLoss;
+        if (!splitLossSpec(lossSpec, successLoss, failureLoss)) {
+            result.set("success", false);
+            result.set("errorMsg", "损失表达式格式错误，应为 成功损失/失败损失");
+            return result;
+        }
+
+        int count = investigators["length"].as<int>();
+        if (count > MAX_SANITY_BATCH) {
+            result.set("success", false);
+            result.set("errorMsg", "调查员数量过多，最多" + std::to_string(MAX_SANITY_BATCH) + "人");
             return result;
         }
 
-        int rollValue = rd.intTotal;
-
-        // 计算成功等级
-        int successLevel = calculateSuccessLevel(rollValue, currentSan, 1);
-
-        // 根据成功等级计算理智损失
-        int sanLoss = 0;
-        std::string lossDetail;
-        std::string lossExpr;
-
-        if (successLevel == 0) {
-            // 大失败 - 取失败损失的最大值
-            lossExpr = failureLoss;
-            RD maxLossRd(lossExpr, 100);
-            maxLossRd.Max();
-            sanLoss = maxLossRd.intTotal;
-            lossDetail = "Max{" + failureLoss + "}=" + std::to_string(sanLoss);
-        } else if (successLevel == 1) {
-            // 失败 - 掷失败损失骰
-            lossExpr = failureLoss;
-            RD lossRd(lossExpr, 100);
-            err = lossRd.Roll();
-            if (err != 0) {
-                result.set("rollValue", rollValue);
-                result.set("successLevel", successLevel);
-                result.set("sanLoss", 0);
-                result.set("lossDetail", "");
-                result.set("newSan", currentSan);
-                result.set("errorCode", err);
-                result.set("errorMsg", "损失表达式错误: " + getErrorMessage(err));
-                return result;
-            }
-            sanLoss = lossRd.intTotal;
-            lossDetail = lossRd.FormShortString();
-        } else {
-            // 成功 (包括困难成功、极难成功、大成功) - 掷成功损失骰
-            lossExpr = successLoss;
-            RD lossRd(lossExpr, 100);
-            err = lossRd.Roll();
-            if (err != 0) {
-                result.set("rollValue", rollValue);
-                result.set("successLevel", successLevel);
-                result.set("sanLoss", 0);
-                result.set("lossDetail", "");
-                result.set("newSan", currentSan);
-                result.set("errorCode", err);
-                result.set("errorMsg", "损失表达式错误: " + getErrorMessage(err));
-                return result;
-            }
-            sanLoss = lossRd.intTotal;
-            lossDetail = lossRd.FormShortString();
+        const SanityLossProgram& program = getSanityLossProgram(successLoss, failureLoss);
+
+        // 每人：d100 + 损失骰 + 智力检定 + 症状/持续时间/详情，一次预取
+        int lossDice = std::max(program.success.diceCount(), program.failure.diceCount());
+        SecureRandomBuffer rng(static_cast<size_t>(count) * (lossDice + 5));
+        rng.reserve(static_cast<size_t>(count) * (lossDice + 5));
+
+        std::vector<int32_t> table(static_cast<size_t>(count) * SANITY_BATCH_STRIDE, 0);
+        val names = val::array();
+        val lossDetails = val::array();
+        val symptoms = val::array();
+
+        for (int i = 0; i < count; i++) {
+            val entry = investigators[i];
+            int currentSan = entry["currentSan"].as<int>();
+            val intValue = entry["intelligence"];
+            val ruleValue = entry["rule"];
+            int intelligence = intValue.isNumber() ? intValue.as<int>() : 0;
+            int rule = ruleValue.isNumber() ? ruleValue.as<int>() : defaultRule;
+
+            SanityOutcome outcome;
+            evaluateSanity(currentSan, program, rule, rng, outcome);
+
+            InsanityOutcome insanity;
+            evaluateInsanity(currentSan, outcome, intelligence, rng, insanity);
+
+            int32_t* row = table.data() + static_cast<size_t>(i) * SANITY_BATCH_STRIDE;
+            row[0] = outcome.rollValue;
+            row[1] = outcome.successLevel;
+            row[2] = outcome.sanLoss;
+            row[3] = outcome.newSan;
+            row[4] = insanityTypeCode(insanity.type);
+            row[5] = insanity.intCheckRequired ? 1 : 0;
+            row[6] = insanity.intRoll;
+            row[7] = insanity.symptomIndex;
+            row[8] = insanity.duration;
+            row[9] = insanity.detailIndex;
+            row[10] = outcome.errorCode;
+
+            names.set(i, entry["name"]);
+            lossDetails.set(i, outcome.errorCode != 0 ? outcome.errorMsg : outcome.lossDetail);
+            symptoms.set(i, insanity.symptom);
         }
 
-        int newSan = std::max(0, currentSan - sanLoss);
+        val columns = val::array();
+        for (size_t c = 0; c < SANITY_BATCH_STRIDE; c++) {
+            columns.set(c, std::string(SANITY_BATCH_COLUMNS[c]));
+        }
 
-        result.set("rollValue", rollValue);
-        result.set("successLevel", successLevel);
-        result.set("sanLoss", sanLoss);
-        result.set("lossDetail", lossDetail);
-        result.set("newSan", newSan);
-        result.set("errorCode", 0);
-        result.set("errorMsg", "");
+        result.set("success", true);
+        result.set("count", count);
+        result.set("columns", columns);
+        result.set("stride", static_cast<int>(SANITY_BATCH_STRIDE));
+        result.set("table", toInt32Array(table.data(), table.size()));
+        result.set("names", names);
+        result.set("lossDetails", lossDetails);
+        result.set("symptoms", symptoms);
 
     } catch (const std::exception& e) {
-        result.set("rollValue", 0);
-        result.set("successLevel", 0);
-        result.set("sanLoss", 0);
-        result.set("lossDetail", "");
-        result.set("newSan", currentSan);
-        result.set("errorCode", -1);
+        result.set("success", false);
         result.set("errorMsg", std::string("异常: ") + e.what());
     } catch (...) {
-        result.set("rollValue", 0);
-        result.set("successLevel", 0);
-        result.set("sanLoss", 0);
-        result.set("lossDetail", "");
-        result.set("newSan", currentSan);
-        result.set("errorCode", -1);
+        result.set("success", false);
         result.set("errorMsg", "未知异常");
     }
 
@@ -11,4 +11,29 @@ std::string getPhobia(int index);
 std::string getMania(int index);
 emscripten::val sanityCheck(int currentSan, const std::string& successLoss, const std::string& failureLoss);
 
+/**
+ * 理智检定（含疯狂判定）
+ * 损失表达式按 "成功损失/失败损失" 编译后缓存；d100、损失与大失败最大值一次求出，
+ * 损失触发疯狂时在同一次调用内完成智力检定与症状抽取
+ *
+ * @param currentSan 当前理智值
+ * @param lossSpec 损失表达式，如 "1/1d6"
+ * @param intelligence 智力值（<=0 表示不进行智力检定）
+ * @param rule COC房规（0-5）；-1 使用与 sanityCheck 相同的内置判定
+ * @return JS对象 { rollValue, successLevel, sanLoss, lossDetail, newSan, errorCode, errorMsg, insanity }
+ */
+emscripten::val sanityCheckWithInsanity(int currentSan, const std::string& lossSpec, int intelligence, int rule);
+
+/**
+ * 全队理智检定
+ * 所有调查员共用同一个编译后的损失程序，随机数一次批量取出
+ *
+ * @param investigators JS数组 Array<{ name, currentSan, intelligence?, rule? }>
+ * @param lossSpec 损失表达式，如 "1d3/1d10"
+ * @param defaultRule 未单独指定房规时使用的COC房规（0-5）；-1 使用与 sanityCheck 相同的内置判定
+ * @return JS对象 { success, count, columns, stride, table: Int32Array, names, lossDetails, symptoms }
+ *         table 每行依次为 columns 中的各列；insanityType: 0-无, 1-临时, 2-不定, 3-永久
+ */
+emscripten::val sanityCheckBatch(const emscripten::val& investigators, const std::string& lossSpec, int defaultRule);
+
 } // namespace koidice
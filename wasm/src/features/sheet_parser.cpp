@@ -0,0 +1,316 @@
+#include "sheet_parser.h"
+#include "card_store.h"
+#include "../core/attribute_alias.h"
+#include <simdutf.h>
+#include <algorithm>
+#include <array>
+
+using namespace emscripten;
+
+namespace koidice {
+
+// 单次导入的条目上限
+static constexpr size_t MAX_SHEET_ENTRIES = 2000;
+
+// 超过该位数的数值视为无效片段
+static constexpr size_t MAX_VALUE_DIGITS = 9;
+
+namespace {
+
+enum class ByteClass : uint8_t {
+    Separator,  // 空白与标点
+    Digit,
+    Name,       // ASCII 字母、下划线
+    Joiner,     // 属性名内部允许的 ( ) / :
+    Lead        // 多字节字符首字节，需解码后判断
+};
+
+constexpr std::array<ByteClass, 256> buildByteClasses() {
+    std::array<ByteClass, 256> table{};
+    for (int c = 0; c < 256; c++) {
+        ByteClass cls = ByteClass::Separator;
+        if (c >= '0' && c <= '9') {
+            cls = ByteClass::Digit;
+        } else if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_') {
+            cls = ByteClass::Name;
+        } else if (c == '(' || c == ')' || c == '/' || c == ':') {
+            cls = ByteClass::Joiner;
+        } else if (c >= 0xC0) {
+            cls = ByteClass::Lead;
+        }
+        table[c] = cls;
+    }
+    return table;
+}
+
+constexpr std::array<ByteClass, 256> BYTE_CLASSES = buildByteClasses();
+
+/**
+ * 判断 pos 处的多字节字符
+ * @param length 输出：字符字节数
+ * @return 汉字与全角字母返回 Name，全角括号/冒号返回 Joiner，其余返回 Separator
+ */
+ByteClass classifyMultibyte(std::string_view text, size_t pos, size_t& length) {
+    unsigned char c = static_cast<unsigned char>(text[pos]);
+    if (c < 0xE0) {
+        length = 2;
+        return ByteClass::Separator;
+    }
+    if (c >= 0xF0) {
+        length = 4;
+        return ByteClass::Separator;
+    }
+
+    // 三字节字符（文本已通过校验，长度足够）
+    length = 3;
+    char32_t cp = (static_cast<char32_t>(c & 0x0F) << 12) |
+                  (static_cast<char32_t>(static_cast<unsigned char>(text[pos + 1]) & 0x3F) << 6) |
+                  static_cast<char32_t>(static_cast<unsigned char>(text[pos + 2]) & 0x3F);
+
+    if ((cp >= 0x4E00 && cp <= 0x9FFF) || (cp >= 0x3400 && cp <= 0x4DBF)) {
+        return ByteClass::Name;
+    }
+    if ((cp >= 0xFF21 && cp <= 0xFF3A) || (cp >= 0xFF41 && cp <= 0xFF5A)) {
+        return ByteClass::Name;  // 全角字母
+    }
+    if (cp >= 0xFF10 && cp <= 0xFF19) {
+        return ByteClass::Digit;  // 全角数字
+    }
+    if (cp == 0xFF08 || cp == 0xFF09 || cp == 0xFF0F || cp == 0xFF1A) {
+        return ByteClass::Joiner;  // （ ） ／ ：
+    }
+    return ByteClass::Separator;
+}
+
+ByteClass classifyAt(std::string_view text, size_t pos, size_t& length) {
+    ByteClass cls = BYTE_CLASSES[static_cast<unsigned char>(text[pos])];
+    if (cls == ByteClass::Lead) {
+        return classifyMultibyte(text, pos, length);
+    }
+    length = 1;
+    return cls;
+}
+
+// 全角数字 U+FF10-FF19 为 EF BC 90-99
+int digitValue(std::string_view text, size_t pos, size_t length) {
+    if (length == 1) {
+        return text[pos] - '0';
+    }
+    return static_cast<unsigned char>(text[pos + 2]) - 0x90;
+}
+
+bool isAsciiDigit(std::string_view text, size_t pos) {
+    return pos < text.size() && text[pos] >= '0' && text[pos] <= '9';
+}
+
+// pos 处为 "d6"、"D4+2" 之类的掷骰写法时返回其结束位置，否则返回 pos
+size_t skipDiceSuffix(std::string_view text, size_t pos) {
+    if (pos >= text.size() || (text[pos] != 'd' && text[pos] != 'D') || !isAsciiDigit(text, pos + 1)) {
+        return pos;
+    }
+    pos++;
+    while (pos < text.size()) {
+        char c = text[pos];
+        if (isAsciiDigit(text, pos) ||
+            ((c == 'd' || c == 'D' || c == '+' || c == '-') && isAsciiDigit(text, pos + 1))) {
+            pos++;
+        } else {
+            break;
+        }
+    }
+    return pos;
+}
+
+SheetEntry makeSheetEntry(std::string_view name, int value) {
+    AttributeId id = lookupAttributeAlias(name);
+    if (id != INVALID_ATTRIBUTE) {
+        return {id, std::string(), value};
+    }
+    return {INVALID_ATTRIBUTE, std::string(name), value};
+}
+
+} // namespace
+
+bool scanCharacterSheet(std::string_view text, SheetScanResult& result) {
+    result.cardName.clear();
+    result.entries.clear();
+    result.skipped = 0;
+
+    if (!simdutf::validate_utf8(text.data(), text.size())) {
+        return false;
+    }
+
+    // 人物卡名称（格式：名称--属性值...）
+    size_t separator = text.find("--");
+    if (separator != std::string_view::npos && separator > 0) {
+        std::string_view prefix = text.substr(0, separator);
+        size_t begin = prefix.find_first_not_of(" \t\r\n");
+        size_t end = prefix.find_last_not_of(" \t\r\n");
+        if (begin != std::string_view::npos) {
+            result.cardName = std::string(prefix.substr(begin, end - begin + 1));
+        }
+        text = text.substr(separator + 2);
+    }
+
+    result.entries.reserve(std::min(text.size() / 3 + 1, MAX_SHEET_ENTRIES));
+
+    size_t pos = 0;
+    size_t nameStart = 0;
+    size_t nameEnd = 0;  // nameStart == nameEnd 表示当前没有属性名
+
+    while (pos < text.size() && result.entries.size() < MAX_SHEET_ENTRIES) {
+        size_t length = 1;
+        ByteClass cls = classifyAt(text, pos, length);
+
+        if (cls == ByteClass::Name) {
+            if (nameStart == nameEnd || nameEnd != pos) {
+                // 新的属性名；被分隔符隔开的前一个属性名没有数值
+                if (nameStart != nameEnd) {
+                    result.skipped++;
+                }
+                nameStart = pos;
+            }
+            pos += length;
+            nameEnd = pos;
+            continue;
+        }
+
+        if (cls == ByteClass::Joiner && nameStart != nameEnd) {
+            // 属性名内部的连接符（如 "格斗(斗殴)"、"射击:手枪"），其后须仍为属性名或右括号
+            bool closing = length == 1 ? text[pos] == ')' : static_cast<unsigned char>(text[pos + 2]) == 0x89;
+            size_t nextLength = 1;
+            bool joined = closing ||
+                          (pos + length < text.size() && classifyAt(text, pos + length, nextLength) == ByteClass::Name);
+            if (joined && nameEnd == pos) {
+                pos += length;
+                nameEnd = pos;
+                continue;
+            }
+        }
+
+        if (cls == ByteClass::Digit) {
+            // 紧贴数值的 '-' 是负号（如 "体格-1"、"体格 -2"），其余位置的 '-' 仍是分隔符
+            bool negative = nameStart != nameEnd && pos > nameEnd && text[pos - 1] == '-';
+            long long value = 0;
+            size_t digits = 0;
+            while (pos < text.size()) {
+                size_t digitLength = 1;
+                if (classifyAt(text, pos, digitLength) != ByteClass::Digit) break;
+                if (digits < MAX_VALUE_DIGITS) {
+                    value = value * 10 + digitValue(text, pos, digitLength);
+                }
+                digits++;
+                pos += digitLength;
+            }
+
+            size_t diceEnd = skipDiceSuffix(text, pos);
+            if (diceEnd != pos) {
+                // 掷骰写法，连同前面的属性名一起跳过
+                pos = diceEnd;
+                result.skipped++;
+                nameStart = nameEnd = 0;
+            } else if (nameStart == nameEnd) {
+                result.skipped++;  // 没有属性名的孤立数值
+            } else if (digits > MAX_VALUE_DIGITS) {
+                result.skipped++;
+                nameStart = nameEnd = 0;
+            } else {
+                std::string_view name = text.substr(nameStart, nameEnd - nameStart);
+                result.entries.push_back(makeSheetEntry(name, static_cast<int>(negative ? -value : value)));
+                nameStart = nameEnd = 0;
+            }
+            continue;
+        }
+
+        // 分隔符：属性名与数值之间允许出现（如 "力量: 60"、"力量 = 60"），不结束当前属性名
+        pos += length;
+    }
+
+    if (nameStart != nameEnd) {
+        result.skipped++;  // 末尾没有数值的属性名
+    }
+    return true;
+}
+
+val importCharacterSheet(const std::string& input) {
+    val result = val::object();
+
+    try {
+        SheetScanResult scan;
+        if (!scanCharacterSheet(input, scan)) {
+            result.set("success", false);
+            result.set("errorMsg", "文本不是有效的 UTF-8");
+            return result;
+        }
+
+        if (!scan.cardName.empty()) {
+            result.set("cardName", scan.cardName);
+        }
+
+        val attributes = val::object();
+        for (const SheetEntry& entry : scan.entries) {
+            attributes.set(entry.attributeName(), entry.value);
+        }
+
+        result.set("success", !scan.entries.empty());
+        result.set("count", static_cast<int>(scan.entries.size()));
+        result.set("skipped", static_cast<int>(scan.skipped));
+        result.set("attributes", attributes);
+        result.set("errorMsg", scan.entries.empty() ? "未识别到有效的属性" : "");
+    } catch (const std::exception& e) {
+        result.set("success", false);
+        result.set("errorMsg", std::string("异常: ") + e.what());
+    } catch (...) {
+        result.set("success", false);
+        result.set("errorMsg", "未知异常");
+    }
+
+    return result;
+}
+
+val importSheetToCard(const std::string& platform, const std::string& userId, const std::string& cardName, const std::string& input) {
+    val result = val::object();
+
+    try {
+        ResidentCard* card = findResidentCard(platform, userId, cardName);
+        if (!card) {
+            result.set("success", false);
+            result.set("errorMsg", "人物卡未加载");
+            return result;
+        }
+
+        SheetScanResult scan;
+        if (!scanCharacterSheet(input, scan)) {
+            result.set("success", false);
+            result.set("errorMsg", "文本不是有效的 UTF-8");
+            return result;
+        }
+
+        if (!scan.cardName.empty()) {
+            result.set("cardName", scan.cardName);
+        }
+
+        for (const SheetEntry& entry : scan.entries) {
+            if (entry.id != INVALID_ATTRIBUTE) {
+                card->set(entry.id, entry.value);
+            } else {
+                card->set(entry.name, entry.value);
+            }
+        }
+
+        result.set("success", !scan.entries.empty());
+        result.set("count", static_cast<int>(scan.entries.size()));
+        result.set("skipped", static_cast<int>(scan.skipped));
+        result.set("errorMsg", scan.entries.empty() ? "未识别到有效的属性" : "");
+    } catch (const std::exception& e) {
+        result.set("success", false);
+        result.set("errorMsg", std::string("异常: ") + e.what());
+    } catch (...) {
+        result.set("success", false);
+        result.set("errorMsg", "未知异常");
+    }
+
+    return result;
+}
+
+} // namespace koidice
@@ -0,0 +1,59 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <emscripten/val.h>
+#include "../core/attribute_registry.h"
+
+namespace koidice {
+
+/**
+ * 人物卡导入条目
+ * 已知属性名解析为属性ID；其余属性名原样保留在 name 中（id 为 INVALID_ATTRIBUTE），不登记到属性表
+ */
+struct SheetEntry {
+    AttributeId id;
+    std::string name;
+    int value;
+
+    const std::string& attributeName() const {
+        return id != INVALID_ATTRIBUTE ? getAttributeName(id) : name;
+    }
+};
+
+/**
+ * 人物卡文本扫描结果
+ */
+struct SheetScanResult {
+    std::string cardName;             // "名称--" 前缀，未指定时为空
+    std::vector<SheetEntry> entries;  // 按出现顺序，同一属性可能出现多次
+    size_t skipped = 0;               // 被跳过的片段数（无数值的属性名、超长数值等）
+};
+
+/**
+ * 单遍扫描人物卡文本
+ * 支持无分隔符的导出格式（如 "侦查60聆听50图书馆70"）以及空白、逗号、冒号、等号等分隔符；
+ * 整段文本先用 simdutf 做一次 UTF-8 校验，之后按字节切分属性名与数值，
+ * 属性名经同义词表解析为属性ID，已知属性不产生堆分配；
+ * 数值后紧跟的掷骰写法（如 "1D4"、"2d6+3"）不是有效数值，整段跳过
+ *
+ * @return 文本不是有效 UTF-8 时返回 false
+ */
+bool scanCharacterSheet(std::string_view text, SheetScanResult& result);
+
+/**
+ * 导入人物卡文本
+ * @param input 人物卡文本，可带 "名称--" 前缀
+ * @return JS对象 { success, cardName?, count, skipped, attributes, errorMsg }，
+ *         attributes 为 { 属性名: 数值 }，重复属性以最后一次为准
+ */
+emscripten::val importCharacterSheet(const std::string& input);
+
+/**
+ * 导入人物卡文本到常驻人物卡（标记为脏）
+ * @param input 人物卡文本；其中的 "名称--" 前缀仅原样返回，不用于选卡
+ * @return JS对象 { success, cardName?, count, skipped, errorMsg }
+ */
+emscripten::val importSheetToCard(const std::string& platform, const std::string& userId, const std::string& cardName, const std::string& input);
+
+} // namespace koidice